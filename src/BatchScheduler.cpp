@@ -0,0 +1,270 @@
+#include "BatchScheduler.h"
+#include "SBridger.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <stdexcept>
+#include <cctype>
+#include <climits>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "thread_pool/thread_pool.hpp"
+
+namespace scara {
+
+  using namespace std;
+
+  /* KK:
+   * Memory estimate of a job, relative to the sizes of its input files
+   * Read qualities are not kept, so loaded reads take about half of the FASTQ file (a quarter of that when packed).
+   * While loading, the chunk being parsed is also held with qualities (about its size in the file).
+   * Mapped reads (MapSequences) keep the whole file mapped, packed reads are packed only after mapping.
+   * LazyReads keep only an index. Overlaps and edges created from them take a few times the size of PAF files,
+   * less when the graph is constructed while overlaps are parsed (PipelineGraph).
+   * These are rough upper estimates, used only to decide how many jobs can run at once.
+   */
+  static const double ReadsMemoryFactor = 0.5;
+  static const double PackedReadsMemoryFactor = 0.125;
+  static const double MappedReadsMemoryFactor = 1.0;
+  static const double LazyReadsMemoryFactor = 0.02;
+  static const double ContigsMemoryFactor = 1.0;
+  static const double OverlapsMemoryFactor = 3.0;
+  static const double PipelinedOverlapsMemoryFactor = 1.5;
+  static const uint64_t JobBaseMemory = (uint64_t)16 << 20;
+
+  static uint64_t fileSize(const std::string& strFile) {
+    struct stat st;
+    return (stat(strFile.c_str(), &st) == 0) ? st.st_size : 0;
+  }
+
+  static double elapsedSince(std::chrono::steady_clock::time_point start) {
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+  }
+
+  bool parseMemoryBudget(const std::string& strBudget, uint64_t& memoryBudget) {
+    if (strBudget.empty() || !isdigit(strBudget[0])) return false;
+    size_t idx = 0;
+    unsigned long long ullBudget;
+    try {
+      ullBudget = stoull(strBudget, &idx);
+    } catch (const std::logic_error&) {
+      return false;
+    }
+    if (idx != strBudget.size() || ullBudget == 0 || ullBudget > (UINT64_MAX >> 20)) return false;
+    memoryBudget = (uint64_t)ullBudget << 20;
+    return true;
+  }
+
+  std::vector<BatchJob> readBatchManifest(const std::string& strManifest) {
+    ifstream manifest(strManifest);
+    if (!manifest) {
+      throw std::runtime_error(std::string("SCARA BATCH: ERROR - unable to read batch manifest: ") + strManifest);
+    }
+
+    std::vector<BatchJob> vJobs;
+    std::string strLine, strExtra;
+    uint32_t lineNumber = 0;
+    while (std::getline(manifest, strLine)) {
+      lineNumber++;
+      std::stringstream ssLine(strLine);
+      BatchJob job;
+      if (!(ssLine >> job.strFolder) || job.strFolder[0] == '#') continue;
+      if (!(ssLine >> job.strOutput)) job.strOutput = job.strFolder + "/scaffolds.fasta";
+      if (ssLine >> strExtra) {
+        throw std::runtime_error(std::string("SCARA BATCH: ERROR - unexpected text after the output file in line ")
+                                 + std::to_string(lineNumber) + " of batch manifest " + strManifest + ": " + strExtra);
+      }
+      vJobs.emplace_back(job);
+    }
+    return vJobs;
+  }
+
+  uint64_t estimateJobMemory(const BatchJob& job, const ScaraConfig& config) {
+    const uint64_t readsSize = fileSize(job.strFolder + "/reads.fastq");
+    double readsEstimate;
+    if (config.LazyReads) {
+      readsEstimate = LazyReadsMemoryFactor * readsSize;
+    } else if (config.MapSequences) {
+      readsEstimate = (MappedReadsMemoryFactor + (config.PackReads ? PackedReadsMemoryFactor : 0)) * readsSize;
+    } else {
+      readsEstimate = (config.PackReads ? PackedReadsMemoryFactor : ReadsMemoryFactor) * readsSize;
+      readsEstimate += std::min(readsSize, FastqChunkSize);
+    }
+    double overlapsFactor = config.PipelineGraph ? PipelinedOverlapsMemoryFactor : OverlapsMemoryFactor;
+
+    double estimate = JobBaseMemory;
+    estimate += readsEstimate;
+    estimate += ContigsMemoryFactor * fileSize(job.strFolder + "/contigs.fasta");
+    estimate += overlapsFactor * (fileSize(job.strFolder + "/readsToContigs.paf") + fileSize(job.strFolder + "/readsToReads.paf"));
+    return (uint64_t)estimate;
+  }
+
+  uint64_t physicalMemory(void) {
+    long numPages = sysconf(_SC_PHYS_PAGES);
+    long pageSize = sysconf(_SC_PAGE_SIZE);
+    if (numPages <= 0 || pageSize <= 0) return UINT64_MAX;
+    return (uint64_t)numPages * (uint64_t)pageSize;
+  }
+
+  // Runs all phases of a single job with the given number of threads, errors are recorded in the job and do not stop the batch
+  static void runBatchJob(BatchJob& job, const ScaraConfig& config, uint32_t numThreads) {
+    auto jobStart = std::chrono::steady_clock::now();
+    try {
+      ScaraConfig jobConfig = config;
+      jobConfig.outputFile = job.strOutput;
+      jobConfig.NumThreads = numThreads;
+
+      auto start = std::chrono::steady_clock::now();
+      SBridger sbridger(jobConfig, job.strFolder + "/reads.fastq", job.strFolder + "/contigs.fasta"
+                        , job.strFolder + "/readsToContigs.paf", job.strFolder + "/readsToReads.paf");
+      job.loadTime = elapsedSince(start);
+
+      start = std::chrono::steady_clock::now();
+      sbridger.generateGraph();
+      sbridger.cleanupGraph();
+      job.graphTime = elapsedSince(start);
+
+      // With partitioning, paths and scaffolds are generated together for each component (counted as paths)
+      start = std::chrono::steady_clock::now();
+      if (jobConfig.PartitionGraph) {
+        sbridger.processComponents();
+        job.pathsTime = elapsedSince(start);
+      } else {
+        sbridger.generatePaths();
+        job.pathsTime = elapsedSince(start);
+
+        start = std::chrono::steady_clock::now();
+        sbridger.groupAndProcessPaths();
+        job.groupTime = elapsedSince(start);
+      }
+
+      start = std::chrono::steady_clock::now();
+      job.numSequences = sbridger.generateSequences();
+      job.outputTime = elapsedSince(start);
+    } catch (const std::exception& e) {
+      job.strError = e.what();
+    }
+    job.totalTime = elapsedSince(jobStart);
+    job.finished = true;
+  }
+
+  /* KK:
+   * Jobs are admitted in manifest order onto a thread pool shared by the whole batch. A job is admitted when a worker
+   * is free and its estimated memory fits into what is left of the budget. A job larger than the whole budget is
+   * run alone. The batch is parallelized over jobs, so that phases which can not use multiple threads do not leave
+   * cores idle. Threads not used by running jobs are shared among the jobs that can still be admitted (the following
+   * jobs that fit into free workers and what is left of the budget), each job uses its share for its parallel phases.
+   * A job running alone (the last one, one larger than the budget, or one no other job fits next to) gets all free threads.
+   * When several jobs can run at once, only the scheduler reports progress (messages of jobs would interleave),
+   * messages of jobs are kept from DL_VERBOSE on.
+   */
+  uint32_t runBatch(std::vector<BatchJob>& vJobs, const ScaraConfig& config, uint64_t memoryBudget, const std::string& strReport) {
+    if (vJobs.empty()) return 0;
+    for (auto& job : vJobs) job.estimatedMemory = estimateJobMemory(job, config);
+
+    // Jobs write neither the log file nor into each other's outputs
+    ScaraConfig jobConfig = config;
+    jobConfig.logFile = "";
+
+    const uint32_t numWorkers = std::max(std::min(config.numThreads(), (uint32_t)vJobs.size()), (uint32_t)1);
+    if (numWorkers > 1) {
+      jobConfig.print_output = false;
+      if (jobConfig.debugLevel < DL_VERBOSE) jobConfig.debugLevel = DL_NONE;
+    }
+    if (config.debugLevel >= DL_INFO) {
+      cerr << "SCARA BATCH: Running " << vJobs.size() << " jobs on " << numWorkers << " threads with a memory budget of "
+           << memoryBudget / (1 << 20) << " MB" << endl;
+    }
+
+    std::mutex mtx;
+    std::condition_variable cvAdmit;
+    uint64_t usedMemory = 0;
+    uint32_t numRunning = 0;
+    uint32_t numFreeThreads = config.numThreads();
+    uint32_t numSucceeded = 0;
+    auto batchStart = std::chrono::steady_clock::now();
+
+    auto runJob = [&](uint32_t idx, uint32_t numThreads) {
+      BatchJob& job = vJobs[idx];
+      runBatchJob(job, jobConfig, numThreads);
+      std::lock_guard<std::mutex> lock(mtx);
+      usedMemory -= job.estimatedMemory;
+      numRunning--;
+      numFreeThreads += numThreads;
+      if (job.strError.empty()) numSucceeded++;
+      if (config.debugLevel >= DL_INFO) {
+        if (job.strError.empty()) {
+          cerr << "SCARA BATCH: Finished " << job.strFolder << " in " << job.totalTime << " s (load " << job.loadTime
+               << " s, graph " << job.graphTime << " s, paths " << job.pathsTime << " s, grouping " << job.groupTime
+               << " s, output " << job.outputTime << " s), " << job.numSequences << " sequences written into " << job.strOutput << endl;
+        } else {
+          cerr << "SCARA BATCH: Failed " << job.strFolder << " after " << job.totalTime << " s: " << job.strError << endl;
+        }
+      }
+      cvAdmit.notify_one();
+    };
+
+    std::unique_ptr<thread_pool::ThreadPool> threadPool = thread_pool::createThreadPool(numWorkers);
+    std::vector<std::future<void>> vFutures;
+    for (uint32_t idx = 0; idx < vJobs.size(); idx++) {
+      BatchJob& job = vJobs[idx];
+      std::unique_lock<std::mutex> lock(mtx);
+      if (job.estimatedMemory > memoryBudget && config.debugLevel >= DL_INFO) {
+        cerr << "SCARA BATCH: Warning - estimated memory of " << job.strFolder << " (" << job.estimatedMemory / (1 << 20)
+             << " MB) exceeds the memory budget, it is run alone" << endl;
+      }
+      cvAdmit.wait(lock, [&]() {
+        return numRunning == 0 || (numRunning < numWorkers && usedMemory + job.estimatedMemory <= memoryBudget);
+      });
+      // Free threads are split among this job and the following jobs that fit next to it into free workers and the budget
+      bool runsAlone = (numRunning == 0 && job.estimatedMemory > memoryBudget);
+      uint32_t numSlots = 1;
+      if (!runsAlone) {
+        uint64_t slotsMemory = usedMemory + job.estimatedMemory;
+        for (uint32_t next = idx + 1; next < vJobs.size() && numRunning + numSlots < numWorkers; next++) {
+          slotsMemory += vJobs[next].estimatedMemory;
+          if (slotsMemory > memoryBudget) break;
+          numSlots++;
+        }
+      }
+      uint32_t numThreads = std::max(numFreeThreads / numSlots, (uint32_t)1);
+      numFreeThreads -= std::min(numThreads, numFreeThreads);
+      usedMemory += job.estimatedMemory;
+      numRunning++;
+      job.waitTime = elapsedSince(batchStart);
+      job.numThreads = numThreads;
+      lock.unlock();
+      vFutures.emplace_back(threadPool->submit(runJob, idx, numThreads));
+    }
+    for (auto& f : vFutures) f.wait();
+    for (auto& f : vFutures) f.get();
+
+    ofstream report(strReport);
+    report << "job\tfolder\toutput\testimated_MB\tthreads\twait_s\tload_s\tgraph_s\tpaths_s\tgrouping_s\toutput_s\ttotal_s\tsequences\tstatus" << endl;
+    for (uint32_t i = 0; i < vJobs.size(); i++) {
+      const BatchJob& job = vJobs[i];
+      report << (i + 1) << '\t' << job.strFolder << '\t' << job.strOutput << '\t' << job.estimatedMemory / (1 << 20) << '\t'
+             << job.numThreads << '\t' << job.waitTime << '\t' << job.loadTime << '\t' << job.graphTime << '\t' << job.pathsTime << '\t'
+             << job.groupTime << '\t' << job.outputTime << '\t' << job.totalTime << '\t' << job.numSequences << '\t'
+             << (job.strError.empty() ? "OK" : "FAILED") << endl;
+    }
+    report.close();
+    if (!report) {
+      throw std::runtime_error(std::string("SCARA BATCH: ERROR - unable to write batch report: ") + strReport);
+    }
+    if (config.debugLevel >= DL_INFO) {
+      cerr << "SCARA BATCH: Finished " << numSucceeded << "/" << vJobs.size() << " jobs in " << elapsedSince(batchStart)
+           << " s, report written into " << strReport << endl;
+    }
+
+    return numSucceeded;
+  }
+
+}
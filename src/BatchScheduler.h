@@ -0,0 +1,52 @@
+#pragma once
+
+#include "ScaraConfig.h"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace scara {
+
+  /* KK:
+   * A dataset scaffolded in batch mode, given as a folder with reads.fastq, contigs.fasta,
+   * readsToContigs.paf and readsToReads.paf (same as the -f option)
+   * Timings of each phase are recorded in seconds
+   */
+  struct BatchJob {
+    std::string strFolder;
+    std::string strOutput;
+    uint64_t estimatedMemory = 0;		// Estimated peak memory in bytes, used for admission
+    uint32_t numThreads = 0;			// Threads given to the job when it was admitted
+
+    bool finished = false;
+    std::string strError;				// Empty if the job finished successfully
+    uint32_t numSequences = 0;			// Number of output sequences (scaffolds and unused contigs)
+    double waitTime = 0;				// Time from the start of the batch until the job was admitted
+    double loadTime = 0;
+    double graphTime = 0;
+    double pathsTime = 0;
+    double groupTime = 0;
+    double outputTime = 0;
+    double totalTime = 0;
+  };
+
+  // Reads a batch manifest, one dataset folder per line, optionally followed by the output file
+  // (default <folder>/scaffolds.fasta). Empty lines and lines starting with # are skipped, other text on a line is an error.
+  extern std::vector<BatchJob> readBatchManifest(const std::string& strManifest);
+
+  // Parses a memory budget given in MB, must be a positive whole number that fits into 64 bits in bytes
+  // Returns false if the budget is invalid
+  extern bool parseMemoryBudget(const std::string& strBudget, uint64_t& memoryBudget);
+
+  // Estimates the peak memory of a job from the sizes of its input files
+  extern uint64_t estimateJobMemory(const BatchJob& job, const ScaraConfig& config);
+
+  // Total physical memory in bytes, the default memory budget
+  extern uint64_t physicalMemory(void);
+
+  // Runs all jobs on a thread pool shared by the batch, writes a timing report into strReport
+  // Returns the number of jobs that finished successfully
+  extern uint32_t runBatch(std::vector<BatchJob>& vJobs, const ScaraConfig& config, uint64_t memoryBudget, const std::string& strReport);
+
+}
@@ -0,0 +1,488 @@
+#include "SBridger.h"
+#include "MappedFile.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <stdexcept>
+#include <unordered_map>
+#include <sys/stat.h>
+
+namespace scara {
+
+  using namespace std;
+
+  /* KK:
+   * Phase checkpoints, written into the checkpoint directory after graph generation, path generation
+   * and path grouping. The graph checkpoint is a graph index (see GraphIndex.cpp). Paths and scaffolds
+   * checkpoints store paths as sequences of edge references (node index, index of the outgoing edge),
+   * followed by path infos and path groups that refer to paths and infos by index, and the state of
+   * the phase. They are only valid for the graph they were created from, which is checked using
+   * a fingerprint of the graph, and for the parameters of the phases up to the checkpointed one,
+   * which are stored in the header. The data is protected by a checksum.
+   */
+  static const char checkpointMagic[8] = {'S', 'C', 'C', 'K', 'P', 'T', '\0', '\0'};
+  static const uint32_t CheckpointVersion = 2;
+  static const uint32_t NoIndex = 0xFFFFFFFF;
+
+  // Parameters that determine the result of path generation and path grouping
+  struct CheckpointParameters {
+    uint32_t MinMCPaths;
+    uint32_t HardNodeLimit;
+    uint32_t MaxPathLength;
+    uint32_t NumDFSNodes;
+    uint32_t MaxMCIterations;
+    uint32_t MinPathsinGroup;
+    double PathGroupHalfSize;
+    uint32_t StreamPaths;
+    uint32_t reserved;
+  };
+
+  struct CheckpointHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t phase;
+    uint64_t graphFingerprint;
+    CheckpointParameters parameters;
+    uint64_t dataSize;
+    uint64_t checksum;          // FNV-1a checksum of the data following the header
+  };
+
+  std::string CheckpointPhase2String(CheckpointPhase phase) {
+    switch (phase) {
+      case CP_GRAPH: return "graph";
+      case CP_PATHS: return "paths";
+      case CP_SCAFFOLDS: return "scaffolds";
+      default: return "none";
+    }
+  }
+
+  static std::string checkpointFile(const std::string& strDir, CheckpointPhase phase) {
+    if (phase == CP_GRAPH) return strDir + "/graph.scgraph";
+    return strDir + "/" + CheckpointPhase2String(phase) + ".sckpt";
+  }
+
+  static CheckpointParameters checkpointParameters(const ScaraConfig& config) {
+    CheckpointParameters parameters;
+    memset(&parameters, 0, sizeof(parameters));
+    parameters.MinMCPaths = config.MinMCPaths;
+    parameters.HardNodeLimit = config.HardNodeLimit;
+    parameters.MaxPathLength = config.MaxPathLength;
+    parameters.NumDFSNodes = config.NumDFSNodes;
+    parameters.MaxMCIterations = config.MaxMCIterations;
+    parameters.MinPathsinGroup = config.MinPathsinGroup;
+    parameters.PathGroupHalfSize = config.PathGroupHalfSize;
+    parameters.StreamPaths = config.StreamPaths;
+    return parameters;
+  }
+
+  /* KK:
+   * Returns the parameters that differ between the checkpoint and the current run, empty if there are none
+   * Only parameters used up to the checkpointed phase are compared, so that a run can be resumed
+   * from paths with different grouping parameters. With streaming, paths are grouped during path generation.
+   */
+  static std::string checkpointParameterMismatch(const CheckpointParameters& stored, const CheckpointParameters& current, CheckpointPhase phase) {
+    std::ostringstream ssMismatch;
+    auto compare = [&ssMismatch](const char* name, double storedValue, double currentValue) {
+      if (storedValue != currentValue) {
+        ssMismatch << (ssMismatch.tellp() > 0 ? ", " : "") << name << " " << storedValue << " instead of " << currentValue;
+      }
+    };
+    compare("MinMCPaths", stored.MinMCPaths, current.MinMCPaths);
+    compare("HardNodeLimit", stored.HardNodeLimit, current.HardNodeLimit);
+    compare("MaxPathLength", stored.MaxPathLength, current.MaxPathLength);
+    compare("NumDFSNodes", stored.NumDFSNodes, current.NumDFSNodes);
+    compare("MaxMCIterations", stored.MaxMCIterations, current.MaxMCIterations);
+    compare("StreamPaths", stored.StreamPaths, current.StreamPaths);
+    if (phase >= CP_SCAFFOLDS || current.StreamPaths) compare("PathGroupHalfSize", stored.PathGroupHalfSize, current.PathGroupHalfSize);
+    if (phase >= CP_SCAFFOLDS) compare("MinPathsinGroup", stored.MinPathsinGroup, current.MinPathsinGroup);
+    return ssMismatch.str();
+  }
+
+  static uint64_t checkpointChecksum(const char* data, uint64_t size) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (uint64_t i = 0; i < size; i++) {
+      hash ^= (unsigned char)data[i];
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
+
+  // Values are appended in native byte order, like in the other binary files
+  class CheckpointWriter {
+  public:
+    std::string data;
+
+    template <typename T> void put(T value) { data.append((const char*)&value, sizeof(T)); }
+    void putString(const std::string& str) { put<uint32_t>(str.size()); data.append(str); }
+  };
+
+  // Reading past the end of the data or an index out of range means that the checkpoint is invalid
+  class CheckpointReader {
+  private:
+    const char* cur;
+    const char* end;
+    const std::string& strFile;
+
+  public:
+    CheckpointReader(const char* data, uint64_t size, const std::string& t_strFile)
+      : cur(data), end(data + size), strFile(t_strFile) {}
+
+    void invalid(void) const {
+      throw std::runtime_error(std::string("SCARA CHECKPOINT: ERROR - invalid checkpoint: ") + strFile);
+    }
+
+    template <typename T> T get(void) {
+      if ((uint64_t)(end - cur) < sizeof(T)) invalid();
+      T value;
+      memcpy(&value, cur, sizeof(T));
+      cur += sizeof(T);
+      return value;
+    }
+
+    std::string getString(void) {
+      uint32_t length = get<uint32_t>();
+      if ((uint64_t)(end - cur) < length) invalid();
+      std::string str(cur, length);
+      cur += length;
+      return str;
+    }
+
+    uint32_t getIndex(uint64_t limit) {
+      uint32_t idx = get<uint32_t>();
+      if (idx >= limit) invalid();
+      return idx;
+    }
+
+    bool atEnd(void) const { return cur == end; }
+  };
+
+  // Graph nodes in checkpoint order, anchor nodes followed by read nodes, as in the graph index
+  static std::vector<std::shared_ptr<Node>> checkpointNodes(MapIdToNode& mAnchorNodes, MapIdToNode& mReadNodes) {
+    std::vector<std::shared_ptr<Node>> vNodes;
+    vNodes.reserve(mAnchorNodes.size() + mReadNodes.size());
+    for (auto const* mNodes : {&mAnchorNodes, &mReadNodes}) {
+      for (auto const& it : *mNodes) vNodes.emplace_back(it.second);
+    }
+    return vNodes;
+  }
+
+  // Fingerprint of the graph structure, node names and the end node and position of each edge
+  static uint64_t graphFingerprint(const std::vector<std::shared_ptr<Node>>& vNodes) {
+    std::unordered_map<const Node*, uint32_t> mNodeIndex;
+    for (uint32_t i = 0; i < vNodes.size(); i++) mNodeIndex.emplace(vNodes[i].get(), i);
+
+    CheckpointWriter fp;
+    fp.put<uint64_t>(vNodes.size());
+    for (auto const& node_ptr : vNodes) {
+      fp.putString(node_ptr->nName);
+      fp.put<uint32_t>(node_ptr->vOutEdges.size());
+      for (auto const& edge_ptr : node_ptr->vOutEdges) {
+        auto it = mNodeIndex.find(edge_ptr->endNode.get());
+        fp.put<uint32_t>(it == mNodeIndex.end() ? NoIndex : it->second);
+        fp.put<uint32_t>(edge_ptr->SStart);
+        fp.put<uint32_t>(edge_ptr->EStart);
+      }
+    }
+    return checkpointChecksum(fp.data.data(), fp.data.size());
+  }
+
+  void SBridger::saveCheckpoint(CheckpointPhase phase) {
+    if (mkdir(config.CheckpointDir.c_str(), 0755) != 0 && errno != EEXIST) {
+      throw std::runtime_error(std::string("SCARA CHECKPOINT: ERROR - unable to create checkpoint directory: ")
+                               + config.CheckpointDir + " (" + strerror(errno) + ")");
+    }
+    std::string strFile = checkpointFile(config.CheckpointDir, phase);
+    if (phase == CP_GRAPH) {
+      saveGraphIndex(strFile);
+      return;
+    }
+
+    std::vector<std::shared_ptr<Node>> vNodes = checkpointNodes(mAnchorNodes, mReadNodes);
+    std::unordered_map<const Edge*, std::pair<uint32_t, uint32_t>> mEdgeRefs;
+    for (uint32_t i = 0; i < vNodes.size(); i++) {
+      auto const& vOutEdges = vNodes[i]->vOutEdges;
+      for (uint32_t e = 0; e < vOutEdges.size(); e++) mEdgeRefs.emplace(vOutEdges[e].get(), std::make_pair(i, e));
+    }
+
+    // Paths, path infos and groups are numbered in the order of first use
+    // Reversed paths are stored as their base path and a flag in the path info
+    CheckpointWriter paths, infos, groups, state;
+    std::unordered_map<const Path*, uint32_t> mPathIndex;
+    std::unordered_map<const PathInfo*, uint32_t> mInfoIndex;
+    std::unordered_map<const PathGroup*, uint32_t> mGroupIndex;
+
+    auto pathIndex = [&](shared_ptr<Path> path_ptr) {
+      auto it = mPathIndex.find(path_ptr.get());
+      if (it != mPathIndex.end()) return it->second;
+      uint32_t idx = mPathIndex.size();
+      mPathIndex.emplace(path_ptr.get(), idx);
+      paths.put<uint32_t>(path_ptr->edges.size());
+      for (auto const& edge_ptr : path_ptr->edges) {
+        auto itEdge = mEdgeRefs.find(edge_ptr.get());
+        if (itEdge == mEdgeRefs.end()) {
+          throw std::runtime_error(std::string("SCARA CHECKPOINT: ERROR - path edge is not in the graph: ") + strFile);
+        }
+        paths.put<uint32_t>(itEdge->second.first);
+        paths.put<uint32_t>(itEdge->second.second);
+      }
+      return idx;
+    };
+    auto infoIndex = [&](shared_ptr<PathInfo> const& pinfo_ptr) {
+      if (pinfo_ptr == NULL) return NoIndex;
+      auto it = mInfoIndex.find(pinfo_ptr.get());
+      if (it != mInfoIndex.end()) return it->second;
+      uint32_t idx = mInfoIndex.size();
+      mInfoIndex.emplace(pinfo_ptr.get(), idx);
+      bool reversed = pinfo_ptr->path_ptr->isReversed();
+      infos.put<uint32_t>(pathIndex(reversed ? pinfo_ptr->path_ptr->reversedPath() : pinfo_ptr->path_ptr));
+      infos.put<uint8_t>(reversed);
+      infos.put<uint32_t>(pinfo_ptr->multiplicity);
+      return idx;
+    };
+    auto groupIndex = [&](shared_ptr<PathGroup> const& pgroup_ptr) {
+      auto it = mGroupIndex.find(pgroup_ptr.get());
+      if (it != mGroupIndex.end()) return it->second;
+      uint32_t idx = mGroupIndex.size();
+      mGroupIndex.emplace(pgroup_ptr.get(), idx);
+      // Infos are numbered before the group is written, so that they precede it
+      std::vector<uint32_t> vInfoIdx;
+      for (auto const& pinfo_ptr : pgroup_ptr->vPathInfos) vInfoIdx.emplace_back(infoIndex(pinfo_ptr));
+      uint32_t bestIdx = infoIndex(pgroup_ptr->bestPathInfo);
+      groups.putString(pgroup_ptr->startNodeName);
+      groups.putString(pgroup_ptr->endNodeName);
+      groups.put<double>(pgroup_ptr->length);
+      groups.put<uint32_t>(pgroup_ptr->numPaths);
+      groups.put<uint8_t>(pgroup_ptr->keepPathInfos);
+      groups.put<uint32_t>(bestIdx);
+      groups.put<uint32_t>(vInfoIdx.size());
+      for (auto const& infoIdx : vInfoIdx) groups.put<uint32_t>(infoIdx);
+      return idx;
+    };
+
+    if (phase == CP_PATHS) {
+      state.put<uint32_t>(pathAggregator.numPaths);
+      state.put<uint8_t>(pathAggregator.streaming);
+      state.put<uint32_t>(pathAggregator.vPaths.size());
+      for (uint32_t i = 0; i < pathAggregator.vPaths.size(); i++) {
+        state.put<uint32_t>(pathIndex(pathAggregator.vPaths[i]));
+        state.put<uint32_t>(pathAggregator.vPathCounts[i]);
+      }
+      state.put<uint32_t>(pathAggregator.vPathGroups.size());
+      for (auto const& pgroup_ptr : pathAggregator.vPathGroups) state.put<uint32_t>(groupIndex(pgroup_ptr));
+    } else {
+      state.put<uint32_t>(vPathInfos.size());
+      for (auto const& pinfo_ptr : vPathInfos) state.put<uint32_t>(infoIndex(pinfo_ptr));
+      state.put<uint32_t>(vPathGroups.size());
+      for (auto const& pgroup_ptr : vPathGroups) state.put<uint32_t>(groupIndex(pgroup_ptr));
+      state.put<uint32_t>(scaffolds.size());
+      for (auto const& vec_ptr : scaffolds) {
+        state.put<uint32_t>(vec_ptr->size());
+        for (auto const& pinfo_ptr : *vec_ptr) state.put<uint32_t>(infoIndex(pinfo_ptr));
+      }
+    }
+
+    CheckpointWriter data;
+    data.put<uint32_t>(mPathIndex.size());
+    data.data += paths.data;
+    data.put<uint32_t>(mInfoIndex.size());
+    data.data += infos.data;
+    data.put<uint32_t>(mGroupIndex.size());
+    data.data += groups.data;
+    data.data += state.data;
+
+    CheckpointHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, checkpointMagic, sizeof(header.magic));
+    header.version = CheckpointVersion;
+    header.phase = phase;
+    header.graphFingerprint = graphFingerprint(vNodes);
+    header.parameters = checkpointParameters(config);
+    header.dataSize = data.data.size();
+    header.checksum = checkpointChecksum(data.data.data(), data.data.size());
+
+    // Written into a temporary file, so that an interrupted run does not leave an invalid checkpoint
+    std::string strTemp = strFile + ".tmp";
+    ofstream out(strTemp, ios::binary | ios::trunc);
+    out.write((const char*)&header, sizeof(header));
+    out.write(data.data.data(), data.data.size());
+    out.close();
+    if (!out || rename(strTemp.c_str(), strFile.c_str()) != 0) {
+      remove(strTemp.c_str());
+      throw std::runtime_error(std::string("SCARA CHECKPOINT: ERROR - unable to write checkpoint: ") + strFile);
+    }
+
+    if (config.debugLevel >= DL_INFO) {
+      cerr << "SCARA CHECKPOINT: Saved " << CheckpointPhase2String(phase) << " checkpoint with " << mPathIndex.size()
+           << " paths into " << strFile << endl;
+    }
+  }
+
+  /* KK:
+   * Paths and scaffolds checkpoints are loaded on top of the graph, the whole checkpoint is read
+   * before any state is replaced, so an invalid checkpoint leaves the bridger unchanged
+   */
+  void SBridger::loadCheckpoint(CheckpointPhase phase) {
+    std::string strFile = checkpointFile(config.CheckpointDir, phase);
+    MappedFile file(strFile);
+    const char* fileData = file.data();
+    const uint64_t size = file.size();
+    auto invalid = [&strFile]() {
+      throw std::runtime_error(std::string("SCARA CHECKPOINT: ERROR - invalid checkpoint: ") + strFile);
+    };
+
+    if (size < sizeof(CheckpointHeader)) invalid();
+    const CheckpointHeader& header = *(const CheckpointHeader*)fileData;
+    if (memcmp(header.magic, checkpointMagic, sizeof(header.magic)) != 0 || header.phase != (uint32_t)phase) invalid();
+    if (header.version != CheckpointVersion) {
+      throw std::runtime_error(std::string("SCARA CHECKPOINT: ERROR - unsupported checkpoint version: ") + strFile);
+    }
+    if (header.dataSize != size - sizeof(CheckpointHeader)) invalid();
+    const char* data = fileData + sizeof(CheckpointHeader);
+    if (header.checksum != checkpointChecksum(data, header.dataSize)) invalid();
+
+    std::string strMismatch = checkpointParameterMismatch(header.parameters, checkpointParameters(config), phase);
+    if (!strMismatch.empty()) {
+      throw std::runtime_error(std::string("SCARA CHECKPOINT: ERROR - checkpoint was created with different parameters: ")
+                               + strFile + " (" + strMismatch + ")");
+    }
+
+    std::vector<std::shared_ptr<Node>> vNodes = checkpointNodes(mAnchorNodes, mReadNodes);
+    if (header.graphFingerprint != graphFingerprint(vNodes)) {
+      throw std::runtime_error(std::string("SCARA CHECKPOINT: ERROR - checkpoint was created for a different graph: ") + strFile);
+    }
+
+    CheckpointReader reader(data, header.dataSize, strFile);
+    std::vector<shared_ptr<Path>> vStoredPaths(reader.get<uint32_t>());
+    for (auto& path_ptr : vStoredPaths) {
+      path_ptr = make_shared<Path>();
+      uint32_t numEdges = reader.get<uint32_t>();
+      for (uint32_t e = 0; e < numEdges; e++) {
+        auto const& vOutEdges = vNodes[reader.getIndex(vNodes.size())]->vOutEdges;
+        auto const& edge_ptr = vOutEdges[reader.getIndex(vOutEdges.size())];
+        if (!path_ptr->edges.empty() && path_ptr->edges.back()->endNode != edge_ptr->startNode) invalid();
+        path_ptr->appendEdge(edge_ptr);
+      }
+      if (path_ptr->edges.empty()) invalid();
+    }
+
+    std::vector<shared_ptr<PathInfo>> vStoredInfos(reader.get<uint32_t>());
+    for (auto& pinfo_ptr : vStoredInfos) {
+      shared_ptr<Path> path_ptr = vStoredPaths[reader.getIndex(vStoredPaths.size())];
+      if (reader.get<uint8_t>()) path_ptr = path_ptr->reversedPath();
+      pinfo_ptr = make_shared<PathInfo>(path_ptr, reader.get<uint32_t>());
+    }
+
+    std::vector<shared_ptr<PathGroup>> vStoredGroups(reader.get<uint32_t>());
+    for (auto& pgroup_ptr : vStoredGroups) {
+      std::string startNodeName = reader.getString();
+      std::string endNodeName = reader.getString();
+      double length = reader.get<double>();
+      pgroup_ptr = make_shared<PathGroup>(startNodeName, endNodeName, length);
+      pgroup_ptr->numPaths = reader.get<uint32_t>();
+      pgroup_ptr->keepPathInfos = reader.get<uint8_t>() != 0;
+      uint32_t bestIdx = reader.get<uint32_t>();
+      if (bestIdx != NoIndex) {
+        if (bestIdx >= vStoredInfos.size()) invalid();
+        pgroup_ptr->bestPathInfo = vStoredInfos[bestIdx];
+      }
+      uint32_t numInfos = reader.get<uint32_t>();
+      for (uint32_t i = 0; i < numInfos; i++) pgroup_ptr->vPathInfos.emplace_back(vStoredInfos[reader.getIndex(vStoredInfos.size())]);
+    }
+
+    if (phase == CP_PATHS) {
+      uint32_t numPaths = reader.get<uint32_t>();
+      if ((reader.get<uint8_t>() != 0) != pathAggregator.streaming) {
+        throw std::runtime_error(std::string("SCARA CHECKPOINT: ERROR - checkpoint was created with a different path streaming setting: ") + strFile);
+      }
+      std::vector<shared_ptr<Path>> vPaths(reader.get<uint32_t>());
+      std::vector<uint32_t> vPathCounts(vPaths.size());
+      for (uint32_t i = 0; i < vPaths.size(); i++) {
+        vPaths[i] = vStoredPaths[reader.getIndex(vStoredPaths.size())];
+        vPathCounts[i] = reader.get<uint32_t>();
+      }
+      std::vector<shared_ptr<PathGroup>> vAggrGroups(reader.get<uint32_t>());
+      for (auto& pgroup_ptr : vAggrGroups) pgroup_ptr = vStoredGroups[reader.getIndex(vStoredGroups.size())];
+      if (!reader.atEnd()) invalid();
+
+      // The aggregator index of distinct paths is not restored, no paths are added after path generation
+      pathAggregator.numPaths = numPaths;
+      pathAggregator.vPaths = std::move(vPaths);
+      pathAggregator.vPathCounts = std::move(vPathCounts);
+      for (auto const& pgroup_ptr : vAggrGroups) pathAggregator.restoreGroup(pgroup_ptr);
+    } else {
+      std::vector<shared_ptr<PathInfo>> vInfos(reader.get<uint32_t>());
+      for (auto& pinfo_ptr : vInfos) pinfo_ptr = vStoredInfos[reader.getIndex(vStoredInfos.size())];
+      std::vector<shared_ptr<PathGroup>> vGroups(reader.get<uint32_t>());
+      for (auto& pgroup_ptr : vGroups) pgroup_ptr = vStoredGroups[reader.getIndex(vStoredGroups.size())];
+      std::vector<shared_ptr<std::vector<shared_ptr<PathInfo>>>> vScaffolds(reader.get<uint32_t>());
+      for (auto& vec_ptr : vScaffolds) {
+        vec_ptr = make_shared<std::vector<shared_ptr<PathInfo>>>(reader.get<uint32_t>());
+        if (vec_ptr->empty()) invalid();
+        for (auto& pinfo_ptr : *vec_ptr) pinfo_ptr = vStoredInfos[reader.getIndex(vStoredInfos.size())];
+      }
+      if (!reader.atEnd()) invalid();
+
+      vPathInfos = std::move(vInfos);
+      vPathGroups = std::move(vGroups);
+      scaffolds = std::move(vScaffolds);
+    }
+
+    if (config.debugLevel >= DL_INFO) {
+      cerr << "SCARA CHECKPOINT: Loaded " << CheckpointPhase2String(phase) << " checkpoint with " << vStoredPaths.size()
+           << " paths from " << strFile << endl;
+    }
+  }
+
+  /* KK:
+   * Restores the state after the given phase, or after an earlier phase if its checkpoint is missing or invalid
+   * All later phases need the graph, so nothing is restored without a valid graph checkpoint
+   * Returns the phase after which the run continues
+   */
+  CheckpointPhase SBridger::resumeFromCheckpoint(CheckpointPhase phase) {
+    numANodes = numRNodes = 0;
+    numEdges_all = numEdges_usable = numEdges_contained = numEdges_short = numEdges_lowqual = numEdges_zero = 0;
+    createNodes();
+
+    CheckpointPhase resumed = CP_NONE;
+    try {
+      loadGraphIndex(checkpointFile(config.CheckpointDir, CP_GRAPH));
+      resumed = CP_GRAPH;
+    } catch (const std::runtime_error& e) {
+      cerr << "SCARA CHECKPOINT: Warning - unable to use graph checkpoint: " << e.what() << endl;
+      for (auto const* mNodes : {&mAnchorNodes, &mReadNodes}) {
+        for (auto const& it : *mNodes) it.second->vOutEdges.clear();
+      }
+      numEdges_usable = numEdges_contained = numEdges_short = numEdges_lowqual = numEdges_zero = 0;
+    }
+
+    if (resumed == CP_GRAPH) {
+      countIsolatedNodes();
+      bGraphCreated = 1;
+      for (int p = phase; p > CP_GRAPH; p--) {
+        try {
+          loadCheckpoint((CheckpointPhase)p);
+          resumed = (CheckpointPhase)p;
+          break;
+        } catch (const std::runtime_error& e) {
+          cerr << "SCARA CHECKPOINT: Warning - unable to use " << CheckpointPhase2String((CheckpointPhase)p)
+               << " checkpoint: " << e.what() << endl;
+        }
+      }
+    } else if (!config.PipelineGraph && config.LoadGraphFile.empty() && !strR2Cpaf.empty()) {
+      // Overlaps are not loaded during initialization when resuming, the graph must now be generated from them
+      // (overlaps given in memory are already present)
+      parseProcessPaf(strR2Cpaf, vOvlR2C, config);
+      parseProcessPaf(strR2Rpaf, vOvlR2R, config);
+    }
+
+    if (config.debugLevel >= DL_INFO) {
+      cerr << "SCARA CHECKPOINT: Resuming after phase: " << CheckpointPhase2String(resumed) << endl;
+    }
+    return resumed;
+  }
+
+}
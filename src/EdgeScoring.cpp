@@ -0,0 +1,212 @@
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Graph.h"
+#include "Overlap.h"
+
+namespace scara {
+
+  using namespace std;
+
+  /* KK:
+   * Batched edge scoring. Each overlap gives 2 candidate edges (see createEdgesFromOverlap), their coordinates
+   * are placed into columns and statistics and test values are calculated for the whole batch in simple loops,
+   * which the compiler can vectorize. Edge objects are created only for usable edges.
+   * Expressions follow Edge::calcEdgeStats() and Edge::test(), so the results are exactly the same.
+   */
+
+  // Number of overlaps scored at once
+  static const uint32_t EdgeScoringBatchSize = 2048;
+
+  // Columns have fixed size, so that the compiler knows they do not overlap
+  struct EdgeScoringColumns {
+  	static const uint32_t Size = 2*EdgeScoringBatchSize;
+
+  	// Candidate edge data, both nodes on the strand given by the edge, relative strand is always '+'
+  	uint32_t SLen[Size], SStart[Size], SEnd[Size], ELen[Size], EStart[Size], EEnd[Size];
+  	uint32_t matchingBases[Size], overlapLength[Size];
+  	const std::shared_ptr<Node>* startNode[Size];
+  	const std::shared_ptr<Node>* endNode[Size];
+  	const Overlap* overlap[Size];
+
+  	// Calculated data
+  	uint32_t QOH1[Size], QOH2[Size], TOH1[Size], TOH2[Size], QOL[Size], TOL[Size];
+  	float SI[Size], OS[Size], QES1[Size], QES2[Size], TES1[Size], TES2[Size];
+  	int32_t testVal[Size];
+  };
+
+  static const std::shared_ptr<Node>& findNode(const std::string& nodeName, MapIdToNode& mAnchorNodes, MapIdToNode& mReadNodes) {
+  	auto it = mAnchorNodes.find(nodeName);
+  	if (it != mAnchorNodes.end()) return it->second;
+  	it = mReadNodes.find(nodeName);
+  	if (it != mReadNodes.end()) return it->second;
+  	throw std::runtime_error(std::string("Error loading graph edges. Unknown node: ") + nodeName);
+  }
+
+  // Stores candidate edge i for the given nodes, with start or end node coordinates on the reverse strand
+  static void setCandidate(EdgeScoringColumns& cols, uint32_t i, const Overlap* ovl, const std::shared_ptr<Node>& sNode
+  							, const std::shared_ptr<Node>& eNode, bool reverseSNode, bool reverseENode) {
+  	cols.SLen[i]   = ovl->ext_ulQLen;
+  	cols.SStart[i] = reverseSNode ? ovl->ext_ulQLen - ovl->ext_ulQEnd : ovl->ext_ulQBegin;
+  	cols.SEnd[i]   = reverseSNode ? ovl->ext_ulQLen - ovl->ext_ulQBegin : ovl->ext_ulQEnd;
+  	cols.ELen[i]   = ovl->ext_ulTLen;
+  	cols.EStart[i] = reverseENode ? ovl->ext_ulTLen - ovl->ext_ulTEnd : ovl->ext_ulTBegin;
+  	cols.EEnd[i]   = reverseENode ? ovl->ext_ulTLen - ovl->ext_ulTBegin : ovl->ext_ulTEnd;
+  	cols.matchingBases[i] = ovl->paf_matching_bases;
+  	cols.overlapLength[i] = ovl->paf_overlap_length;
+  	cols.startNode[i] = &sNode;
+  	cols.endNode[i] = &eNode;
+  	cols.overlap[i] = ovl;
+  }
+
+  // Exact conversion (same as a cast), split into two parts that vector instructions can convert as signed integers
+  static inline float u32ToFloat(uint32_t x) {
+  	return (float)(int32_t)(x >> 16) * 65536.0f + (float)(int32_t)(x & 0xffff);
+  }
+
+  // Calculates edge statistics and test values, same as Edge::calcEdgeStats() and Edge::test() for relative strand '+'
+  static void scoreCandidates(EdgeScoringColumns& cols, uint32_t numCandidates, const ScaraConfig& config) {
+  	const int32_t testShort = config.test_short_length, testContained = config.test_contained_reads, testLowQuality = config.test_low_quality;
+  	const float ohMax = config.OHmax, siMin = config.SImin;
+
+  	// Overhangs, overlap lengths and scores
+  	for (uint32_t i = 0; i < numCandidates; i++) {
+  		cols.QOH1[i] = cols.SStart[i];
+  		cols.QOH2[i] = cols.SLen[i] - cols.SEnd[i];
+  		cols.TOH1[i] = cols.EStart[i];
+  		cols.TOH2[i] = cols.ELen[i] - cols.EEnd[i];
+  		cols.QOL[i] = cols.SEnd[i] - cols.SStart[i];
+  		cols.TOL[i] = cols.EEnd[i] - cols.EStart[i];
+  		cols.SI[i] = u32ToFloat(cols.matchingBases[i])/u32ToFloat(cols.overlapLength[i]);
+  	}
+  	for (uint32_t i = 0; i < numCandidates; i++) {
+  		float avg_ovl_len = u32ToFloat((cols.QOL[i]+cols.TOL[i])/2);
+  		float os = avg_ovl_len*cols.SI[i];
+  		float qes1 = os + u32ToFloat(cols.TOH1[i]/2) - u32ToFloat((cols.QOH1[i] + cols.TOH2[i])/2);
+  		float qes2 = os + u32ToFloat(cols.TOH2[i]/2) - u32ToFloat((cols.QOH2[i] + cols.TOH1[i])/2);
+  		float tes1 = os + u32ToFloat(cols.QOH1[i]/2) - u32ToFloat((cols.QOH2[i] + cols.TOH1[i])/2);
+  		float tes2 = os + u32ToFloat(cols.QOH2[i]/2) - u32ToFloat((cols.QOH1[i] + cols.TOH2[i])/2);
+  		cols.OS[i] = os;
+  		cols.QES1[i] = qes1;
+  		cols.QES2[i] = qes2;
+  		cols.TES1[i] = tes1;
+  		cols.TES2[i] = tes2;
+  	}
+  	// Extension scores in the direction in which a sequence extends further are set to 0
+  	// Done in a separate loop, selecting between already calculated values can be vectorized
+  	for (uint32_t i = 0; i < numCandidates; i++) {
+  		cols.QES1[i] = (cols.QOH1[i] >= cols.TOH1[i]) ? 0.0f : cols.QES1[i];
+  		cols.TES1[i] = (cols.QOH1[i] >= cols.TOH1[i]) ? cols.TES1[i] : 0.0f;
+  		cols.QES2[i] = (cols.QOH2[i] >= cols.TOH2[i]) ? 0.0f : cols.QES2[i];
+  		cols.TES2[i] = (cols.QOH2[i] >= cols.TOH2[i]) ? cols.TES2[i] : 0.0f;
+  	}
+
+  	// Tests, applied in reverse order of Edge::test() so that the first failed test determines the value
+  	// Conditions are combined with bitwise operators, to avoid branches
+  	for (uint32_t i = 0; i < numCandidates; i++) {
+  		float minOH1 = u32ToFloat((cols.QOH1[i] < cols.TOH1[i]) ? cols.QOH1[i] : cols.TOH1[i]);
+  		float minOH2 = u32ToFloat((cols.QOH2[i] < cols.TOH2[i]) ? cols.QOH2[i] : cols.TOH2[i]);
+  		float avg_ovl_len = u32ToFloat((cols.QOL[i]+cols.TOL[i])/2);
+  		int32_t isShort = testShort & ((minOH1 + minOH2)/avg_ovl_len > ohMax);
+  		int32_t isContained = testContained & (((cols.QOH1[i] >= cols.TOH1[i]) & (cols.QOH2[i] >= cols.TOH2[i])) | ((cols.TOH1[i] >= cols.QOH1[i]) & (cols.TOH2[i] >= cols.QOH2[i])));
+  		int32_t isLowQuality = testLowQuality & (cols.SI[i] < siMin);
+  		int32_t isZero = (cols.QES1[i] <= 0) & (cols.QES2[i] <= 0) & (cols.TES1[i] <= 0) & (cols.TES2[i] <= 0);
+  		int32_t val = isZero ? -4 : 1;
+  		val = isLowQuality ? -3 : val;
+  		val = isContained ? -1 : val;
+  		val = isShort ? -2 : val;
+  		cols.testVal[i] = val;
+  	}
+  }
+
+  // Creates an Edge from a scored candidate, with start and end node reversed if needed (see createEdgesFromOverlap)
+  static std::shared_ptr<Edge> materializeCandidate(const EdgeScoringColumns& cols, uint32_t i) {
+  	auto edge_ptr = make_shared<Edge>();
+  	edge_ptr->startNode = *cols.startNode[i];
+  	edge_ptr->endNode = *cols.endNode[i];
+  	edge_ptr->SLen = cols.SLen[i];
+  	edge_ptr->SStart = cols.SStart[i];
+  	edge_ptr->SEnd = cols.SEnd[i];
+  	edge_ptr->ELen = cols.ELen[i];
+  	edge_ptr->EStart = cols.EStart[i];
+  	edge_ptr->EEnd = cols.EEnd[i];
+  	edge_ptr->ovl_bOrientation = true;
+
+  	edge_ptr->paf_matching_bases = cols.matchingBases[i];
+  	edge_ptr->paf_overlap_length = cols.overlapLength[i];
+  	edge_ptr->paf_mapping_quality = cols.overlap[i]->paf_mapping_quality;
+
+  	edge_ptr->QOH1 = cols.QOH1[i];
+  	edge_ptr->QOH2 = cols.QOH2[i];
+  	edge_ptr->TOH1 = cols.TOH1[i];
+  	edge_ptr->TOH2 = cols.TOH2[i];
+  	edge_ptr->QOL = cols.QOL[i];
+  	edge_ptr->TOL = cols.TOL[i];
+  	edge_ptr->SI = cols.SI[i];
+  	edge_ptr->OS = cols.OS[i];
+  	edge_ptr->QES1 = cols.QES1[i];
+  	edge_ptr->QES2 = cols.QES2[i];
+  	edge_ptr->TES1 = cols.TES1[i];
+  	edge_ptr->TES2 = cols.TES2[i];
+
+  	if (edge_ptr->QOH2 > edge_ptr->TOH2) edge_ptr->reverseNodes();
+  	return edge_ptr;
+  }
+
+  void createTestedEdges(VecOvl::const_iterator first, VecOvl::const_iterator last, MapIdToNode& mAnchorNodes
+  						, MapIdToNode& mReadNodes, std::vector<shared_ptr<Edge>> &vEdges, EdgeTestCounts &counts
+  						, const ScaraConfig& config) {
+  	std::unique_ptr<EdgeScoringColumns> cols_ptr(new EdgeScoringColumns);
+  	EdgeScoringColumns& cols = *cols_ptr;
+
+  	while (first != last) {
+  		// Gather candidate edges for a batch of overlaps
+  		uint32_t numCandidates = 0;
+  		for (uint32_t n = 0; n < EdgeScoringBatchSize && first != last; n++, ++first) {
+  			Overlap* ovl = first->get();
+  			if (!ovl->Test()) continue;
+
+  			const std::shared_ptr<Node>& startNode = findNode(ovl->ext_strName, mAnchorNodes, mReadNodes);
+  			const std::shared_ptr<Node>& startNode_RC = findNode(getRCNodeName(ovl->ext_strName), mAnchorNodes, mReadNodes);
+  			const std::shared_ptr<Node>& endNode = findNode(ovl->ext_strTarget, mAnchorNodes, mReadNodes);
+  			const std::shared_ptr<Node>& endNode_RC = findNode(getRCNodeName(ovl->ext_strTarget), mAnchorNodes, mReadNodes);
+
+  			if (ovl->ext_bOrientation) {
+  				// (SNode, ENode) and (SNodeRC, ENodeRC)
+  				setCandidate(cols, numCandidates++, ovl, startNode, endNode, false, false);
+  				setCandidate(cols, numCandidates++, ovl, startNode_RC, endNode_RC, true, true);
+  			} else {
+  				// (SNode, ENodeRC) and (SNodeRC, ENode)
+  				setCandidate(cols, numCandidates++, ovl, startNode, endNode_RC, false, true);
+  				setCandidate(cols, numCandidates++, ovl, startNode_RC, endNode, true, false);
+  			}
+  		}
+
+  		scoreCandidates(cols, numCandidates, config);
+
+  		// Count test results and create only usable edges
+  		for (uint32_t i = 0; i < numCandidates; i++) {
+  			switch (cols.testVal[i]) {
+  				case (-1):
+  					counts.contained += 1;
+  					break;
+  				case (-2):
+  					counts.shortEdges += 1;
+  					break;
+  				case (-3):
+  					counts.lowqual += 1;
+  					break;
+  				case (-4):
+  					counts.zero += 1;
+  					break;
+  				default:
+  					counts.usable += 1;
+  					vEdges.emplace_back(materializeCandidate(cols, i));
+  					break;
+  			}
+  		}
+  	}
+  }
+
+}
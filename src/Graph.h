@@ -1,7 +1,9 @@
 #include "Types.h"
 #include <string>
+#include <unordered_map>
 #include "Sequence.h"
 #include "Overlap.h"
+#include "ScaraConfig.h"
 
 using namespace std;
 
@@ -37,6 +39,8 @@ namespace scara {
 
   std::string getOGNodeName(const std::string nodeName);
 
+  uint64_t nodeNameHash(const std::string& nodeName, bool flipStrand);
+
   class Node {
   public:
     NodeType nType;
@@ -111,6 +115,9 @@ namespace scara {
   	Edge();						// Create an empty Edge
 
     std::shared_ptr<Edge> getReversedEdge();
+    void getReversedEdge(Edge &rev_edge);
+
+    Direction direction(void);
 
     std::string getStartNodeName();
     std::string getEndNodeName();
@@ -122,7 +129,8 @@ namespace scara {
     void reverseStrandSNode(void);
     void reverseStrandENode(void);
 
-    int test(void);
+    // Tests the edge using filtering parameters from the config
+    int test(const ScaraConfig& config);
 
   };
 
@@ -137,24 +145,95 @@ namespace scara {
   void createEdgesFromOverlap(std::unique_ptr<Overlap> const& ovl_ptr, MapIdToNode& mAnchorNodes
                             , MapIdToNode& mReadNodes, std::vector<shared_ptr<Edge>> &vEdges);
 
+  // Edge counts according to the value returned by Edge::test()
+  struct EdgeTestCounts {
+    uint32_t usable = 0;
+    uint32_t contained = 0;
+    uint32_t shortEdges = 0;
+    uint32_t lowqual = 0;
+    uint32_t zero = 0;
+  };
+
+  // Creates edges for a range of overlaps as createEdgesFromOverlap, and tests them using Edge::test()
+  // Edges are scored in batches, only usable edges are created and added to vEdges, all edges are counted
+  void createTestedEdges(VecOvl::const_iterator first, VecOvl::const_iterator last, MapIdToNode& mAnchorNodes
+                            , MapIdToNode& mReadNodes, std::vector<shared_ptr<Edge>> &vEdges, EdgeTestCounts &counts
+                            , const ScaraConfig& config);
 
 
-  class Path {
+
+  // A view of an Edge as it is traversed within a Path
+  // If the edge is reversed, the roles of start and end node are swapped, without creating a new Edge
+  class EdgeView {
+  private:
+    Edge* edge_ptr;
+    bool reversed;
+
+  public:
+    EdgeView(Edge* t_edge_ptr, bool t_reversed);
+
+    std::shared_ptr<Node> const& startNode(void) const;
+    std::shared_ptr<Node> const& endNode(void) const;
+
+    uint32_t SLen(void) const;
+    uint32_t SStart(void) const;
+    uint32_t SEnd(void) const;
+    uint32_t ELen(void) const;
+    uint32_t EStart(void) const;
+    uint32_t EEnd(void) const;
+    float SI(void) const;
+
+    Direction direction(void) const;
+  };
+
+
+  // A path through the graph, a sequence of edges
+  // A reversed path is a view of another path, traversing its edges in reverse order with swapped start
+  // and end nodes. It does not store edges itself and only supports read access through the path methods
+  class Path : public std::enable_shared_from_this<Path> {
+  private:
+    bool reversed;
+    std::shared_ptr<Path> basePath;	// Path that is viewed in reverse, only set for reversed paths
+
+    // Running path metrics, updated when edges are appended or removed
+    int64_t extLength;				// Sum of end node extensions over all edges (for path length)
+    uint32_t extLength2;			// Sum of differences of start positions over all edges (for path length2)
+    uint32_t numNegativeExt;		// Number of edges with a negative extension
+    uint32_t numNegativeExtRev;		// Number of edges with a negative extension, if the path were reversed
+    uint32_t numDirChanges;			// Number of edges whose direction differs from the first edge
+    std::vector<double> cumSI;		// Cumulative sequence identity, summed in the order of edges
+
+    void addEdgeMetrics(std::shared_ptr<Edge> const& edge_ptr);
+    void removeEdgeMetrics(std::shared_ptr<Edge> const& edge_ptr);
+
   public:
     std::vector<std::shared_ptr<Edge>> edges;
 
     Path(std::shared_ptr<Edge> edge_ptr);
     Path(void);
+    Path(std::shared_ptr<Path> base_path_ptr);
 
     int size(void);
     std::shared_ptr<Node> endNode(void);
     std::shared_ptr<Node> startNode(void);
 
+    bool isReversed(void);
+    EdgeView edgeAt(uint32_t idx);
+
     void appendEdge(std::shared_ptr<Edge> edge_ptr);
     std::shared_ptr<Edge> removeLastEdge(void);
 
     shared_ptr<Path> reversedPath(void);
 
+    double length(void);
+    uint32_t length2(void);
+    double avgSI(void);
+    Direction direction(void);
+    uint32_t numNegativeExtensions(void);
+    bool isConsistent(void);
+
+    uint64_t hash(void);
+
     std::string toString(void);
   };
 
@@ -164,10 +243,10 @@ namespace scara {
    */
   int checkPath(shared_ptr<Path> path);
 
-  int generatePathsDeterministic(std::vector<shared_ptr<Path>> &vPaths, MapIdToNode &aNodes, PathGenerationType pgType);
-  int generatePaths_MC(std::vector<shared_ptr<Path>> &vPaths, MapIdToNode &aNodes, uint32_t minNumPaths);
+  int generatePathsDeterministic(PathAggregator &paths, MapIdToNode &aNodes, PathGenerationType pgType, const ScaraConfig& config);
+  int generatePaths_MC(PathAggregator &paths, MapIdToNode &aNodes, uint32_t minNumPaths, const ScaraConfig& config);
 
-  int generatePathsForNode_MC(std::vector<shared_ptr<Path>> &vPaths, shared_ptr<Node> aNode, uint32_t minNumPaths, uint32_t maxNumIterations);
+  int generatePathsForNode_MC(PathAggregator &paths, shared_ptr<Node> aNode, uint32_t minNumPaths, uint32_t maxNumIterations, const ScaraConfig& config);
 
  
   unique_ptr<vector<shared_ptr<Edge>>> getBestNEdges(vector<shared_ptr<Edge>> &edges, uint32_t N, PathGenerationType pgType);
@@ -182,9 +261,11 @@ namespace scara {
   	double length;
   	uint32_t length2;
   	double avgSI;
+  	uint32_t multiplicity;		// Number of times the same path was generated
   	shared_ptr<Path> path_ptr;
 
   	PathInfo(shared_ptr<Path> t_path_ptr);
+  	PathInfo(shared_ptr<Path> t_path_ptr, uint32_t t_multiplicity);
   };
 
   class PathGroup {
@@ -196,11 +277,66 @@ namespace scara {
   	// appropriate measure
   	double length;
   	uint32_t numPaths;
+  	// Path with the highest average sequence identity, used to generate the scaffold sequence
+  	shared_ptr<PathInfo> bestPathInfo;
+  	// All paths in the group, only stored if keepPathInfos is set
+  	bool keepPathInfos;
   	std::vector<shared_ptr<PathInfo>> vPathInfos;
 
   	PathGroup();
   	PathGroup(std::string t_startNodeName, std::string t_endNodeName, double t_length);
   	PathGroup(shared_ptr<PathInfo> pathinfo_ptr);
-  	bool addPathInfo(shared_ptr<PathInfo> pinfo_ptr);
+  	PathGroup(shared_ptr<PathInfo> pathinfo_ptr, bool t_keepPathInfos);
+  	bool addPathInfo(shared_ptr<PathInfo> pinfo_ptr, double groupHalfSize);
+  };
+
+  /* KK:
+   * Collects paths as they are generated
+   * In streaming mode each path is immediately placed in its group and only group representatives are kept,
+   * so the memory used is bounded by the number of groups instead of the number of paths
+   * Otherwise all paths are stored and grouped later, using groupPath
+   * Repeated paths are found through an index with a small entry for each distinct path. In streaming mode
+   * the index is only a shortcut (a repeated path is placed into the same group again), so it is cleared when
+   * it reaches MaxStreamIndexedPaths entries. Otherwise it grows with the number of distinct paths, like vPaths.
+   */
+  class PathAggregator {
+  public:
+  	bool streaming;
+  	double groupHalfSize;								// Half size of the length bucket of a group (PathGroupHalfSize)
+  	uint32_t numPaths;									// Number of generated paths, including repeated ones
+  	std::vector<shared_ptr<Path>> vPaths;				// Distinct generated paths, empty in streaming mode
+  	std::vector<uint32_t> vPathCounts;					// Number of times each path in vPaths was generated
+  	std::vector<shared_ptr<PathGroup>> vPathGroups;		// Path groups, in order of creation
+
+  	// Maximum number of distinct paths in the index in streaming mode
+  	static const uint32_t MaxStreamIndexedPaths = 1 << 18;
+
+  	PathAggregator(bool t_streaming, double t_groupHalfSize);
+
+  	void addPath(shared_ptr<Path> path_ptr);
+  	shared_ptr<PathInfo> groupPath(shared_ptr<Path> path_ptr, uint32_t multiplicity);
+  	void restoreGroup(shared_ptr<PathGroup> pgroup_ptr);
+  	void clearPaths(void);
+
+  private:
+  	// A distinct path, found by the hash of its edge sequence
+  	// In streaming mode paths are not stored, a repeated path is recognized by its signature:
+  	// the number of edges, the first and the last edge and a second, independent hash of the edge sequence
+  	struct PathEntry {
+  		uint32_t pathIdx;						// Index in vPaths, paths are compared edge by edge
+  		uint32_t numEdges;
+  		const Edge* firstEdge;
+  		const Edge* lastEdge;
+  		uint64_t signatureHash;
+  		shared_ptr<PathGroup> pgroup_ptr;		// Only in streaming mode
+  	};
+  	std::unordered_map<uint64_t, std::vector<PathEntry>> mPathIndex;
+  	uint32_t numIndexedPaths;
+
+  	// Groups indexed by start and end node, a path can only be placed in a group with the same start and end node
+  	std::map<std::pair<std::string, std::string>, std::vector<shared_ptr<PathGroup>>> mGroupIndex;
+
+  	shared_ptr<PathInfo> orientedPathInfo(shared_ptr<Path> path_ptr, uint32_t multiplicity);
+  	shared_ptr<PathGroup> placePathInfo(shared_ptr<PathInfo> pinfo_ptr);
   };
 }
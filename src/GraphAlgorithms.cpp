@@ -9,32 +9,18 @@
 #include "Graph.h"
 #include "Overlap.h"
 #include "Sequence.h"
-#include "globals.h"
 
 namespace scara {
 
   using namespace std;
-  extern int multithreading;
 
 
   // Checking if a Path is consistent
-  // Checks if the path maintains direction along all edges and 
-  // Checks if adjecent edges share the same node
+  // Checks if the path maintains direction along all edges
+  // Adjecent edges sharing the same node is checked when appending edges to the path
   // returns 0 if the path is consistent
   int checkPath(shared_ptr<Path> path_ptr) {
-  	if (path_ptr->edges.size() > 0) {
-      shared_ptr<Edge> firstedge = path_ptr->edges.front();
-      Direction dir = D_LEFT;
-      if (firstedge->QES1 < firstedge->QES2) dir = D_RIGHT;
-      for (uint32_t i = 1; i < path_ptr->edges.size(); i++) {
-      	shared_ptr<Edge> edge = path_ptr->edges[i];
-        Direction dir2 = D_LEFT;
-        if (edge->QES1 < edge->QES2) dir2 = D_RIGHT;
-        if (dir != dir2) return 1;
-        if (firstedge->endNode != edge->startNode) return 2;
-        firstedge = edge;
-      }
-    }
+    if (!path_ptr->isConsistent()) return 1;
 
     return 0;
   }
@@ -85,7 +71,7 @@ namespace scara {
    * Generate paths choosing an edge with maximum overlap score or maximum extension scorein each step
    * In the first stop, for each anchor node consider all outgoiing edges
    */
-  int generatePathsDeterministic(vector<shared_ptr<Path>> &vPaths, MapIdToNode &aNodes, PathGenerationType pgType){
+  int generatePathsDeterministic(PathAggregator &paths, MapIdToNode &aNodes, PathGenerationType pgType, const ScaraConfig& config){
   	int pathsGenerated = 0;
 
   	/* Each read can only be used once
@@ -95,13 +81,13 @@ namespace scara {
   	 */
   	std::set<std::string> readsUsed;
   	// uint32_t numNodes = 10;		// Number of nodes placed on the stack in each step of graph traversal
-  	uint32_t numNodes = scara::NumDFSNodes;
+  	uint32_t numNodes = config.NumDFSNodes;
 
-  	if (scara::print_output)
+  	if (config.print_output)
   		std::cerr << "\nSCARA: Generating deterministic paths: ";
 
   	for (auto const& itANode : aNodes) {
-  		if (scara::print_output)
+  		if (config.print_output)
   			std::cerr << ".";			// Printing one dot for each attempt at generating a path
   		std::string aNodeName = getOGNodeName(itANode.first);
   		std::shared_ptr<Node> aNode = itANode.second;
@@ -142,9 +128,16 @@ namespace scara {
 
                 // Check if the path is too long, skip this iteration and let
                 // the above code eventually reduce the path
-                if ((uint32_t)(newPath->size()) >= scara::HardNodeLimit) continue;
+                if ((uint32_t)(newPath->size()) >= config.HardNodeLimit) continue;
 
                 newPath->appendEdge(redge_ptr);                           // Add edge to the path
+
+                // Check if the path is already longer than allowed (in bases), drop the edge and continue
+                if (config.MaxPathLength > 0 && newPath->length() > config.MaxPathLength) {
+                    newPath->removeLastEdge();
+                    continue;
+                }
+
                 readsUsed.insert(rnode_ptr->nName);                       // And mark the node as traversed
 
                 std::vector<shared_ptr<Edge>> Aedges;                                     // Edges to anchor nodes
@@ -180,7 +173,7 @@ namespace scara {
                 if (bestAedges->size() > 0u) {                                  // If anchor nodes have been reached find the best one
                     shared_ptr<Edge> aedge = (*bestAedges)[0];					// Since we are using a priority queue, no need to sort the elements
                     newPath->appendEdge(aedge);									// Create a path and end this instance of tree traversal
-                    vPaths.emplace_back(newPath);
+                    paths.addPath(newPath);
                     pathsGenerated++;
                     break;
                 } else if (bestRedges->size() > 0u) {                             // If no anchor nodes have been found we have to continue with read nodes
@@ -207,7 +200,7 @@ namespace scara {
    * Generate paths choosing an edge with the probability proportional to the extension score
    * Using Monte Carlo approach
    */
-  int generatePaths_MC(std::vector<shared_ptr<Path>> &vPaths, MapIdToNode &aNodes, uint32_t minNumPaths) {
+  int generatePaths_MC(PathAggregator &paths, MapIdToNode &aNodes, uint32_t minNumPaths, const ScaraConfig& config) {
   	uint32_t pathsGenerated = 0;
 
   	/* Each read can only be used once in a path!
@@ -215,9 +208,9 @@ namespace scara {
   	 * Currently placing read names in a set
   	 * It might be more efficient if Node pointers were used!
   	 */
-  	uint32_t maxIterations = scara::MaxMCIterations;
+  	uint32_t maxIterations = config.MaxMCIterations;
   	uint32_t iteration = 0;
-  	uint32_t numNodes = scara::NumDFSNodes;
+  	uint32_t numNodes = config.NumDFSNodes;
 
   	// Setting up random number generator
   	std::random_device rd;
@@ -231,9 +224,8 @@ namespace scara {
 
   		// Randomly choose an anchor Node
   		std::shared_ptr<Node> aNode = vANodes[dist(generator)];
+  		if (aNode->vOutEdges.size() == 0) continue;
   		std::string aNodeName = getOGNodeName(aNode->nName);
-
-  		if (aNode->vOutEdges.size() == 0) continue;			// Probably not necessary
   		float totalES = 0.0;
   		for (auto const& edge_ptr : aNode->vOutEdges) {
   			totalES += edge_ptr->QES2;
@@ -287,9 +279,16 @@ namespace scara {
 
             // Check if the path is too long skip this iteration and let
             // the above code eventually reduce the path
-            if ((uint32_t)(newPath->size()) >= scara::HardNodeLimit) continue;
+            if ((uint32_t)(newPath->size()) >= config.HardNodeLimit) continue;
 
             newPath->appendEdge(redge_ptr);                           // Add edge to the path
+
+            // Check if the path is already longer than allowed (in bases), drop the edge and continue
+            if (config.MaxPathLength > 0 && newPath->length() > config.MaxPathLength) {
+                newPath->removeLastEdge();
+                continue;
+            }
+
             readsUsed.insert(rnode_ptr->nName);                       // And mark the node as traversed
 
             std::vector<shared_ptr<Edge>> Aedges;                                     // Edges to anchor nodes
@@ -320,7 +319,7 @@ namespace scara {
             if (bestAedges->size() > 0) {                                   // If anchor nodes have been reached find the best one
                 shared_ptr<Edge> aedge = (*bestAedges)[0];
                 newPath->appendEdge(aedge);									// Create a path and end this instance of tree traversal
-                vPaths.emplace_back(newPath);
+                paths.addPath(newPath);
                 pathsGenerated++;
                 break;
             } 
@@ -355,7 +354,7 @@ namespace scara {
         }
   	}
 
-  	if (scara::print_output) std::cerr << "\nFinished Monte Carlo with " << iteration << " iterations!";
+  	if (config.print_output) std::cerr << "\nFinished Monte Carlo with " << iteration << " iterations!";
   	return pathsGenerated;
   }
 
@@ -365,7 +364,7 @@ namespace scara {
    * Using Monte Carlo approach 
    * Generate paths only for a single node
    */
-  int generatePathsForNode_MC(std::vector<shared_ptr<Path>> &vPaths, shared_ptr<Node> aNode, int minNumPaths, int maxNumIterations) {
+  int generatePathsForNode_MC(PathAggregator &paths, shared_ptr<Node> aNode, int minNumPaths, int maxNumIterations, const ScaraConfig& config) {
   	uint32_t pathsGenerated = 0;
 
   	/* Each read can only be used once in a path!
@@ -375,7 +374,7 @@ namespace scara {
   	 */
   	uint32_t maxIterations = maxNumIterations;
   	uint32_t iteration = 0;
-  	uint32_t numNodes = scara::NumDFSNodes;
+  	uint32_t numNodes = config.NumDFSNodes;
 
   	// Setting up random number generator
   	std::random_device rd;
@@ -385,9 +384,8 @@ namespace scara {
   		iteration += 1;
 
   		// Anchor Node is set through arguments
+  		if (aNode->vOutEdges.size() == 0) break;
   		std::string aNodeName = getOGNodeName(aNode->nName);
-
-  		if (aNode->vOutEdges.size() == 0) break;			// Probably not necessary
   		float totalES = 0.0;
   		for (auto const& edge_ptr : aNode->vOutEdges) {
   			float maxES = (edge_ptr->QES1 > edge_ptr->QES2) ? edge_ptr->QES1 : edge_ptr->QES2;
@@ -444,9 +442,16 @@ namespace scara {
 
             // Check if the path is too long skip this iteration and let
             // the above code eventually reduce the path
-            if ((uint32_t)(newPath->size()) >= scara::HardNodeLimit) continue;
+            if ((uint32_t)(newPath->size()) >= config.HardNodeLimit) continue;
 
             newPath->appendEdge(redge_ptr);                           // Add edge to the path
+
+            // Check if the path is already longer than allowed (in bases), drop the edge and continue
+            if (config.MaxPathLength > 0 && newPath->length() > config.MaxPathLength) {
+                newPath->removeLastEdge();
+                continue;
+            }
+
             readsUsed.insert(rnode_ptr->nName);                       // And mark the node as traversed
 
             std::vector<shared_ptr<Edge>> Aedges;                                     // Edges to anchor nodes
@@ -477,7 +482,7 @@ namespace scara {
             if (bestAedges->size() > 0) {                                   // If anchor nodes have been reached find the best one
                 shared_ptr<Edge> aedge = (*bestAedges)[0];
                 newPath->appendEdge(aedge);									// Create a path and end this instance of tree traversal
-                vPaths.emplace_back(newPath);
+                paths.addPath(newPath);
                 pathsGenerated++;
                 break;
             } 
@@ -514,7 +519,7 @@ namespace scara {
       }
   	}
 
-  	if (scara::print_output) std::cerr << "\nFinished Monte Carlo with " << iteration << " iterations!";
+  	if (config.print_output) std::cerr << "\nFinished Monte Carlo with " << iteration << " iterations!";
   	return pathsGenerated;
   }
 }
@@ -5,12 +5,10 @@
 #include "Graph.h"
 #include "Overlap.h"
 #include "Sequence.h"
-#include "globals.h"
 
 namespace scara {
 
   using namespace std;
-  extern int multithreading;
 
   std::string NodeType2String(NodeType nType) {
   	switch (nType) {
@@ -70,6 +68,25 @@ namespace scara {
   }
 
 
+  // Hash a node name so that FW and RC nodes of the same sequence differ only in the strand bit
+  // The name is hashed without the _RC suffix (FNV-1a), so no temporary strings are created
+  // If flipStrand is set, the hash of the reverse complement node is returned
+  uint64_t nodeNameHash(const std::string& nodeName, bool flipStrand) {
+  	size_t len = nodeName.size();
+  	bool isRC = (len >= 3 && nodeName.compare(len - 3, 3, "_RC") == 0);
+  	if (isRC) len -= 3;
+
+  	uint64_t hash = 14695981039346656037ULL;
+  	for (size_t i = 0; i < len; i++) {
+  		hash ^= (unsigned char)nodeName[i];
+  		hash *= 1099511628211ULL;
+  	}
+  	if (isRC != flipStrand) hash ^= 0x9E3779B97F4A7C15ULL;
+
+  	return hash;
+  }
+
+
   Node::Node(NodeType i_nType, std::string i_nName, std::shared_ptr<Sequence> i_seq_ptr
   ) : nType(i_nType), nName(i_nName), seq_ptr(i_seq_ptr), isReverseComplement(false)
   {
@@ -258,25 +275,58 @@ namespace scara {
 
   std::shared_ptr<Edge> Edge::getReversedEdge() {
   	std::shared_ptr<Edge> edge_ptr2 = make_shared<Edge>();
+  	this->getReversedEdge(*edge_ptr2);
 
-  	edge_ptr2->startNode = this->endNode;
-  	edge_ptr2->endNode = this->startNode;
+    return edge_ptr2;
+  }
 
-  	edge_ptr2->SLen 	= this->ELen;
-  	edge_ptr2->SStart 	= this->EStart;
-  	edge_ptr2->SEnd 	= this->EEnd;
-  	edge_ptr2->ELen 	= this->SLen;
-  	edge_ptr2->EStart 	= this->SStart;
-  	edge_ptr2->EEnd 	= this->SEnd;
-  	edge_ptr2->ovl_bOrientation = this->ovl_bOrientation;
+  // Fill an existing edge with the data of this edge, with start and end nodes switched
+  void Edge::getReversedEdge(Edge &rev_edge) {
+  	rev_edge.startNode = this->endNode;
+  	rev_edge.endNode = this->startNode;
 
-  	edge_ptr2->paf_matching_bases  = this->paf_matching_bases;
-    edge_ptr2->paf_overlap_length  = this->paf_overlap_length;
-    edge_ptr2->paf_mapping_quality = this->paf_mapping_quality;
+  	rev_edge.SLen 	= this->ELen;
+  	rev_edge.SStart = this->EStart;
+  	rev_edge.SEnd 	= this->EEnd;
+  	rev_edge.ELen 	= this->SLen;
+  	rev_edge.EStart = this->SStart;
+  	rev_edge.EEnd 	= this->SEnd;
+  	rev_edge.ovl_bOrientation = this->ovl_bOrientation;
 
-    edge_ptr2->calcEdgeStats();
+  	rev_edge.paf_matching_bases  = this->paf_matching_bases;
+    rev_edge.paf_overlap_length  = this->paf_overlap_length;
+    rev_edge.paf_mapping_quality = this->paf_mapping_quality;
 
-    return edge_ptr2;
+    rev_edge.calcEdgeStats();
+  }
+
+  // Direction in which the edge extends the start node
+  Direction Edge::direction(void) {
+  	return (QES1 < QES2) ? D_RIGHT : D_LEFT;
+  }
+
+
+  EdgeView::EdgeView(Edge* t_edge_ptr, bool t_reversed) : edge_ptr(t_edge_ptr), reversed(t_reversed)
+  {
+  }
+
+  std::shared_ptr<Node> const& EdgeView::startNode(void) const { return reversed ? edge_ptr->endNode : edge_ptr->startNode; }
+  std::shared_ptr<Node> const& EdgeView::endNode(void) const { return reversed ? edge_ptr->startNode : edge_ptr->endNode; }
+
+  uint32_t EdgeView::SLen(void) const { return reversed ? edge_ptr->ELen : edge_ptr->SLen; }
+  uint32_t EdgeView::SStart(void) const { return reversed ? edge_ptr->EStart : edge_ptr->SStart; }
+  uint32_t EdgeView::SEnd(void) const { return reversed ? edge_ptr->EEnd : edge_ptr->SEnd; }
+  uint32_t EdgeView::ELen(void) const { return reversed ? edge_ptr->SLen : edge_ptr->ELen; }
+  uint32_t EdgeView::EStart(void) const { return reversed ? edge_ptr->SStart : edge_ptr->EStart; }
+  uint32_t EdgeView::EEnd(void) const { return reversed ? edge_ptr->SEnd : edge_ptr->EEnd; }
+  float EdgeView::SI(void) const { return edge_ptr->SI; }
+
+  // Extension scores are not symmetric, for a reversed edge they are calculated on a temporary Edge on the stack
+  Direction EdgeView::direction(void) const {
+  	if (!reversed) return edge_ptr->direction();
+  	Edge rev_edge;
+  	edge_ptr->getReversedEdge(rev_edge);
+  	return rev_edge.direction();
   }
 
 
@@ -365,7 +415,7 @@ namespace scara {
   // - length of aligned part is to short compared to overhangs - returns -2
   // - mapping quality is too low - returns -3
   // If the read is usable, the function returns 1
-  int Edge::test(void) {
+  int Edge::test(const ScaraConfig& config) {
   	// float minQOH = (QOH1 < QOH2) ? QOH1 : QOH2;          // Smaller query overhang, will be used to determine if the overlap is discarded
     // float minTOH = (TOH1 < TOH2) ? TOH1 : TOH2;          // Smaller target overhang, will be used to determine if the overlap is discarded
 
@@ -380,8 +430,8 @@ namespace scara {
 
     // New test for short overlaps (large overhangs)
     float avg_ovl_len = (QOL+TOL)/2;
-    if (test_short_length) {
-        if ((minOH1 + minOH2)/avg_ovl_len > scara::OHmax) {
+    if (config.test_short_length) {
+        if ((minOH1 + minOH2)/avg_ovl_len > config.OHmax) {
             return -2;
         }
     }
@@ -389,7 +439,7 @@ namespace scara {
     // Test for contained reads
     // Has to come after test for short aligned length, if the overlap is of too short a length
     // Its probably a false overlap
-    if (test_contained_reads){
+    if (config.test_contained_reads){
         if (QOH1 >= TOH1 && QOH2 >= TOH2) {
             // Target is contained within the query
             // Discarding the overlap and target read
@@ -407,8 +457,8 @@ namespace scara {
     }
 
     // Test for low quality overlap
-    if (test_low_quality) {
-        if (SI < scara::SImin) {
+    if (config.test_low_quality) {
+        if (SI < config.SImin) {
             return -3;
         }
     }
@@ -545,39 +595,85 @@ namespace scara {
 
 
 
-  Path::Path(std::shared_ptr<Edge> edge_ptr) :  edges()
+  Path::Path(std::shared_ptr<Edge> edge_ptr)
+    : reversed(false), extLength(0), extLength2(0), numNegativeExt(0), numNegativeExtRev(0), numDirChanges(0), edges()
   {
     edges.emplace_back(edge_ptr);
+    addEdgeMetrics(edge_ptr);
+  }
+
+  Path::Path(void)
+    : reversed(false), extLength(0), extLength2(0), numNegativeExt(0), numNegativeExtRev(0), numDirChanges(0), edges()
+  {
   }
 
-  Path::Path(void) : edges()
+  // Create a view of a path in the reverse direction
+  Path::Path(std::shared_ptr<Path> base_path_ptr)
+    : reversed(true), basePath(base_path_ptr), extLength(0), extLength2(0), numNegativeExt(0), numNegativeExtRev(0)
+    , numDirChanges(0), edges()
   {
+  	if (base_path_ptr->reversed) {
+  		throw std::runtime_error(std::string("SCARA BRIDGER: ERROR - Creating a view of a reversed path!"));
+  	}
   }
 
   // Appends an Edge to a Path
   // The path must be empty or the end node of the last Edge must be the same as the start node of the new Edge
   void Path::appendEdge(std::shared_ptr<Edge> edge_ptr) {
-    if (edges.empty()) {
-      edges.emplace_back(edge_ptr);
+    if (reversed) {
+      throw std::runtime_error(std::string("Unable to append an Edge to a reversed Path!"));
     }
-    else {
-      std::string lastEndNode = edges.back()->getEndNodeName();
-      std::string newStartNode = edge_ptr->getStartNodeName();
-      if (lastEndNode.compare(newStartNode) == 0) {
-        edges.emplace_back(edge_ptr);
-      }
-      else {
-        throw std::runtime_error(std::string("Unable to append an Edge to a Path. Incompatible nodes: ") + lastEndNode + " | " + newStartNode);
-      }
+    if (!edges.empty() && edges.back()->endNode != edge_ptr->startNode) {
+      throw std::runtime_error(std::string("Unable to append an Edge to a Path. Incompatible nodes: ")
+        + edges.back()->getEndNodeName() + " | " + edge_ptr->getStartNodeName());
     }
+    edges.emplace_back(edge_ptr);
+    addEdgeMetrics(edge_ptr);
+  }
+
+  // Extension of the end node in a path, the part of the end node that does not overlap with the start node
+  // (End overhang - start overhang)
+  static int64_t edgeExtension(std::shared_ptr<Edge> const& edge_ptr) {
+    return (int64_t)(edge_ptr->ELen - edge_ptr->EEnd) - (int64_t)(edge_ptr->SLen - edge_ptr->SEnd);
+  }
+
+  static bool negativeExtension(std::shared_ptr<Edge> const& edge_ptr) {
+    return (edge_ptr->SStart <= edge_ptr->EStart) || ((edge_ptr->ELen - edge_ptr->EEnd) <= (edge_ptr->SLen - edge_ptr->SEnd));
+  }
+
+  // The same test, for an edge with start and end nodes switched
+  static bool negativeExtensionRev(std::shared_ptr<Edge> const& edge_ptr) {
+    return (edge_ptr->EStart <= edge_ptr->SStart) || ((edge_ptr->SLen - edge_ptr->SEnd) <= (edge_ptr->ELen - edge_ptr->EEnd));
+  }
+
+  // Update running metrics for an edge that was just added to the end of the path
+  void Path::addEdgeMetrics(std::shared_ptr<Edge> const& edge_ptr) {
+    extLength += edgeExtension(edge_ptr);
+    extLength2 += edge_ptr->SStart - edge_ptr->EStart;
+    if (negativeExtension(edge_ptr)) numNegativeExt++;
+    if (negativeExtensionRev(edge_ptr)) numNegativeExtRev++;
+    if (edges.size() > 1 && edge_ptr->direction() != direction()) numDirChanges++;
+    cumSI.emplace_back((cumSI.empty() ? 0.0 : cumSI.back()) + edge_ptr->SI);
+  }
+
+  // Update running metrics for an edge that was just removed from the end of the path
+  void Path::removeEdgeMetrics(std::shared_ptr<Edge> const& edge_ptr) {
+    extLength -= edgeExtension(edge_ptr);
+    extLength2 -= edge_ptr->SStart - edge_ptr->EStart;
+    if (negativeExtension(edge_ptr)) numNegativeExt--;
+    if (negativeExtensionRev(edge_ptr)) numNegativeExtRev--;
+    if (!edges.empty() && edge_ptr->direction() != direction()) numDirChanges--;
+    cumSI.pop_back();
   }
 
   // Size of the path
   int Path::size(void) {
+  	if (reversed) return basePath->size();
   	return edges.size();
   }
 
   std::shared_ptr<Node> Path::endNode(void) {
+  	if (reversed) return basePath->startNode();
   	if (edges.size() == 0) {
   		return NULL;
   	}
@@ -588,6 +684,7 @@ namespace scara {
 
 
   std::shared_ptr<Node> Path::startNode(void) {
+  	if (reversed) return basePath->endNode();
   	if (edges.size() == 0) {
   		return NULL;
   	}
@@ -596,39 +693,124 @@ namespace scara {
   	}
   }
 
+  bool Path::isReversed(void) {
+  	return reversed;
+  }
+
+  // Edge at a given position in the path, in the direction of the path
+  EdgeView Path::edgeAt(uint32_t idx) {
+  	if (reversed) {
+  		std::vector<std::shared_ptr<Edge>> &baseEdges = basePath->edges;
+  		return EdgeView(baseEdges[baseEdges.size() - 1 - idx].get(), true);
+  	}
+  	return EdgeView(edges[idx].get(), false);
+  }
+
   std::shared_ptr<Edge> Path::removeLastEdge(void){
+    if (reversed) {
+      throw std::runtime_error(std::string("Unable to remove an Edge from a reversed Path!"));
+    }
     auto last_edge = edges.back();
   	edges.pop_back();
+    removeEdgeMetrics(last_edge);
     return last_edge;
   }
 
-  // Return a reversed path, reverse order of edges and each edge
-  shared_ptr<Path> Path::reversedPath(void) {
-  	shared_ptr<Path> newPath = make_shared<Path>();
+  // Length of the path in bases, the whole first node and the extension for each edge
+  // For a reversed path, extensions of all edges change sign
+  double Path::length(void) {
+  	if (reversed) {
+  		if (basePath->edges.empty()) return 0.0;
+  		return basePath->edges.back()->ELen - basePath->extLength;
+  	}
+  	if (edges.empty()) return 0.0;
+  	return edges.front()->SLen + extLength;
+  }
+
+  // Length of the path in bases, calculated using start positions of overlaps and the whole last node
+  uint32_t Path::length2(void) {
+  	if (reversed) {
+  		if (basePath->edges.empty()) return 0;
+  		return basePath->edges.front()->SLen - basePath->extLength2;
+  	}
+  	if (edges.empty()) return 0;
+  	return extLength2 + edges.back()->ELen;
+  }
+
+  // For a reversed path SI is summed in the reverse order of edges
+  double Path::avgSI(void) {
+  	if (reversed) {
+  		std::vector<std::shared_ptr<Edge>> &baseEdges = basePath->edges;
+  		if (baseEdges.empty()) return 0.0;
+  		double sumSI = 0.0;
+  		for (auto it = baseEdges.rbegin(); it != baseEdges.rend(); it++) sumSI += (*it)->SI;
+  		return sumSI / baseEdges.size();
+  	}
+  	if (edges.empty()) return 0.0;
+  	return cumSI.back() / edges.size();
+  }
+
+  // Direction of the path is determined by its first edge
+  Direction Path::direction(void) {
+  	if (size() == 0) return D_LEFT;
+  	if (reversed) return edgeAt(0).direction();
+  	return edges.front()->direction();
+  }
+
+  uint32_t Path::numNegativeExtensions(void) {
+  	if (reversed) return basePath->numNegativeExtRev;
+  	return numNegativeExt;
+  }
 
-  	if (edges.size() > 0) {
-  		for (int i = edges.size()-1; i >= 0; i--) {
-  			shared_ptr<Edge> edge = edges[i];
-  			shared_ptr<Edge> newEdge = edge->getReversedEdge();
-  			newPath->appendEdge(newEdge);
+  // A path is consistent if all edges have the same direction
+  // Adjacent edges sharing the same node is ensured when appending
+  bool Path::isConsistent(void) {
+  	if (reversed) {
+  		uint32_t numEdges = size();
+  		if (numEdges == 0) return true;
+  		Direction dir = direction();
+  		for (uint32_t i = 1; i < numEdges; i++) {
+  			if (edgeAt(i).direction() != dir) return false;
   		}
+  		return true;
+  	}
+  	return numDirChanges == 0;
+  }
+
+  // Return a reversed path, a view traversing edges in reverse order with start and end nodes switched
+  shared_ptr<Path> Path::reversedPath(void) {
+  	if (reversed) return basePath;
+  	return make_shared<Path>(shared_from_this());
+  }
+
+  // Hash of the sequence of edges in a path
+  // Edges are shared between paths, so the same path always consists of the same Edge objects
+  uint64_t Path::hash(void) {
+  	if (reversed) return basePath->hash() ^ 0x9E3779B97F4A7C15ULL;
+
+  	uint64_t hash = 14695981039346656037ULL;
+  	for (auto const& edge_ptr : edges) {
+  		hash ^= (uint64_t)(uintptr_t)(edge_ptr.get());
+  		hash *= 1099511628211ULL;
+  		hash ^= hash >> 29;
   	}
 
-  	return newPath;
+  	return hash;
   }
 
   std::string Path::toString(void){
-  	size_t size = this->edges.size();
+  	uint32_t size = this->size();
   	std::string strPath = "Nodes: " + std::to_string(size) + " | ";
   	if (size > 10) {
-  		auto first = this->edges.front();
-  		auto last  = this->edges.back();
-  		strPath += "(" + first->getStartNodeName() + ", " + first->getEndNodeName() + ") ... ";
-  		strPath += "(" + last->getStartNodeName() + ", " + last->getEndNodeName() + ")";
+  		EdgeView first = this->edgeAt(0);
+  		EdgeView last  = this->edgeAt(size - 1);
+  		strPath += "(" + first.startNode()->nName + ", " + first.endNode()->nName + ") ... ";
+  		strPath += "(" + last.startNode()->nName + ", " + last.endNode()->nName + ")";
   	}
   	else {
-  		for (auto const& t_edge_ptr : this->edges) {
-  			strPath += "(" + t_edge_ptr->getStartNodeName() + ", " + t_edge_ptr->getEndNodeName() + ") ";
+  		for (uint32_t i = 0; i < size; i++) {
+  			EdgeView t_edge = this->edgeAt(i);
+  			strPath += "(" + t_edge.startNode()->nName + ", " + t_edge.endNode()->nName + ") ";
   		}	
   	}
 
@@ -638,77 +820,72 @@ namespace scara {
 
   // Summary information about paths
   // Used to later group paths by start and end node
-  PathInfo::PathInfo(shared_ptr<Path> t_path_ptr) : path_ptr(t_path_ptr)
+  PathInfo::PathInfo(shared_ptr<Path> t_path_ptr) : PathInfo(t_path_ptr, 1)
   {
-  	this->length = this->length2 = this->avgSI = 0.0;
-  	this->path_ptr = t_path_ptr;
-    uint32_t negativeEScount = 0;
-
-  	if (t_path_ptr->edges.size() > 0) {
-  		this->numNodes = t_path_ptr->edges.size() + 1;
-  		shared_ptr<Edge> firstEdge = t_path_ptr->edges.front();
-  		shared_ptr<Edge> lastEdge = t_path_ptr->edges.back();
-  		this->startNodeName = firstEdge->getStartNodeName();
-  		this->endNodeName = lastEdge->getEndNodeName();
-  		this->pathDir = D_LEFT;
-      	if (firstEdge->QES1 < firstEdge->QES2) this->pathDir = D_RIGHT;
-
-  		// NOTE: All edges should be extending the Query with the Target to the right
-  		// Correct values should be stored in the edge object
-  		// There should be no switching strands
-
-  		// Add the length of the first Node (start node of the first edge)
-  		this->length += firstEdge->SLen;
-	  	for (auto const& edge : t_path_ptr->edges) {
-	  		this->avgSI += edge->SI;
-	  		// For each edge, add to the length of the path part of the end node that 
-	  		// does not overlap with the start node (End overhang - start overhang)
-	  		this->length += (edge->ELen - edge->EEnd) - (edge->SLen - edge->SEnd);
-	  		this->length2 += edge->SStart - edge->EStart;
-	  		
-	        if ((edge->SStart <= edge->EStart) || ((edge->ELen - edge->EEnd) <= (edge->SLen - edge->SEnd))){
-				  negativeEScount++;
-	        }
-	    }
-	    this->length2 += lastEdge->ELen;
-
-	  	this->avgSI /= t_path_ptr->edges.size();
+  }
+
+  PathInfo::PathInfo(shared_ptr<Path> t_path_ptr, uint32_t t_multiplicity) : multiplicity(t_multiplicity), path_ptr(t_path_ptr)
+  {
+  	// NOTE: All edges should be extending the Query with the Target to the right
+  	// Correct values should be stored in the edge object
+  	// There should be no switching strands
+  	// Path metrics are maintained by the path itself, while edges are added
+  	if (t_path_ptr->size() > 0) {
+  		this->numNodes = t_path_ptr->size() + 1;
+  		this->startNodeName = t_path_ptr->startNode()->nName;
+  		this->endNodeName = t_path_ptr->endNode()->nName;
+  		this->pathDir = t_path_ptr->direction();
+  		this->length = t_path_ptr->length();
+  		this->length2 = t_path_ptr->length2();
+  		this->avgSI = t_path_ptr->avgSI();
+
+  		uint32_t negativeEScount = t_path_ptr->numNegativeExtensions();
       	if (negativeEScount > 0) 
          	throw std::runtime_error(std::string("SCARA BRIDGER: ERROR - path with negative extensions (" 
         		+ std::to_string(negativeEScount) + ") SN(" + startNodeName + ") EN(" + endNodeName + ")"
          		+ " - " + t_path_ptr->toString()));
   	}
   	else {
+  		this->length = this->length2 = this->avgSI = 0.0;
+  		this->pathDir = D_LEFT;
   		numNodes = 0;
   		startNodeName = "";
   		endNodeName = "";
   	}
   }
 
-  PathGroup::PathGroup() : startNodeName(""), endNodeName(""), length(0.0), numPaths(0)
+  PathGroup::PathGroup() : startNodeName(""), endNodeName(""), length(0.0), numPaths(0), keepPathInfos(true)
   {
   }
 
   PathGroup::PathGroup(std::string t_startNodeName, std::string t_endNodeName, double t_length
-    ) : startNodeName(t_startNodeName), endNodeName(t_endNodeName), length(t_length), numPaths(0)
+    ) : startNodeName(t_startNodeName), endNodeName(t_endNodeName), length(t_length), numPaths(0), keepPathInfos(true)
   {
   }
   
 
   PathGroup::PathGroup(shared_ptr<PathInfo> pinfo_ptr
-    ) : startNodeName(pinfo_ptr->startNodeName), endNodeName(pinfo_ptr->endNodeName), length(pinfo_ptr->length), numPaths(1)
+    ) : startNodeName(pinfo_ptr->startNodeName), endNodeName(pinfo_ptr->endNodeName), length(pinfo_ptr->length)
+      , numPaths(pinfo_ptr->multiplicity), bestPathInfo(pinfo_ptr), keepPathInfos(true)
   {
     vPathInfos.emplace_back(pinfo_ptr);
   }
 
+  PathGroup::PathGroup(shared_ptr<PathInfo> pinfo_ptr, bool t_keepPathInfos
+    ) : startNodeName(pinfo_ptr->startNodeName), endNodeName(pinfo_ptr->endNodeName), length(pinfo_ptr->length)
+      , numPaths(pinfo_ptr->multiplicity), bestPathInfo(pinfo_ptr), keepPathInfos(t_keepPathInfos)
+  {
+    if (keepPathInfos) vPathInfos.emplace_back(pinfo_ptr);
+  }
+
   // KK: Allow adding a path info for a reverse path!
-  bool PathGroup::addPathInfo(shared_ptr<PathInfo> pinfo_ptr) {
+  bool PathGroup::addPathInfo(shared_ptr<PathInfo> pinfo_ptr, double groupHalfSize) {
     bool equal = false;
 
     // New path belong in the group in original orientation
     if ((pinfo_ptr->startNodeName.compare(this->startNodeName) == 0) &&
         (pinfo_ptr->endNodeName.compare(this->endNodeName) == 0) &&
-        (fabs(pinfo_ptr->length - this->length) <= scara::PathGroupHalfSize)) equal = true;
+        (fabs(pinfo_ptr->length - this->length) <= groupHalfSize)) equal = true;
 
     /*
     // New path belongs in the group in reverse orientation
@@ -718,11 +895,121 @@ namespace scara {
     */
 
     if (equal) {
-      vPathInfos.emplace_back(pinfo_ptr);
-      numPaths += 1;
+      if (keepPathInfos) vPathInfos.emplace_back(pinfo_ptr);
+      numPaths += pinfo_ptr->multiplicity;
+      // The first path with the highest average SI is kept as the best one
+      if (bestPathInfo == NULL || pinfo_ptr->avgSI > bestPathInfo->avgSI) bestPathInfo = pinfo_ptr;
     }
     return equal;
 
   }
 
+
+  PathAggregator::PathAggregator(bool t_streaming, double t_groupHalfSize) : streaming(t_streaming), groupHalfSize(t_groupHalfSize), numPaths(0)
+    , numIndexedPaths(0)
+  {
+  }
+
+  // Second hash of the edge sequence, independent of Path::hash (different mixing of edge addresses)
+  static uint64_t pathSignatureHash(const std::vector<shared_ptr<Edge>>& edges) {
+    uint64_t hash = 0x243F6A8885A308D3ULL;
+    for (auto const& edge_ptr : edges) {
+      uint64_t x = (uint64_t)(uintptr_t)(edge_ptr.get());
+      x ^= x >> 33;
+      x *= 0xFF51AFD7ED558CCDULL;
+      x ^= x >> 33;
+      hash = (hash + x) * 0xC4CEB9FE1A85EC53ULL;
+    }
+    return hash;
+  }
+
+  // Add a newly generated path
+  // Repeated paths are only counted, each distinct path is stored (or grouped in streaming mode) once
+  void PathAggregator::addPath(shared_ptr<Path> path_ptr) {
+    numPaths += 1;
+    const std::vector<shared_ptr<Edge>> &edges = path_ptr->edges;
+    uint32_t numEdges = edges.size();
+    const Edge* firstEdge = edges.empty() ? NULL : edges.front().get();
+    const Edge* lastEdge = edges.empty() ? NULL : edges.back().get();
+    uint64_t signatureHash = pathSignatureHash(edges);
+
+    if (streaming && numIndexedPaths >= MaxStreamIndexedPaths) {
+      mPathIndex.clear();
+      numIndexedPaths = 0;
+    }
+    std::vector<PathEntry> &vEntries = mPathIndex[path_ptr->hash()];
+    for (auto const& entry : vEntries) {
+      if (entry.numEdges != numEdges || entry.firstEdge != firstEdge || entry.lastEdge != lastEdge
+          || entry.signatureHash != signatureHash) continue;
+      // KK: In streaming mode paths are not kept, so the signature identifies a path
+      if (streaming) {
+        entry.pgroup_ptr->numPaths += 1;
+        return;
+      }
+      if (vPaths[entry.pathIdx]->edges == edges) {
+        vPathCounts[entry.pathIdx] += 1;
+        return;
+      }
+    }
+
+    PathEntry entry;
+    entry.numEdges = numEdges;
+    entry.firstEdge = firstEdge;
+    entry.lastEdge = lastEdge;
+    entry.signatureHash = signatureHash;
+    numIndexedPaths++;
+    if (streaming) {
+      entry.pathIdx = 0;
+      entry.pgroup_ptr = placePathInfo(orientedPathInfo(path_ptr, 1));
+    }
+    else {
+      entry.pathIdx = vPaths.size();
+      vPaths.emplace_back(path_ptr);
+      vPathCounts.emplace_back(1);
+    }
+    vEntries.emplace_back(entry);
+  }
+
+  // Place the path into an existing group or create a new one
+  shared_ptr<PathInfo> PathAggregator::groupPath(shared_ptr<Path> path_ptr, uint32_t multiplicity) {
+    shared_ptr<PathInfo> pathinfo_ptr = orientedPathInfo(path_ptr, multiplicity);
+    placePathInfo(pathinfo_ptr);
+    return pathinfo_ptr;
+  }
+
+  // Create PathInfo for a path, path extending to the left is reversed so that all paths extend to the right
+  shared_ptr<PathInfo> PathAggregator::orientedPathInfo(shared_ptr<Path> path_ptr, uint32_t multiplicity) {
+    if (path_ptr->direction() == D_RIGHT) return make_shared<PathInfo>(path_ptr, multiplicity);
+    else return make_shared<PathInfo>(path_ptr->reversedPath(), multiplicity);
+  }
+
+  // Add PathInfo to the first matching group, or create a new group for it
+  shared_ptr<PathGroup> PathAggregator::placePathInfo(shared_ptr<PathInfo> pathinfo_ptr) {
+    std::vector<shared_ptr<PathGroup>> &vGroups = mGroupIndex[std::make_pair(pathinfo_ptr->startNodeName, pathinfo_ptr->endNodeName)];
+    for (auto const& pgroup_ptr : vGroups) {
+      if (pgroup_ptr->addPathInfo(pathinfo_ptr, groupHalfSize)) return pgroup_ptr;
+    }
+
+    shared_ptr<PathGroup> pgroup_ptr = make_shared<PathGroup>(pathinfo_ptr, !streaming);
+    vGroups.emplace_back(pgroup_ptr);
+    vPathGroups.emplace_back(pgroup_ptr);
+    return pgroup_ptr;
+  }
+
+  // Add an existing group, restored from a checkpoint
+  void PathAggregator::restoreGroup(shared_ptr<PathGroup> pgroup_ptr) {
+    mGroupIndex[std::make_pair(pgroup_ptr->startNodeName, pgroup_ptr->endNodeName)].emplace_back(pgroup_ptr);
+    vPathGroups.emplace_back(pgroup_ptr);
+  }
+
+  // Release stored paths, groups keep pointers to paths they need
+  void PathAggregator::clearPaths(void) {
+    vPaths.clear();
+    vPaths.shrink_to_fit();
+    vPathCounts.clear();
+    vPathCounts.shrink_to_fit();
+    mPathIndex.clear();
+    numIndexedPaths = 0;
+  }
+
 }
\ No newline at end of file
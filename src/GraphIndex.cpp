@@ -0,0 +1,271 @@
+#include "SBridger.h"
+#include "MappedFile.h"
+
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace scara {
+
+  using namespace std;
+
+  /* KK:
+   * Graph index, the filtered graph stored in a single file: node table, adjacency (outgoing edges of
+   * each node, in order) with edge metrics, filtering statistics and parameters used for filtering.
+   * All references are offsets and indices, so the file can be mapped at any address.
+   * Node names refer to the graph nodes (with _RC for reverse complements), sequences themselves are
+   * not stored, they are taken from the reads and contigs files when the index is loaded.
+   */
+  static const char graphIndexMagic[8] = {'S', 'C', 'G', 'R', 'A', 'P', 'H', '\0'};
+  static const uint32_t GraphIndexVersion = 1;
+
+  struct GraphIndexHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t testFlags;         // test_short_length, test_contained_reads, test_low_quality
+    float SImin;
+    float OHmax;
+
+    uint32_t numEdges_usable;
+    uint32_t numEdges_contained;
+    uint32_t numEdges_short;
+    uint32_t numEdges_lowqual;
+    uint32_t numEdges_zero;
+    uint32_t reserved;
+
+    uint64_t numNodes;
+    uint64_t numEdges;
+    uint64_t nodesOffset;
+    uint64_t edgesOffset;
+    uint64_t namesOffset;
+    uint64_t namesSize;
+  };
+
+  struct GraphIndexNode {
+    uint64_t nameOffset;
+    uint64_t firstEdge;         // Outgoing edges are [firstEdge, firstEdge + numEdges)
+    uint32_t nameLength;
+    uint32_t numEdges;
+    uint32_t seqLength;
+    uint8_t nType;
+    uint8_t isReverseComplement;
+    uint16_t reserved;
+  };
+
+  struct GraphIndexEdge {
+    uint32_t startNode, endNode;
+    uint32_t SLen, SStart, SEnd, ELen, EStart, EEnd;
+    uint32_t orientation;
+    uint32_t paf_matching_bases, paf_overlap_length, paf_mapping_quality;
+    uint32_t QOH1, QOH2, TOH1, TOH2, QOL, TOL;
+    float SI, OS, QES1, QES2, TES1, TES2;
+  };
+
+  static uint32_t graphTestFlags(const ScaraConfig& config) {
+    return (config.test_short_length ? 1 : 0) | (config.test_contained_reads ? 2 : 0) | (config.test_low_quality ? 4 : 0);
+  }
+
+  void SBridger::saveGraphIndex(const std::string& strIndex) {
+    std::vector<const Node*> vNodes;
+    std::unordered_map<const Node*, uint32_t> mNodeIndex;
+    for (auto const* mNodes : {&mAnchorNodes, &mReadNodes}) {
+      for (auto const& it : *mNodes) {
+        mNodeIndex.emplace(it.second.get(), vNodes.size());
+        vNodes.emplace_back(it.second.get());
+      }
+    }
+
+    std::vector<GraphIndexNode> vIndexNodes;
+    std::vector<GraphIndexEdge> vIndexEdges;
+    std::string strNames;
+    vIndexNodes.reserve(vNodes.size());
+    for (auto const* node : vNodes) {
+      GraphIndexNode indexNode;
+      memset(&indexNode, 0, sizeof(indexNode));
+      indexNode.nameOffset = strNames.size();
+      indexNode.nameLength = node->nName.size();
+      indexNode.firstEdge = vIndexEdges.size();
+      indexNode.numEdges = node->vOutEdges.size();
+      indexNode.seqLength = node->seq_ptr->length();
+      indexNode.nType = node->nType;
+      indexNode.isReverseComplement = node->isReverseComplement;
+      strNames += node->nName;
+
+      for (auto const& edge_ptr : node->vOutEdges) {
+        const Edge& edge = *edge_ptr;
+        GraphIndexEdge indexEdge;
+        indexEdge.startNode = mNodeIndex.at(edge.startNode.get());
+        indexEdge.endNode = mNodeIndex.at(edge.endNode.get());
+        indexEdge.SLen = edge.SLen;
+        indexEdge.SStart = edge.SStart;
+        indexEdge.SEnd = edge.SEnd;
+        indexEdge.ELen = edge.ELen;
+        indexEdge.EStart = edge.EStart;
+        indexEdge.EEnd = edge.EEnd;
+        indexEdge.orientation = edge.ovl_bOrientation;
+        indexEdge.paf_matching_bases = edge.paf_matching_bases;
+        indexEdge.paf_overlap_length = edge.paf_overlap_length;
+        indexEdge.paf_mapping_quality = edge.paf_mapping_quality;
+        indexEdge.QOH1 = edge.QOH1;
+        indexEdge.QOH2 = edge.QOH2;
+        indexEdge.TOH1 = edge.TOH1;
+        indexEdge.TOH2 = edge.TOH2;
+        indexEdge.QOL = edge.QOL;
+        indexEdge.TOL = edge.TOL;
+        indexEdge.SI = edge.SI;
+        indexEdge.OS = edge.OS;
+        indexEdge.QES1 = edge.QES1;
+        indexEdge.QES2 = edge.QES2;
+        indexEdge.TES1 = edge.TES1;
+        indexEdge.TES2 = edge.TES2;
+        vIndexEdges.emplace_back(indexEdge);
+      }
+      vIndexNodes.emplace_back(indexNode);
+    }
+
+    GraphIndexHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, graphIndexMagic, sizeof(header.magic));
+    header.version = GraphIndexVersion;
+    header.testFlags = graphTestFlags(config);
+    header.SImin = config.SImin;
+    header.OHmax = config.OHmax;
+    header.numEdges_usable = numEdges_usable;
+    header.numEdges_contained = numEdges_contained;
+    header.numEdges_short = numEdges_short;
+    header.numEdges_lowqual = numEdges_lowqual;
+    header.numEdges_zero = numEdges_zero;
+    header.numNodes = vIndexNodes.size();
+    header.numEdges = vIndexEdges.size();
+    header.nodesOffset = sizeof(header);
+    header.edgesOffset = header.nodesOffset + vIndexNodes.size() * sizeof(GraphIndexNode);
+    header.namesOffset = header.edgesOffset + vIndexEdges.size() * sizeof(GraphIndexEdge);
+    header.namesSize = strNames.size();
+
+    // Written into a temporary file, so that an interrupted run does not leave an invalid index
+    std::string strTemp = strIndex + ".tmp";
+    ofstream out(strTemp, ios::binary | ios::trunc);
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)vIndexNodes.data(), vIndexNodes.size() * sizeof(GraphIndexNode));
+    out.write((const char*)vIndexEdges.data(), vIndexEdges.size() * sizeof(GraphIndexEdge));
+    out.write(strNames.data(), strNames.size());
+    out.close();
+    if (!out || rename(strTemp.c_str(), strIndex.c_str()) != 0) {
+      remove(strTemp.c_str());
+      throw std::runtime_error(std::string("SCARA GRAPHINDEX: ERROR - unable to write graph index: ") + strIndex);
+    }
+
+    if (config.debugLevel >= DL_INFO) {
+      cerr << "SCARA GRAPHINDEX: Saved graph with " << vIndexNodes.size() << " nodes and " << vIndexEdges.size()
+           << " edges into " << strIndex << endl;
+    }
+  }
+
+  /* KK:
+   * Nodes must already be created from the loaded sequences, the index must contain exactly the same nodes
+   * Edges are created from the mapped index and attached to nodes in the stored order
+   */
+  void SBridger::loadGraphIndex(const std::string& strIndex) {
+    MappedFile file(strIndex);
+    const char* data = file.data();
+    const uint64_t size = file.size();
+    auto corrupted = [&strIndex]() {
+      throw std::runtime_error(std::string("SCARA GRAPHINDEX: ERROR - invalid graph index: ") + strIndex);
+    };
+
+    if (size < sizeof(GraphIndexHeader)) corrupted();
+    const GraphIndexHeader& header = *(const GraphIndexHeader*)data;
+    if (memcmp(header.magic, graphIndexMagic, sizeof(header.magic)) != 0) corrupted();
+    if (header.version != GraphIndexVersion) {
+      throw std::runtime_error(std::string("SCARA GRAPHINDEX: ERROR - unsupported graph index version: ") + strIndex);
+    }
+    if (header.numNodes > size / sizeof(GraphIndexNode) || header.numEdges > size / sizeof(GraphIndexEdge)) corrupted();
+    if (header.nodesOffset != sizeof(GraphIndexHeader)
+        || header.edgesOffset != header.nodesOffset + header.numNodes * sizeof(GraphIndexNode)
+        || header.namesOffset != header.edgesOffset + header.numEdges * sizeof(GraphIndexEdge)
+        || header.namesOffset + header.namesSize != size) corrupted();
+
+    // KK: The stored graph was filtered with the stored parameters, using it with other parameters would silently
+    // produce scaffolds for a different graph
+    if (header.testFlags != graphTestFlags(config) || header.SImin != config.SImin || header.OHmax != config.OHmax) {
+      throw std::runtime_error(std::string("SCARA GRAPHINDEX: ERROR - graph index ") + strIndex + " was built with different filtering parameters"
+                               + " (SImin " + to_string(header.SImin) + ", OHmax " + to_string(header.OHmax)
+                               + ", test flags " + to_string(header.testFlags) + "), save the graph again with the current parameters");
+    }
+
+    const GraphIndexNode* indexNodes = (const GraphIndexNode*)(data + header.nodesOffset);
+    const GraphIndexEdge* indexEdges = (const GraphIndexEdge*)(data + header.edgesOffset);
+    const char* names = data + header.namesOffset;
+
+    // Match stored nodes with the nodes created from sequences
+    if (header.numNodes != mAnchorNodes.size() + mReadNodes.size()) {
+      throw std::runtime_error(std::string("SCARA GRAPHINDEX: ERROR - graph index does not match input sequences: ") + strIndex);
+    }
+    std::vector<std::shared_ptr<Node>> vNodes(header.numNodes);
+    for (uint64_t i = 0; i < header.numNodes; i++) {
+      const GraphIndexNode& indexNode = indexNodes[i];
+      if (indexNode.nameOffset + indexNode.nameLength > header.namesSize
+          || indexNode.firstEdge + indexNode.numEdges > header.numEdges) corrupted();
+      std::string strName(names + indexNode.nameOffset, indexNode.nameLength);
+      MapIdToNode& mNodes = (indexNode.nType == NT_ANCHOR) ? mAnchorNodes : mReadNodes;
+      auto it = mNodes.find(strName);
+      if (it == mNodes.end() || it->second->isReverseComplement != (bool)indexNode.isReverseComplement
+          || it->second->seq_ptr->length() != indexNode.seqLength) {
+        throw std::runtime_error(std::string("SCARA GRAPHINDEX: ERROR - graph index does not match input sequences: ")
+                                 + strIndex + " (node " + strName + ")");
+      }
+      vNodes[i] = it->second;
+    }
+
+    for (uint64_t i = 0; i < header.numNodes; i++) {
+      const GraphIndexNode& indexNode = indexNodes[i];
+      Node* node = vNodes[i].get();
+      node->vOutEdges.reserve(node->vOutEdges.size() + indexNode.numEdges);
+      for (uint64_t e = indexNode.firstEdge; e < indexNode.firstEdge + indexNode.numEdges; e++) {
+        const GraphIndexEdge& indexEdge = indexEdges[e];
+        if (indexEdge.startNode != i || indexEdge.endNode >= header.numNodes) corrupted();
+        auto edge_ptr = make_shared<Edge>();
+        edge_ptr->startNode = vNodes[i];
+        edge_ptr->endNode = vNodes[indexEdge.endNode];
+        edge_ptr->SLen = indexEdge.SLen;
+        edge_ptr->SStart = indexEdge.SStart;
+        edge_ptr->SEnd = indexEdge.SEnd;
+        edge_ptr->ELen = indexEdge.ELen;
+        edge_ptr->EStart = indexEdge.EStart;
+        edge_ptr->EEnd = indexEdge.EEnd;
+        edge_ptr->ovl_bOrientation = indexEdge.orientation != 0;
+        edge_ptr->paf_matching_bases = indexEdge.paf_matching_bases;
+        edge_ptr->paf_overlap_length = indexEdge.paf_overlap_length;
+        edge_ptr->paf_mapping_quality = indexEdge.paf_mapping_quality;
+        edge_ptr->QOH1 = indexEdge.QOH1;
+        edge_ptr->QOH2 = indexEdge.QOH2;
+        edge_ptr->TOH1 = indexEdge.TOH1;
+        edge_ptr->TOH2 = indexEdge.TOH2;
+        edge_ptr->QOL = indexEdge.QOL;
+        edge_ptr->TOL = indexEdge.TOL;
+        edge_ptr->SI = indexEdge.SI;
+        edge_ptr->OS = indexEdge.OS;
+        edge_ptr->QES1 = indexEdge.QES1;
+        edge_ptr->QES2 = indexEdge.QES2;
+        edge_ptr->TES1 = indexEdge.TES1;
+        edge_ptr->TES2 = indexEdge.TES2;
+        node->vOutEdges.emplace_back(std::move(edge_ptr));
+      }
+    }
+
+    numEdges_usable = header.numEdges_usable;
+    numEdges_contained = header.numEdges_contained;
+    numEdges_short = header.numEdges_short;
+    numEdges_lowqual = header.numEdges_lowqual;
+    numEdges_zero = header.numEdges_zero;
+
+    if (config.debugLevel >= DL_INFO) {
+      cerr << "SCARA GRAPHINDEX: Loaded graph with " << header.numNodes << " nodes and " << header.numEdges
+           << " edges from " << strIndex << endl;
+    }
+  }
+
+}
@@ -0,0 +1,153 @@
+#include "SBridger.h"
+
+#include <iostream>
+#include <algorithm>
+#include <unordered_map>
+#include <future>
+#include "thread_pool/thread_pool.hpp"
+
+namespace scara {
+
+  using namespace std;
+
+  // A connected component of the graph, anchor nodes are used for path generation, all nodes for freeing edges
+  struct GraphComponent {
+    MapIdToNode mAnchorNodes;
+    std::vector<shared_ptr<Node>> vNodes;
+    uint32_t numEdges = 0;
+  };
+
+  // Union-find with path halving
+  static uint32_t findRoot(std::vector<uint32_t>& vParent, uint32_t x) {
+    while (vParent[x] != x) {
+      vParent[x] = vParent[vParent[x]];
+      x = vParent[x];
+    }
+    return x;
+  }
+
+  SBridger::SBridger(const ScaraConfig& t_config, MapIdToNode&& t_mAnchorNodes)
+    : config(t_config), numANodes(t_mAnchorNodes.size()), numRNodes(0), numEdges_all(0), numEdges_usable(0)
+    , numEdges_contained(0), numEdges_short(0), numEdges_lowqual(0), numEdges_zero(0)
+    , pathAggregator(t_config.StreamPaths, t_config.PathGroupHalfSize), bGraphCreated(1)
+    , mAnchorNodes(std::move(t_mAnchorNodes)) {
+  }
+
+  /* KK:
+   * Anchors in different connected components never appear in the same path, group or scaffold, so each component
+   * is processed on its own. Components are found with union-find over sequences, both nodes of a sequence (FW and RC)
+   * are always in the same component, so that both copies of a scaffold are found and deduplicated together.
+   * Components without anchor nodes (only reads) or without edges (e.g. an isolated contig) can not produce a path
+   * and are skipped, so that they do not run path generation, including Monte Carlo iterations, on their own.
+   * A component with a single contig and edges is kept, a path can lead from the contig to its own reverse complement.
+   * Components are processed in parallel (largest first) with multithreading. When a component is finished,
+   * its paths are freed together with the component bridger and outgoing edges of its nodes are released,
+   * only edges on the chosen scaffold paths are kept. Nodes and sequences of the whole graph stay in memory
+   * until all components are finished, so the peak memory is lowered only by the paths of one component
+   * being alive at a time (per thread) and by edges released early.
+   * Minimum number of Monte Carlo paths (MinMCPaths) and the maximum number of Monte Carlo iterations
+   * (MaxMCIterations) apply to each component.
+   */
+  int SBridger::processComponents(void) {
+    // 1. Union-find over sequences, connected by edges
+    std::unordered_map<const Sequence*, uint32_t> mSeqIdx;
+    std::vector<shared_ptr<Node>> vNodes;
+    std::vector<uint32_t> vNodeSeq;
+    for (auto const* mNodes : {&mAnchorNodes, &mReadNodes}) {
+      for (auto const& it : *mNodes) {
+        auto res = mSeqIdx.emplace(it.second->seq_ptr.get(), (uint32_t)mSeqIdx.size());
+        vNodes.emplace_back(it.second);
+        vNodeSeq.emplace_back(res.first->second);
+      }
+    }
+    std::vector<uint32_t> vParent(mSeqIdx.size());
+    for (uint32_t i = 0; i < vParent.size(); i++) vParent[i] = i;
+    for (auto const& node_ptr : vNodes) {
+      for (auto const& edge_ptr : node_ptr->vOutEdges) {
+        uint32_t root1 = findRoot(vParent, mSeqIdx.at(edge_ptr->startNode->seq_ptr.get()));
+        uint32_t root2 = findRoot(vParent, mSeqIdx.at(edge_ptr->endNode->seq_ptr.get()));
+        if (root1 != root2) vParent[std::max(root1, root2)] = std::min(root1, root2);
+      }
+    }
+
+    // 2. Collect nodes of each component, in order of the first anchor node
+    std::unordered_map<uint32_t, uint32_t> mRootToComponent;
+    std::vector<GraphComponent> vComponents;
+    uint32_t numAnchorNodes = mAnchorNodes.size();
+    for (uint32_t i = 0; i < vNodes.size(); i++) {
+      uint32_t root = findRoot(vParent, vNodeSeq[i]);
+      auto res = mRootToComponent.emplace(root, (uint32_t)vComponents.size());
+      if (res.second) vComponents.emplace_back();
+      GraphComponent& component = vComponents[res.first->second];
+      if (i < numAnchorNodes) component.mAnchorNodes.emplace(vNodes[i]->nName, vNodes[i]);
+      component.vNodes.emplace_back(vNodes[i]);
+      component.numEdges += vNodes[i]->vOutEdges.size();
+    }
+    vNodes.clear();
+    uint32_t numComponents = vComponents.size();
+    uint32_t maxComponentNodes = 0;
+    for (auto const& component : vComponents) maxComponentNodes = std::max(maxComponentNodes, (uint32_t)component.vNodes.size());
+
+    // Paths start and end in anchor nodes and follow edges
+    vComponents.erase(std::remove_if(vComponents.begin(), vComponents.end(), [](const GraphComponent& component) {
+      return component.mAnchorNodes.empty() || component.numEdges == 0;
+    }), vComponents.end());
+
+    if (config.debugLevel >= DL_INFO) {
+      cerr << "\nSCARA PARTITION: Found " << numComponents << " connected components, " << vComponents.size()
+           << " with contigs and edges, largest component has " << maxComponentNodes << " nodes" << endl;
+    }
+
+    // 3. Process components independently, scaffolds are collected in component order
+    ScaraConfig componentConfig = config;
+    componentConfig.print_output = false;
+    if (componentConfig.debugLevel < DL_VERBOSE) componentConfig.debugLevel = DL_NONE;
+    std::vector<std::vector<shared_ptr<std::vector<shared_ptr<PathInfo>>>>> vComponentScaffolds(vComponents.size());
+    std::vector<uint32_t> vComponentPaths(vComponents.size(), 0);
+
+    auto processComponent = [&](uint32_t idx) {
+      GraphComponent& component = vComponents[idx];
+      {
+        SBridger componentBridger(componentConfig, std::move(component.mAnchorNodes));
+        vComponentPaths[idx] = componentBridger.generatePaths();
+        componentBridger.groupAndProcessPaths();
+        vComponentScaffolds[idx] = std::move(componentBridger.scaffolds);
+      }
+      for (auto const& node_ptr : component.vNodes) {
+        std::vector<shared_ptr<Edge>>().swap(node_ptr->vOutEdges);
+      }
+      component.vNodes.clear();
+    };
+
+    std::vector<uint32_t> vOrder(vComponents.size());
+    for (uint32_t i = 0; i < vOrder.size(); i++) vOrder[i] = i;
+    std::stable_sort(vOrder.begin(), vOrder.end(), [&vComponents](uint32_t lhs, uint32_t rhs) {
+      return vComponents[lhs].vNodes.size() > vComponents[rhs].vNodes.size();
+    });
+
+    const uint32_t numThreads = std::min(config.numThreads(), (uint32_t)vComponents.size());
+    if (numThreads > 1) {
+      std::unique_ptr<thread_pool::ThreadPool> threadPool = thread_pool::createThreadPool(numThreads);
+      std::vector<std::future<void>> vFutures;
+      for (auto const& idx : vOrder) vFutures.emplace_back(threadPool->submit(processComponent, idx));
+      // Wait for all components, even if one of them failed, then report the first error
+      for (auto& f : vFutures) f.wait();
+      for (auto& f : vFutures) f.get();
+    } else {
+      for (auto const& idx : vOrder) processComponent(idx);
+    }
+
+    uint32_t numPaths = 0;
+    for (uint32_t i = 0; i < vComponents.size(); i++) {
+      numPaths += vComponentPaths[i];
+      for (auto& scaff_ptr : vComponentScaffolds[i]) scaffolds.emplace_back(std::move(scaff_ptr));
+    }
+
+    if (config.debugLevel >= DL_INFO) {
+      cerr << "SCARA PARTITION: Generated " << numPaths << " paths and " << scaffolds.size() << " scaffolds in "
+           << vComponents.size() << " components" << endl;
+    }
+    return scaffolds.size();
+  }
+
+}
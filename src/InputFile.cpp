@@ -0,0 +1,70 @@
+#include "InputFile.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace scara {
+
+  InputFile::InputFile(const std::string& strFile)
+    : if_strFile(strFile), if_fd(-1)
+  {
+    if_fd = open(strFile.c_str(), O_RDONLY);
+    if (if_fd < 0) {
+      throw std::runtime_error(std::string("SCARA INPUTFILE: ERROR - unable to open file: ") + strFile);
+    }
+  }
+
+  InputFile::~InputFile() {
+    if (if_fd >= 0) close(if_fd);
+  }
+
+  size_t InputFile::readSome(uint64_t offset, size_t size, char* dst) const {
+    size_t done = 0;
+    while (done < size) {
+      ssize_t numRead = pread(if_fd, dst + done, size - done, offset + done);
+      if (numRead < 0) {
+        if (errno == EINTR) continue;
+        throw std::runtime_error(std::string("SCARA INPUTFILE: ERROR - reading failed: ") + if_strFile + " (" + strerror(errno) + ")");
+      }
+      if (numRead == 0) break;
+      done += numRead;
+    }
+    return done;
+  }
+
+  void InputFile::readAt(uint64_t offset, size_t size, char* dst) const {
+    if (readSome(offset, size, dst) != size) {
+      throw std::runtime_error(std::string("SCARA INPUTFILE: ERROR - unexpected end of file: ") + if_strFile);
+    }
+  }
+
+  uint64_t InputFile::size(void) const {
+    struct stat st;
+    if (fstat(if_fd, &st) != 0) {
+      throw std::runtime_error(std::string("SCARA INPUTFILE: ERROR - unable to stat file: ") + if_strFile);
+    }
+    return st.st_size;
+  }
+
+  int64_t InputFile::modificationTime(void) const {
+    struct stat st;
+    if (fstat(if_fd, &st) != 0) {
+      throw std::runtime_error(std::string("SCARA INPUTFILE: ERROR - unable to stat file: ") + if_strFile);
+    }
+    return (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+  }
+
+  uint64_t InputFile::inode(void) const {
+    struct stat st;
+    if (fstat(if_fd, &st) != 0) {
+      throw std::runtime_error(std::string("SCARA INPUTFILE: ERROR - unable to stat file: ") + if_strFile);
+    }
+    return st.st_ino;
+  }
+
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace scara {
+
+  /* KK:
+   * Input file opened for random access reads
+   * Reads at given offsets do not change any state, so they can be done from multiple threads
+   */
+  class InputFile {
+  private:
+    std::string if_strFile;
+    int if_fd;
+
+  public:
+    explicit InputFile(const std::string& strFile);
+    ~InputFile();
+
+    InputFile(const InputFile&) = delete;
+    InputFile& operator=(const InputFile&) = delete;
+
+    // Reads size bytes starting at offset into dst, throws if the file is shorter
+    void readAt(uint64_t offset, size_t size, char* dst) const;
+    // Reads up to size bytes starting at offset into dst, returns the number of bytes read
+    size_t readSome(uint64_t offset, size_t size, char* dst) const;
+
+    uint64_t size(void) const;
+    // Modification time in nanoseconds, a file rewritten within the same second has a different time
+    int64_t modificationTime(void) const;
+    // A file replaced by another one (e.g. renamed over it) has a different inode
+    uint64_t inode(void) const;
+    const std::string& fileName(void) const { return if_strFile; }
+  };
+
+}
@@ -2,35 +2,132 @@
 #include "bioparser/bioparser.hpp"
 #include "Sequence.h"
 #include "Overlap.h"
+#include "MappedFile.h"
+#include "InputFile.h"
+#include "PafTokenizer.h"
+#include "OverlapCache.h"
 
 #include <iostream>
+#include <cstring>
+#include <cctype>
+#include <stdexcept>
+#include <fstream>
 
 #include <unordered_set>
+#include <future>
+#include <algorithm>
+#include "thread_pool/thread_pool.hpp"
 
 namespace scara {
   using namespace std;
 
-  void parseProcessFastq(const string& strFastq, MapIdToSeq& mIdToSeq) {
+  // Reads of a chunk are processed before the next chunk is parsed
+  const uint64_t FastqChunkSize = (uint64_t)1 << 26;
+
+  /* KK:
+   * Reads are parsed in chunks, qualities of each chunk are released (and reads packed) before the next chunk
+   * is parsed, so only one chunk of reads is held with qualities (or unpacked) at a time
+   */
+  void parseProcessFastq(const string& strFastq, MapIdToSeq& mIdToSeq, const ScaraConfig& config) {
     vector<unique_ptr<Sequence>> aReads;
     auto fastqParser = bioparser::createParser<bioparser::FastqParser, scara::Sequence>(strFastq);
-    fastqParser->parse_objects(aReads, -1);
-    for (uint32_t i = 0; i < aReads.size(); i++) {
-      // Loosing quals, to save space
-      // KK: Since I'm a newb and don know how exactly this works, I'm extending length by 1, for \0 in case its needed
-      unique_ptr<Sequence> newSeq_ptr = make_unique<Sequence>(aReads[i]->seq_strName.c_str(), (uint32_t)(aReads[i]->seq_strName.length()),
-                                                              aReads[i]->seq_strData.c_str(), (uint32_t)(aReads[i]->seq_strData.length()));
-
-      mIdToSeq.emplace(newSeq_ptr->seq_strName, std::move(newSeq_ptr));
+    bool moreReads = true;
+    while (moreReads) {
+      moreReads = fastqParser->parse_objects(aReads, FastqChunkSize);
+      for (uint32_t i = 0; i < aReads.size(); i++) {
+        // Loosing quals, to save space
+        std::string().swap(aReads[i]->seq_strQuality);
+        // Reads are only needed for bridging fragments in the output, so they can be kept packed
+        if (config.PackReads) {
+          aReads[i]->pack();
+        } else {
+          aReads[i]->seq_strData.shrink_to_fit();
+        }
+        mIdToSeq.emplace(aReads[i]->seq_strName, std::move(aReads[i]));
+      }
+      aReads.clear();
     }
   }
 
-  void parseProcessFasta(const string& strFasta, MapIdToSeq& mIdToSeq) {
+  void parseProcessFasta(const string& strFasta, MapIdToSeq& mIdToSeq, const ScaraConfig& config) {
     vector<unique_ptr<Sequence>> aReads;
     auto fastaParser = bioparser::createParser<bioparser::FastaParser, scara::Sequence>(strFasta);
     fastaParser->parse_objects(aReads, -1);
     for (uint32_t i = 0; i < aReads.size(); i++) {
       mIdToSeq.emplace(aReads[i]->seq_strName, std::move(aReads[i]));
     }
+    mapFastaSequences(strFasta, mIdToSeq, config);
+  }
+
+  /* KK:
+   * Maps the FASTA file into memory and records where each sequence is located in it,
+   * so that forward sequence spans can be written to the output without copying
+   * A sequence is mapped only if its lines have a consistent width and contain exactly the parsed bases,
+   * which is checked by comparing each line with the parsed sequence
+   */
+  void mapFastaSequences(const string& strFasta, MapIdToSeq& mIdToSeq, const ScaraConfig& config) {
+    shared_ptr<MappedFile> mappedFile;
+    try {
+      mappedFile = make_shared<MappedFile>(strFasta);
+    } catch (const std::runtime_error& e) {
+      cerr << "SCARA LOADER: Unable to map " << strFasta << ", zero-copy output disabled!" << endl;
+      return;
+    }
+
+    const char* data = mappedFile->data();
+    const char* end = data + mappedFile->size();
+    const char* pos = data;
+    uint32_t numMapped = 0;
+    while (pos < end) {
+      const char* lineEnd = (const char*)memchr(pos, '\n', end - pos);
+      if (lineEnd == NULL) lineEnd = end;
+      if (*pos != '>') {
+        pos = lineEnd + 1;
+        continue;
+      }
+
+      // Sequence name is the first word of the header, as in the parser
+      const char* nameEnd = pos + 1;
+      while (nameEnd < lineEnd && !isspace(*nameEnd)) nameEnd++;
+      auto it = mIdToSeq.find(string(pos + 1, nameEnd - pos - 1));
+      const char* seqData = (it != mIdToSeq.end()) ? it->second->data() : NULL;
+      uint64_t seqLength = (seqData != NULL) ? it->second->length() : 0;
+
+      // Scan sequence lines
+      const char* seqStart = lineEnd + 1;
+      uint64_t numBases = 0;
+      uint32_t lineWidth = 0, lastLineLength = 0, numLines = 0;
+      bool consistent = (seqData != NULL);
+      pos = seqStart;
+      while (pos < end && *pos != '>') {
+        lineEnd = (const char*)memchr(pos, '\n', end - pos);
+        if (lineEnd == NULL) lineEnd = end;
+        uint32_t lineLength = lineEnd - pos;
+        // Only the last line can be shorter, empty lines and CR line endings are not supported
+        if (lineLength == 0 || pos[lineLength - 1] == '\r' || (numLines > 0 && lastLineLength != lineWidth)) consistent = false;
+        if (numLines == 0) lineWidth = lineLength;
+        if (lineLength > lineWidth) consistent = false;
+        // Bases in the file must be the same as the parsed ones (e.g. the parser could change the case)
+        if (consistent && (numBases + lineLength > seqLength || memcmp(pos, seqData + numBases, lineLength) != 0)) consistent = false;
+        lastLineLength = lineLength;
+        numBases += lineLength;
+        numLines++;
+        pos = lineEnd + 1;
+      }
+
+      if (consistent && numLines > 0 && numBases == seqLength) {
+        Sequence &seq = *(it->second);
+        seq.seq_mapFile = mappedFile;
+        seq.seq_mapData = seqStart;
+        seq.seq_lineWidth = (numLines > 1) ? lineWidth : 0;
+        seq.seq_lineStride = lineWidth + 1;
+        numMapped++;
+      }
+    }
+
+    if (config.debugLevel >= DL_INFO) {
+      cerr << "SCARA LOADER: Mapped " << numMapped << "/" << mIdToSeq.size() << " sequences from " << strFasta << endl;
+    }
   }
 
   void parseProcessPaf(const string& strPaf, MapIdToOvl& mIdToOvl) {
@@ -53,13 +150,396 @@ namespace scara {
     }
   }
 
-  extern void parseProcessPaf(const std::string& strPaf, VecOvl& vOvl) {
-    vector<unique_ptr<scara::Overlap>> aExtensions;
-    auto pafParser = bioparser::createParser<bioparser::PafParser, Overlap>(strPaf);
-    pafParser->parse_objects(aExtensions, -1);
+  // Minimum size of a chunk of PAF file parsed by a single thread
+  static const size_t MinPafChunkSize = (size_t)1 << 20;
 
-    for (uint32_t i = 0; i < aExtensions.size(); i++) {
-      vOvl.emplace_back(std::move(aExtensions[i]));
+  // Parses PAF lines in [begin, end) with the vectorized tokenizer, only the 12 mandatory fields are used
+  static void parsePafRange(const char* begin, const char* end, VecOvl& vOvl, const string& strPaf) {
+    PafRecord record;
+    bool valid;
+    while (begin < end) {
+      const char* next = parsePafLine(begin, end, record, valid);
+      if (!valid) {
+        const char* lineEnd = (const char*)memchr(begin, '\n', end - begin);
+        if (lineEnd == NULL) lineEnd = end;
+        throw std::runtime_error(std::string("SCARA LOADER: ERROR - invalid PAF line in ") + strPaf + ": " + string(begin, lineEnd - begin));
+      }
+      if (record.qName != NULL) {
+        vOvl.emplace_back(new Overlap(record.qName, record.qNameLength, record.qLength, record.qBegin, record.qEnd, record.orientation,
+                                      record.tName, record.tNameLength, record.tLength, record.tBegin, record.tEnd,
+                                      record.matchingBases, record.overlapLength, record.mappingQuality));
+      }
+      begin = next;
+    }
+  }
+
+  /* KK:
+   * PAF file is mapped and split into chunks aligned to line boundaries, which are parsed by separate threads
+   * Overlaps from each chunk are moved into the result in chunk order, keeping the order of the file
+   * A single chunk is parsed in the calling thread
+   */
+  static void parsePafParallel(const string& strPaf, VecOvl& vOvl, uint32_t numThreads) {
+    MappedFile file(strPaf);
+    const char* data = file.data();
+    size_t size = file.size();
+    size_t numChunks = std::max((size_t)1, std::min((size_t)numThreads, size / MinPafChunkSize));
+
+    std::vector<size_t> vBoundaries(numChunks + 1, size);
+    vBoundaries[0] = 0;
+    for (size_t i = 1; i < numChunks; i++) {
+      size_t pos = std::max(vBoundaries[i - 1], i * (size / numChunks));
+      const char* nl = (pos < size) ? (const char*)memchr(data + pos, '\n', size - pos) : NULL;
+      vBoundaries[i] = (nl != NULL) ? nl - data + 1 : size;
+    }
+
+    if (numChunks == 1) {
+      parsePafRange(data, data + size, vOvl, strPaf);
+      return;
+    }
+
+    std::vector<VecOvl> vChunkOvl(numChunks);
+    std::unique_ptr<thread_pool::ThreadPool> threadPool = thread_pool::createThreadPool(numChunks);
+    std::vector<std::future<void>> vFutures;
+    for (size_t i = 0; i < numChunks; i++) {
+      vFutures.emplace_back(threadPool->submit([&, i]() {
+        parsePafRange(data + vBoundaries[i], data + vBoundaries[i + 1], vChunkOvl[i], strPaf);
+      }));
+    }
+    size_t numOverlaps = vOvl.size();
+    for (size_t i = 0; i < numChunks; i++) {
+      vFutures[i].get();
+      numOverlaps += vChunkOvl[i].size();
+    }
+
+    vOvl.reserve(numOverlaps);
+    for (auto& vChunk : vChunkOvl) {
+      std::move(vChunk.begin(), vChunk.end(), std::back_inserter(vOvl));
+    }
+  }
+
+  // A valid overlap cache is loaded instead of parsing the PAF file
+  extern void parseProcessPaf(const std::string& strPaf, VecOvl& vOvl, const ScaraConfig& config) {
+    uint32_t numThreads = config.numThreads();
+    std::string strCache = findOverlapCache(strPaf);
+    if (!strCache.empty()) {
+      loadOverlapCache(strCache, vOvl, numThreads, config.debugLevel);
+      return;
+    }
+    parsePafParallel(strPaf, vOvl, numThreads);
+  }
+
+  // Reads the PAF file sequentially, emitting overlaps in batches of batchSize in file order
+  // Reading stops early if emitBatch returns false
+  void readPafBatches(const std::string& strPaf, uint32_t batchSize, const std::function<bool(VecOvl&&)>& emitBatch) {
+    std::string strCache = findOverlapCache(strPaf);
+    if (!strCache.empty()) {
+      readOverlapCacheBatches(strCache, batchSize, emitBatch);
+      return;
+    }
+    MappedFile file(strPaf);
+    const char* pos = file.data();
+    const char* end = pos + file.size();
+    VecOvl vBatch;
+    vBatch.reserve(batchSize);
+    while (pos < end) {
+      // Parse roughly one batch worth of lines at once
+      const char* chunkEnd = pos;
+      for (uint32_t i = 0; i < batchSize && chunkEnd < end; i++) {
+        const char* nl = (const char*)memchr(chunkEnd, '\n', end - chunkEnd);
+        chunkEnd = (nl != NULL) ? nl + 1 : end;
+      }
+      parsePafRange(pos, chunkEnd, vBatch, strPaf);
+      pos = chunkEnd;
+      if (vBatch.size() >= batchSize || pos >= end) {
+        if (!emitBatch(std::move(vBatch))) return;
+        vBatch = VecOvl();
+        vBatch.reserve(batchSize);
+      }
+    }
+  }
+
+  // Location of a single sequence in a FASTA/FASTQ file
+  struct SequenceRecord {
+    std::string name;
+    uint64_t offset;          // Offset of the first base
+    uint64_t endOffset;       // Offset after the last sequence line
+    uint32_t length;
+    uint32_t lineWidth;       // 0 if the sequence is in a single line
+    uint32_t lineStride;
+    bool consistent;          // All lines except the last have the same width and stride
+  };
+
+  static const char readIndexMagic[8] = {'S', 'C', 'R', 'I', 'D', 'X', '2', '\0'};
+
+  /* KK:
+   * Reads the file sequentially in large blocks and returns it line by line, together with line offsets
+   * Lines are returned without the line break, trailing CR is removed
+   */
+  class LineReader {
+  private:
+    const InputFile& lr_file;
+    std::vector<char> lr_buffer;
+    size_t lr_begin, lr_end;
+    uint64_t lr_bufferOffset;
+    bool lr_eof;
+
+  public:
+    LineReader(const InputFile& file, size_t bufferSize = (size_t)1 << 24)
+      : lr_file(file), lr_buffer(bufferSize), lr_begin(0), lr_end(0), lr_bufferOffset(0), lr_eof(false) {}
+
+    // Returns false at the end of the file
+    bool nextLine(const char*& line, uint32_t& length, uint64_t& offset) {
+      for (;;) {
+        const char* nl = (const char*)memchr(lr_buffer.data() + lr_begin, '\n', lr_end - lr_begin);
+        if (nl != NULL || (lr_eof && lr_end > lr_begin)) {
+          line = lr_buffer.data() + lr_begin;
+          length = (nl != NULL) ? nl - line : lr_end - lr_begin;
+          offset = lr_bufferOffset + lr_begin;
+          lr_begin += length + 1;
+          if (lr_begin > lr_end) lr_begin = lr_end;
+          if (length > 0 && line[length - 1] == '\r') length--;
+          return true;
+        }
+        if (lr_eof) return false;
+
+        // Move the incomplete line to the start of the buffer and read more
+        size_t remaining = lr_end - lr_begin;
+        if (remaining == lr_buffer.size()) lr_buffer.resize(2 * lr_buffer.size());
+        memmove(lr_buffer.data(), lr_buffer.data() + lr_begin, remaining);
+        lr_bufferOffset += lr_begin;
+        lr_begin = 0;
+        lr_end = remaining;
+        size_t numRead = lr_file.readSome(lr_bufferOffset + lr_end, lr_buffer.size() - lr_end, lr_buffer.data() + lr_end);
+        lr_end += numRead;
+        if (numRead == 0) lr_eof = true;
+      }
+    }
+  };
+
+  // Same interface as LineReader, lines point into the mapped file
+  class MappedLineReader {
+  private:
+    const char* mlr_data;
+    size_t mlr_size;
+    size_t mlr_pos;
+
+  public:
+    MappedLineReader(const MappedFile& file)
+      : mlr_data(file.data()), mlr_size(file.size()), mlr_pos(0) {}
+
+    bool nextLine(const char*& line, uint32_t& length, uint64_t& offset) {
+      if (mlr_pos >= mlr_size) return false;
+      line = mlr_data + mlr_pos;
+      const char* nl = (const char*)memchr(line, '\n', mlr_size - mlr_pos);
+      length = (nl != NULL) ? nl - line : mlr_size - mlr_pos;
+      offset = mlr_pos;
+      mlr_pos += length + 1;
+      if (length > 0 && line[length - 1] == '\r') length--;
+      return true;
+    }
+  };
+
+  /* KK:
+   * Single pass over a FASTQ or FASTA file, calling processRecord for each sequence
+   * Sequence name is the first word of the header, quality lines are skipped
+   */
+  template<class TLineReader, class TProcess>
+  static void scanSequenceRecords(TLineReader& reader, const std::string& strFile, TProcess processRecord) {
+    const char* line;
+    uint32_t length;
+    uint64_t offset;
+    bool hasLine = reader.nextLine(line, length, offset);
+    while (hasLine) {
+      if (length == 0) {
+        hasLine = reader.nextLine(line, length, offset);
+        continue;
+      }
+      if (line[0] != '@' && line[0] != '>') {
+        throw std::runtime_error(std::string("SCARA LOADER: ERROR - unexpected record start in file: ") + strFile);
+      }
+      bool isFastq = (line[0] == '@');
+      SequenceRecord record;
+      uint32_t nameLength = 1;
+      while (nameLength < length && !isspace(line[nameLength])) nameLength++;
+      record.name.assign(line + 1, nameLength - 1);
+      record.length = record.lineWidth = record.lineStride = 0;
+      record.offset = record.endOffset = offset + length;
+      record.consistent = true;
+
+      // Sequence lines up to the '+' line (FASTQ) or the next header (FASTA)
+      uint32_t numLines = 0, lastLineLength = 0;
+      uint64_t lastLineOffset = 0;
+      while ((hasLine = reader.nextLine(line, length, offset))) {
+        if (length > 0 && (line[0] == (isFastq ? '+' : '>'))) break;
+        if (length == 0) continue;
+        if (numLines == 0) {
+          record.offset = offset;
+          record.lineWidth = length;
+        } else {
+          if (lastLineLength != record.lineWidth || length > record.lineWidth) record.consistent = false;
+          if (numLines == 1) record.lineStride = offset - record.offset;
+          else if (offset - lastLineOffset != record.lineStride) record.consistent = false;
+        }
+        lastLineLength = length;
+        lastLineOffset = offset;
+        record.endOffset = offset + length;
+        record.length += length;
+        numLines++;
+      }
+      if (numLines <= 1) {
+        record.lineWidth = 0;
+        record.lineStride = 0;
+      }
+
+      if (isFastq) {
+        // Skip quality lines, as many bases as in the sequence
+        uint32_t numQuals = 0;
+        while (numQuals < record.length && (hasLine = reader.nextLine(line, length, offset))) {
+          numQuals += length;
+        }
+        hasLine = reader.nextLine(line, length, offset);
+      }
+      processRecord(std::move(record));
+    }
+  }
+
+  // Builds read index with a single pass over a FASTQ or FASTA file
+  static void buildReadIndex(const InputFile& file, std::vector<SequenceRecord>& vEntries) {
+    LineReader reader(file);
+    scanSequenceRecords(reader, file.fileName(), [&](SequenceRecord&& record) {
+      if (!record.consistent) {
+        throw std::runtime_error(std::string("SCARA LOADER: ERROR - inconsistent line wrapping of read ") + record.name + " in " + file.fileName());
+      }
+      vEntries.emplace_back(std::move(record));
+    });
+  }
+
+  // Sidecar index is valid if it was built for the same file (inode) with the same size and modification time (in nanoseconds)
+  static bool loadReadIndex(const std::string& strIndex, const InputFile& file, std::vector<SequenceRecord>& vEntries) {
+    ifstream in(strIndex, ios::binary);
+    if (!in) return false;
+    char magic[8];
+    uint64_t fileSize, fileInode, numEntries;
+    int64_t fileTime;
+    in.read(magic, sizeof(magic));
+    in.read((char*)&fileSize, sizeof(fileSize));
+    in.read((char*)&fileTime, sizeof(fileTime));
+    in.read((char*)&fileInode, sizeof(fileInode));
+    in.read((char*)&numEntries, sizeof(numEntries));
+    if (!in || memcmp(magic, readIndexMagic, sizeof(magic)) != 0) return false;
+    if (fileSize != file.size() || fileTime != file.modificationTime() || fileInode != file.inode()) return false;
+
+    vEntries.resize(numEntries);
+    for (auto& entry : vEntries) {
+      uint32_t nameLength;
+      in.read((char*)&nameLength, sizeof(nameLength));
+      entry.name.resize(nameLength);
+      in.read(&entry.name[0], nameLength);
+      in.read((char*)&entry.offset, sizeof(entry.offset));
+      in.read((char*)&entry.length, sizeof(entry.length));
+      in.read((char*)&entry.lineWidth, sizeof(entry.lineWidth));
+      in.read((char*)&entry.lineStride, sizeof(entry.lineStride));
+    }
+    if (!in) {
+      vEntries.clear();
+      return false;
+    }
+    return true;
+  }
+
+  static void saveReadIndex(const std::string& strIndex, const InputFile& file, const std::vector<SequenceRecord>& vEntries) {
+    ofstream out(strIndex, ios::binary | ios::trunc);
+    uint64_t fileSize = file.size();
+    int64_t fileTime = file.modificationTime();
+    uint64_t fileInode = file.inode();
+    uint64_t numEntries = vEntries.size();
+    out.write(readIndexMagic, sizeof(readIndexMagic));
+    out.write((const char*)&fileSize, sizeof(fileSize));
+    out.write((const char*)&fileTime, sizeof(fileTime));
+    out.write((const char*)&fileInode, sizeof(fileInode));
+    out.write((const char*)&numEntries, sizeof(numEntries));
+    for (auto const& entry : vEntries) {
+      uint32_t nameLength = entry.name.length();
+      out.write((const char*)&nameLength, sizeof(nameLength));
+      out.write(entry.name.data(), nameLength);
+      out.write((const char*)&entry.offset, sizeof(entry.offset));
+      out.write((const char*)&entry.length, sizeof(entry.length));
+      out.write((const char*)&entry.lineWidth, sizeof(entry.lineWidth));
+      out.write((const char*)&entry.lineStride, sizeof(entry.lineStride));
+    }
+    if (!out) {
+      cerr << "SCARA LOADER: Unable to write read index " << strIndex << endl;
+    }
+  }
+
+  /* KK:
+   * Index-only loading of reads (FASTQ or FASTA), only read names, lengths and offsets are kept in memory
+   * Read bases are read from the file when they are needed for the output
+   * The index is stored next to the reads file (<reads>.scidx) and reused if the reads file did not change
+   */
+  void indexProcessReads(const string& strReads, MapIdToSeq& mIdToSeq, const ScaraConfig& config) {
+    auto file = make_shared<InputFile>(strReads);
+    std::string strIndex = strReads + ".scidx";
+    std::vector<SequenceRecord> vEntries;
+    if (loadReadIndex(strIndex, *file, vEntries)) {
+      if (config.debugLevel >= DL_INFO) cerr << "SCARA LOADER: Using read index " << strIndex << endl;
+    } else {
+      buildReadIndex(*file, vEntries);
+      saveReadIndex(strIndex, *file, vEntries);
+    }
+
+    for (auto const& entry : vEntries) {
+      mIdToSeq.emplace(entry.name, make_shared<Sequence>(entry.name, file, entry.offset, entry.length, entry.lineWidth, entry.lineStride));
+    }
+    if (config.debugLevel >= DL_INFO) {
+      cerr << "SCARA LOADER: Indexed " << vEntries.size() << " reads from " << strReads << endl;
+    }
+  }
+
+  /* KK:
+   * Loads a FASTA or FASTQ file through a memory mapping, without the parser
+   * Sequences in a single line are kept as views into the mapping, wrapped sequences are copied
+   * without line breaks. Qualities are skipped and never stored.
+   */
+  void mapProcessSequences(const string& strFile, MapIdToSeq& mIdToSeq, const ScaraConfig& config) {
+    auto mappedFile = make_shared<MappedFile>(strFile);
+    MappedLineReader reader(*mappedFile);
+    uint32_t numViews = 0, numCopied = 0;
+    scanSequenceRecords(reader, strFile, [&](SequenceRecord&& record) {
+      const char* data = mappedFile->data();
+      shared_ptr<Sequence> seq_ptr;
+      if (record.lineWidth == 0) {
+        seq_ptr = make_shared<Sequence>(record.name, mappedFile, data + record.offset, record.length);
+        numViews++;
+      } else {
+        std::string strData;
+        strData.reserve(record.length);
+        const char* pos = data + record.offset;
+        const char* end = data + record.endOffset;
+        while (pos < end) {
+          const char* nl = (const char*)memchr(pos, '\n', end - pos);
+          if (nl == NULL) nl = end;
+          uint32_t lineLength = nl - pos;
+          if (lineLength > 0 && pos[lineLength - 1] == '\r') lineLength--;
+          strData.append(pos, lineLength);
+          pos = nl + 1;
+        }
+        seq_ptr = make_shared<Sequence>(record.name.c_str(), (uint32_t)record.name.length(), strData.data(), (uint32_t)strData.length());
+        // Consistently wrapped sequences can still be written from the mapping
+        if (record.consistent) {
+          seq_ptr->seq_mapFile = mappedFile;
+          seq_ptr->seq_mapData = data + record.offset;
+          seq_ptr->seq_lineWidth = record.lineWidth;
+          seq_ptr->seq_lineStride = record.lineStride;
+        }
+        numCopied++;
+      }
+      mIdToSeq.emplace(record.name, std::move(seq_ptr));
+    });
+
+    if (config.debugLevel >= DL_INFO) {
+      cerr << "SCARA LOADER: Loaded " << numViews + numCopied << " sequences from " << strFile;
+      cerr << " (" << numViews << " mapped, " << numCopied << " copied)" << endl;
     }
   }
 }
@@ -1,10 +1,21 @@
 #include "Types.h"
+#include "ScaraConfig.h"
+
+#include <functional>
 
 namespace scara {
 
-	extern void parseProcessFastq(const std::string& strFastq, MapIdToSeq& mIdToSeq);
-	extern void parseProcessFasta(const std::string& strFasta, MapIdToSeq& mIdToSeq);
+	// KK: Loading parameters (read packing, threads, debug level) are taken from the config
+	extern void parseProcessFastq(const std::string& strFastq, MapIdToSeq& mIdToSeq, const ScaraConfig& config = ScaraConfig());
+	extern void parseProcessFasta(const std::string& strFasta, MapIdToSeq& mIdToSeq, const ScaraConfig& config = ScaraConfig());
+	extern void mapFastaSequences(const std::string& strFasta, MapIdToSeq& mIdToSeq, const ScaraConfig& config = ScaraConfig());
+	extern void indexProcessReads(const std::string& strReads, MapIdToSeq& mIdToSeq, const ScaraConfig& config = ScaraConfig());
+	extern void mapProcessSequences(const std::string& strFile, MapIdToSeq& mIdToSeq, const ScaraConfig& config = ScaraConfig());
 	extern void parseProcessPaf(const std::string& strPaf, MapIdToOvl& mIdToOvl);
-	extern void parseProcessPaf(const std::string& strPaf, VecOvl& vOvl);
+	extern void parseProcessPaf(const std::string& strPaf, VecOvl& vOvl, const ScaraConfig& config = ScaraConfig());
+	extern void readPafBatches(const std::string& strPaf, uint32_t batchSize, const std::function<bool(VecOvl&&)>& emitBatch);
+
+	// Size of a chunk of FASTQ file parsed at once, only one chunk of reads is held with qualities
+	extern const uint64_t FastqChunkSize;
 
 }
@@ -0,0 +1,44 @@
+#include "MappedFile.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace scara {
+
+  MappedFile::MappedFile(const std::string& strFile)
+    : mf_strFile(strFile), mf_data(NULL), mf_size(0)
+  {
+    int fd = open(strFile.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error(std::string("SCARA MAPPEDFILE: ERROR - unable to open file: ") + strFile);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      close(fd);
+      throw std::runtime_error(std::string("SCARA MAPPEDFILE: ERROR - unable to stat file: ") + strFile);
+    }
+    mf_size = st.st_size;
+    // KK: mmap does not accept zero length, an empty file is left unmapped
+    if (mf_size > 0) {
+      void* ptr = mmap(NULL, mf_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (ptr == MAP_FAILED) {
+        close(fd);
+        throw std::runtime_error(std::string("SCARA MAPPEDFILE: ERROR - unable to map file: ") + strFile + " (" + strerror(errno) + ")");
+      }
+      mf_data = (const char*)ptr;
+    }
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+  }
+
+  MappedFile::~MappedFile() {
+    if (mf_data != NULL) munmap((void*)mf_data, mf_size);
+  }
+
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+namespace scara {
+
+  /* KK:
+   * Read-only memory mapping of an input file
+   * The mapping is kept for the lifetime of the object, pointers into it are valid until then
+   */
+  class MappedFile {
+  private:
+    std::string mf_strFile;
+    const char* mf_data;
+    size_t mf_size;
+
+  public:
+    explicit MappedFile(const std::string& strFile);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data(void) const { return mf_data; }
+    size_t size(void) const { return mf_size; }
+    const std::string& fileName(void) const { return mf_strFile; }
+  };
+
+}
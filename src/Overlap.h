@@ -2,8 +2,6 @@
 
 #include <string>
 
-#include "globals.h"
-
 namespace scara {
 
   enum SequenceStrand {
@@ -0,0 +1,294 @@
+#include "OverlapCache.h"
+#include "Overlap.h"
+#include "MappedFile.h"
+#include "PafTokenizer.h"
+
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <stdexcept>
+#include <unordered_map>
+#include <future>
+#include <algorithm>
+#include <sys/stat.h>
+#include "thread_pool/thread_pool.hpp"
+
+namespace scara {
+
+  using namespace std;
+
+  const char* const OverlapCacheSuffix = ".scovl";
+
+  static const char overlapCacheMagic[8] = {'S', 'C', 'O', 'V', 'L', '2', '\0', '\0'};
+
+  // All offsets are relative to the start of the file
+  struct OverlapCacheHeader {
+    char magic[8];
+    uint64_t sourceSize;
+    int64_t sourceTime;         // Modification time, seconds and nanoseconds
+    int64_t sourceTimeNsec;
+    uint64_t sourceInode;
+    uint64_t sourceChecksum;
+    uint64_t numOverlaps;       // Records follow the header
+    uint64_t numNames;
+    uint64_t namesOffset;       // numNames + 1 offsets of names in the name data, followed by the name data
+  };
+
+  struct OverlapCacheRecord {
+    uint32_t qId, qLength, qBegin, qEnd;
+    uint32_t tId, tLength, tBegin, tEnd;
+    uint32_t matchingBases, overlapLength, mappingQuality;
+    uint32_t orientation;       // '+' or '-'
+  };
+
+  // Minimum number of records converted into overlaps by a single thread
+  static const uint64_t MinCacheChunkSize = (uint64_t)1 << 16;
+
+  // FNV-1a, on 8 byte words
+  static uint64_t sourceChecksum(const char* data, size_t size) {
+    uint64_t hash = 14695981039346656037ULL;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+      uint64_t word;
+      memcpy(&word, data + i, sizeof(word));
+      hash = (hash ^ word) * 1099511628211ULL;
+    }
+    for (; i < size; i++) hash = (hash ^ (uint8_t)data[i]) * 1099511628211ULL;
+    return hash ^ size;
+  }
+
+  // Identity of a source file, a file that changed in place has a different size or modification time,
+  // a file replaced by another one (e.g. renamed over it) has a different inode
+  struct SourceFileStat {
+    uint64_t size;
+    int64_t time;
+    int64_t timeNsec;
+    uint64_t inode;
+  };
+
+  static bool statFile(const std::string& strFile, SourceFileStat& fileStat) {
+    struct stat st;
+    if (stat(strFile.c_str(), &st) != 0) return false;
+    fileStat.size = st.st_size;
+    fileStat.time = st.st_mtim.tv_sec;
+    fileStat.timeNsec = st.st_mtim.tv_nsec;
+    fileStat.inode = st.st_ino;
+    return true;
+  }
+
+  void writeOverlapCache(const std::string& strPaf, const std::string& strCache, DebugLevel debugLevel) {
+    MappedFile file(strPaf);
+    SourceFileStat fileStat;
+    if (!statFile(strPaf, fileStat)) {
+      throw std::runtime_error(std::string("SCARA OVERLAPCACHE: ERROR - unable to stat file: ") + strPaf);
+    }
+
+    std::vector<OverlapCacheRecord> vRecords;
+    std::vector<std::string> vNames;
+    std::unordered_map<std::string, uint32_t> mNameIds;
+    auto nameId = [&](const char* name, uint32_t length) {
+      auto it = mNameIds.emplace(std::string(name, length), (uint32_t)vNames.size());
+      if (it.second) vNames.emplace_back(it.first->first);
+      return it.first->second;
+    };
+
+    const char* pos = file.data();
+    const char* end = pos + file.size();
+    PafRecord record;
+    bool valid;
+    while (pos < end) {
+      const char* next = parsePafLine(pos, end, record, valid);
+      if (!valid) {
+        const char* lineEnd = (const char*)memchr(pos, '\n', end - pos);
+        if (lineEnd == NULL) lineEnd = end;
+        throw std::runtime_error(std::string("SCARA OVERLAPCACHE: ERROR - invalid PAF line in ") + strPaf + ": " + string(pos, lineEnd - pos));
+      }
+      if (record.qName != NULL) {
+        OverlapCacheRecord cacheRecord;
+        cacheRecord.qId = nameId(record.qName, record.qNameLength);
+        cacheRecord.qLength = record.qLength;
+        cacheRecord.qBegin = record.qBegin;
+        cacheRecord.qEnd = record.qEnd;
+        cacheRecord.tId = nameId(record.tName, record.tNameLength);
+        cacheRecord.tLength = record.tLength;
+        cacheRecord.tBegin = record.tBegin;
+        cacheRecord.tEnd = record.tEnd;
+        cacheRecord.matchingBases = record.matchingBases;
+        cacheRecord.overlapLength = record.overlapLength;
+        cacheRecord.mappingQuality = record.mappingQuality;
+        cacheRecord.orientation = record.orientation;
+        vRecords.emplace_back(cacheRecord);
+      }
+      pos = next;
+    }
+
+    OverlapCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, overlapCacheMagic, sizeof(header.magic));
+    header.sourceSize = fileStat.size;
+    header.sourceTime = fileStat.time;
+    header.sourceTimeNsec = fileStat.timeNsec;
+    header.sourceInode = fileStat.inode;
+    header.sourceChecksum = sourceChecksum(file.data(), file.size());
+    header.numOverlaps = vRecords.size();
+    header.numNames = vNames.size();
+    header.namesOffset = sizeof(header) + vRecords.size() * sizeof(OverlapCacheRecord);
+
+    std::vector<uint64_t> vNameOffsets;
+    vNameOffsets.reserve(vNames.size() + 1);
+    uint64_t nameOffset = 0;
+    for (auto const& name : vNames) {
+      vNameOffsets.emplace_back(nameOffset);
+      nameOffset += name.length();
+    }
+    vNameOffsets.emplace_back(nameOffset);
+
+    // Written into a temporary file, so that an interrupted conversion does not leave an invalid cache
+    std::string strTemp = strCache + ".tmp";
+    ofstream out(strTemp, ios::binary | ios::trunc);
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)vRecords.data(), vRecords.size() * sizeof(OverlapCacheRecord));
+    out.write((const char*)vNameOffsets.data(), vNameOffsets.size() * sizeof(uint64_t));
+    for (auto const& name : vNames) out.write(name.data(), name.length());
+    out.close();
+    if (!out || rename(strTemp.c_str(), strCache.c_str()) != 0) {
+      remove(strTemp.c_str());
+      throw std::runtime_error(std::string("SCARA OVERLAPCACHE: ERROR - unable to write overlap cache: ") + strCache);
+    }
+
+    if (debugLevel >= DL_INFO) {
+      cerr << "SCARA OVERLAPCACHE: Converted " << vRecords.size() << " overlaps with " << vNames.size()
+           << " names from " << strPaf << " into " << strCache << endl;
+    }
+  }
+
+  static bool readCacheHeader(const std::string& strCache, OverlapCacheHeader& header) {
+    ifstream in(strCache, ios::binary);
+    if (!in) return false;
+    in.read((char*)&header, sizeof(header));
+    return in && memcmp(header.magic, overlapCacheMagic, sizeof(header.magic)) == 0;
+  }
+
+  /* KK:
+   * Cache is valid if it was built from the same file (inode) with the same size and modification time
+   * (with nanoseconds, so that a change within the same second is noticed). If only the modification time
+   * or the inode differ (e.g. the file was copied or touched), the checksum of the file is compared.
+   */
+  std::string findOverlapCache(const std::string& strPaf) {
+    OverlapCacheHeader header;
+    if (readCacheHeader(strPaf, header)) return strPaf;
+
+    std::string strCache = strPaf + OverlapCacheSuffix;
+    SourceFileStat fileStat;
+    if (!readCacheHeader(strCache, header) || !statFile(strPaf, fileStat)) return "";
+    if (header.sourceSize != fileStat.size) return "";
+    if (header.sourceTime != fileStat.time || header.sourceTimeNsec != fileStat.timeNsec || header.sourceInode != fileStat.inode) {
+      MappedFile file(strPaf);
+      if (header.sourceChecksum != sourceChecksum(file.data(), file.size())) return "";
+    }
+    return strCache;
+  }
+
+  /* KK:
+   * Mapped overlap cache, with the header and the name table checked
+   */
+  class OverlapCacheView {
+  private:
+    MappedFile ocv_file;
+    const OverlapCacheHeader* ocv_header;
+    const OverlapCacheRecord* ocv_records;
+    const uint64_t* ocv_nameOffsets;
+    const char* ocv_names;
+
+    void corrupted(void) {
+      throw std::runtime_error(std::string("SCARA OVERLAPCACHE: ERROR - corrupted overlap cache: ") + ocv_file.fileName());
+    }
+
+  public:
+    explicit OverlapCacheView(const std::string& strCache) : ocv_file(strCache) {
+      const char* data = ocv_file.data();
+      uint64_t size = ocv_file.size();
+      if (size < sizeof(OverlapCacheHeader)) corrupted();
+      ocv_header = (const OverlapCacheHeader*)data;
+      if (memcmp(ocv_header->magic, overlapCacheMagic, sizeof(overlapCacheMagic)) != 0) corrupted();
+
+      uint64_t numOverlaps = ocv_header->numOverlaps, numNames = ocv_header->numNames;
+      uint64_t namesOffset = ocv_header->namesOffset;
+      if (numOverlaps > size / sizeof(OverlapCacheRecord) || numNames > size / sizeof(uint64_t)) corrupted();
+      if (namesOffset != sizeof(OverlapCacheHeader) + numOverlaps * sizeof(OverlapCacheRecord)) corrupted();
+      if (namesOffset + (numNames + 1) * sizeof(uint64_t) > size) corrupted();
+      ocv_records = (const OverlapCacheRecord*)(data + sizeof(OverlapCacheHeader));
+      ocv_nameOffsets = (const uint64_t*)(data + namesOffset);
+      ocv_names = data + namesOffset + (numNames + 1) * sizeof(uint64_t);
+      uint64_t namesSize = size - (ocv_names - data);
+      for (uint64_t i = 0; i < numNames; i++) {
+        if (ocv_nameOffsets[i] > ocv_nameOffsets[i + 1]) corrupted();
+      }
+      if (ocv_nameOffsets[numNames] > namesSize) corrupted();
+    }
+
+    uint64_t numOverlaps(void) const { return ocv_header->numOverlaps; }
+
+    // Creates overlaps for records in [first, last)
+    void createOverlaps(uint64_t first, uint64_t last, VecOvl& vOvl) {
+      const uint64_t numNames = ocv_header->numNames;
+      vOvl.reserve(vOvl.size() + (last - first));
+      for (uint64_t i = first; i < last; i++) {
+        const OverlapCacheRecord& record = ocv_records[i];
+        if (record.qId >= numNames || record.tId >= numNames) corrupted();
+        const char* qName = ocv_names + ocv_nameOffsets[record.qId];
+        const char* tName = ocv_names + ocv_nameOffsets[record.tId];
+        vOvl.emplace_back(new Overlap(qName, ocv_nameOffsets[record.qId + 1] - ocv_nameOffsets[record.qId],
+                                      record.qLength, record.qBegin, record.qEnd, (char)record.orientation,
+                                      tName, ocv_nameOffsets[record.tId + 1] - ocv_nameOffsets[record.tId],
+                                      record.tLength, record.tBegin, record.tEnd,
+                                      record.matchingBases, record.overlapLength, record.mappingQuality));
+      }
+    }
+  };
+
+  /* KK:
+   * Records are split into ranges converted into overlaps by separate threads, as with parsing PAF files
+   */
+  void loadOverlapCache(const std::string& strCache, VecOvl& vOvl, uint32_t numThreads, DebugLevel debugLevel) {
+    OverlapCacheView cache(strCache);
+    uint64_t numOverlaps = cache.numOverlaps();
+    uint64_t numChunks = std::max((uint64_t)1, std::min((uint64_t)numThreads, numOverlaps / MinCacheChunkSize));
+
+    if (numChunks == 1) {
+      cache.createOverlaps(0, numOverlaps, vOvl);
+    } else {
+      std::vector<VecOvl> vChunkOvl(numChunks);
+      std::unique_ptr<thread_pool::ThreadPool> threadPool = thread_pool::createThreadPool(numChunks);
+      std::vector<std::future<void>> vFutures;
+      for (uint64_t i = 0; i < numChunks; i++) {
+        vFutures.emplace_back(threadPool->submit([&, i]() {
+          cache.createOverlaps(numOverlaps * i / numChunks, numOverlaps * (i + 1) / numChunks, vChunkOvl[i]);
+        }));
+      }
+      for (auto& f : vFutures) f.wait();
+      for (auto& f : vFutures) f.get();
+
+      vOvl.reserve(vOvl.size() + numOverlaps);
+      for (auto& vChunk : vChunkOvl) {
+        std::move(vChunk.begin(), vChunk.end(), std::back_inserter(vOvl));
+      }
+    }
+
+    if (debugLevel >= DL_INFO) {
+      cerr << "SCARA OVERLAPCACHE: Loaded " << numOverlaps << " overlaps from " << strCache << endl;
+    }
+  }
+
+  void readOverlapCacheBatches(const std::string& strCache, uint32_t batchSize, const std::function<bool(VecOvl&&)>& emitBatch) {
+    OverlapCacheView cache(strCache);
+    uint64_t numOverlaps = cache.numOverlaps();
+    for (uint64_t first = 0; first < numOverlaps; first += batchSize) {
+      VecOvl vBatch;
+      cache.createOverlaps(first, std::min(first + batchSize, numOverlaps), vBatch);
+      if (!emitBatch(std::move(vBatch))) return;
+    }
+  }
+
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Types.h"
+#include "ScaraConfig.h"
+
+#include <functional>
+#include <string>
+
+namespace scara {
+
+  /* KK:
+   * Binary overlap cache, a PAF file converted into fixed-width records with read names replaced by IDs
+   * into a name table. The header keeps size, modification time, inode and checksum of the source PAF file.
+   * The cache is stored next to the PAF file (<overlaps>.scovl) and is used instead of it while valid,
+   * a cache file can also be given instead of the PAF file.
+   */
+  extern const char* const OverlapCacheSuffix;
+
+  // Converts the PAF file into an overlap cache
+  extern void writeOverlapCache(const std::string& strPaf, const std::string& strCache, DebugLevel debugLevel = DL_INFO);
+
+  // Returns the overlap cache that can be used instead of the given overlaps file, or an empty string
+  extern std::string findOverlapCache(const std::string& strPaf);
+
+  extern void loadOverlapCache(const std::string& strCache, VecOvl& vOvl, uint32_t numThreads, DebugLevel debugLevel = DL_INFO);
+
+  // Emits overlaps from the cache in batches of batchSize in file order, stops early if emitBatch returns false
+  extern void readOverlapCacheBatches(const std::string& strCache, uint32_t batchSize, const std::function<bool(VecOvl&&)>& emitBatch);
+
+}
@@ -0,0 +1,157 @@
+#include "PafTokenizer.h"
+
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCARA_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace scara {
+
+  uint32_t _pafFindFieldsScalar(const char* begin, const char* end, const char** fieldEnds, uint32_t maxFields) {
+    uint32_t numFields = 0;
+    for (const char* p = begin; p < end; p++) {
+      if (*p == '\t' || *p == '\n') {
+        fieldEnds[numFields++] = p;
+        if (*p == '\n' || numFields == maxFields) return numFields;
+      }
+    }
+    // Last line of the file without a line break
+    if (begin < end && numFields < maxFields) fieldEnds[numFields++] = end;
+    return numFields;
+  }
+
+#ifdef SCARA_X86_KERNELS
+  // Vectorized kernels compare whole blocks against both delimiters and walk the set bits of the mask
+  // The remainder of the line shorter than a block is handled by the next narrower kernel
+  __attribute__((target("sse2")))
+  static uint32_t _pafFindFieldsSSE2(const char* begin, const char* end, const char** fieldEnds, uint32_t maxFields) {
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i newline = _mm_set1_epi8('\n');
+    uint32_t numFields = 0;
+    const char* p = begin;
+    for (; p + 16 <= end; p += 16) {
+      __m128i c = _mm_loadu_si128((const __m128i*)p);
+      uint32_t mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(c, tab), _mm_cmpeq_epi8(c, newline)));
+      while (mask != 0) {
+        const char* delimiter = p + __builtin_ctz(mask);
+        fieldEnds[numFields++] = delimiter;
+        if (*delimiter == '\n' || numFields == maxFields) return numFields;
+        mask &= mask - 1;
+      }
+    }
+    return numFields + _pafFindFieldsScalar(p, end, fieldEnds + numFields, maxFields - numFields);
+  }
+
+  __attribute__((target("avx2")))
+  static uint32_t _pafFindFieldsAVX2(const char* begin, const char* end, const char** fieldEnds, uint32_t maxFields) {
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    uint32_t numFields = 0;
+    const char* p = begin;
+    for (; p + 32 <= end; p += 32) {
+      __m256i c = _mm256_loadu_si256((const __m256i*)p);
+      uint32_t mask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(c, tab), _mm256_cmpeq_epi8(c, newline)));
+      while (mask != 0) {
+        const char* delimiter = p + __builtin_ctz(mask);
+        fieldEnds[numFields++] = delimiter;
+        if (*delimiter == '\n' || numFields == maxFields) return numFields;
+        mask &= mask - 1;
+      }
+    }
+    return numFields + _pafFindFieldsSSE2(p, end, fieldEnds + numFields, maxFields - numFields);
+  }
+#endif
+
+  // Choose the fastest kernel supported by the CPU, done once
+  struct PafTokenizerKernel {
+    PafFieldFinder kernel;
+    const char* name;
+
+    PafTokenizerKernel() : kernel(_pafFindFieldsScalar), name("scalar") {
+#ifdef SCARA_X86_KERNELS
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx2")) {
+        kernel = _pafFindFieldsAVX2;
+        name = "avx2";
+      }
+      else if (__builtin_cpu_supports("sse2")) {
+        kernel = _pafFindFieldsSSE2;
+        name = "sse2";
+      }
+#endif
+    }
+  };
+  static const PafTokenizerKernel pafTokenizerKernel;
+
+  uint32_t _pafFindFields(const char* begin, const char* end, const char** fieldEnds, uint32_t maxFields) {
+    return pafTokenizerKernel.kernel(begin, end, fieldEnds, maxFields);
+  }
+
+  const char* _pafTokenizerKernelName(void) {
+    return pafTokenizerKernel.name;
+  }
+
+  // Unsigned 32 bit number filling the whole field, returns false if the field is not a number
+  static inline bool parsePafNumber(const char* begin, const char* end, uint32_t& value) {
+    uint32_t numDigits = end - begin;
+    if (numDigits == 0 || numDigits > 10) return false;
+    uint64_t result = 0;
+    for (const char* c = begin; c < end; c++) {
+      uint32_t digit = (uint32_t)(*c - '0');
+      if (digit > 9) return false;
+      result = result * 10 + digit;
+    }
+    if (result > UINT32_MAX) return false;
+    value = (uint32_t)result;
+    return true;
+  }
+
+  const char* parsePafLine(const char* begin, const char* end, PafRecord& record, bool& valid, PafFieldFinder findFields) {
+    const char* fieldEnds[PafNumFields];
+    record.qName = NULL;
+    valid = true;
+
+    uint32_t numFields = findFields(begin, end, fieldEnds, PafNumFields);
+    const char* lineEnd = (numFields > 0) ? fieldEnds[numFields - 1] : end;
+    // Optional fields after the mandatory ones are skipped
+    if (numFields == PafNumFields && lineEnd < end && *lineEnd == '\t') {
+      lineEnd = (const char*)memchr(lineEnd, '\n', end - lineEnd);
+      if (lineEnd == NULL) lineEnd = end;
+    }
+    const char* next = (lineEnd < end) ? lineEnd + 1 : end;
+
+    // Windows line endings
+    if (numFields > 0 && fieldEnds[numFields - 1] > begin && fieldEnds[numFields - 1][-1] == '\r') fieldEnds[numFields - 1]--;
+
+    if (numFields == 0 || (numFields == 1 && fieldEnds[0] == begin)) return next;
+    if (numFields < PafNumFields) {
+      valid = false;
+      return next;
+    }
+
+    const char* fieldStart[PafNumFields];
+    fieldStart[0] = begin;
+    for (uint32_t f = 1; f < PafNumFields; f++) fieldStart[f] = fieldEnds[f - 1] + 1;
+
+    record.qName = fieldStart[0];
+    record.qNameLength = fieldEnds[0] - fieldStart[0];
+    record.orientation = (fieldEnds[4] > fieldStart[4]) ? fieldStart[4][0] : 0;
+    record.tName = fieldStart[5];
+    record.tNameLength = fieldEnds[5] - fieldStart[5];
+    // Strand is a single '+' or '-'
+    valid = (fieldEnds[4] == fieldStart[4] + 1) && (record.orientation == '+' || record.orientation == '-')
+         && parsePafNumber(fieldStart[1], fieldEnds[1], record.qLength)
+         && parsePafNumber(fieldStart[2], fieldEnds[2], record.qBegin)
+         && parsePafNumber(fieldStart[3], fieldEnds[3], record.qEnd)
+         && parsePafNumber(fieldStart[6], fieldEnds[6], record.tLength)
+         && parsePafNumber(fieldStart[7], fieldEnds[7], record.tBegin)
+         && parsePafNumber(fieldStart[8], fieldEnds[8], record.tEnd)
+         && parsePafNumber(fieldStart[9], fieldEnds[9], record.matchingBases)
+         && parsePafNumber(fieldStart[10], fieldEnds[10], record.overlapLength)
+         && parsePafNumber(fieldStart[11], fieldEnds[11], record.mappingQuality);
+    return next;
+  }
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+namespace scara {
+
+  // Number of mandatory fields in a PAF line
+  const uint32_t PafNumFields = 12;
+
+  // Finds the ends of up to maxFields tab separated fields of the line starting at begin
+  // fieldEnds[i] points to the delimiter after field i ('\t', '\n'), or to end for the last line of the file
+  // Scanning stops at the end of the line or after maxFields fields, returns the number of fields found
+  typedef uint32_t (*PafFieldFinder)(const char* begin, const char* end, const char** fieldEnds, uint32_t maxFields);
+
+  // Uses the fastest kernel for the CPU
+  extern uint32_t _pafFindFields(const char* begin, const char* end, const char** fieldEnds, uint32_t maxFields);
+
+  extern uint32_t _pafFindFieldsScalar(const char* begin, const char* end, const char** fieldEnds, uint32_t maxFields);
+
+  extern const char* _pafTokenizerKernelName(void);
+
+  // Mandatory PAF fields, names point into the parsed line
+  struct PafRecord {
+    const char* qName;
+    uint32_t qNameLength;
+    uint32_t qLength, qBegin, qEnd;
+    char orientation;
+    const char* tName;
+    uint32_t tNameLength;
+    uint32_t tLength, tBegin, tEnd;
+    uint32_t matchingBases, overlapLength, mappingQuality;
+  };
+
+  // Parses the PAF line starting at begin, returns the start of the next line
+  // Empty lines are skipped (valid is true and record.qName is NULL), valid is false if the line is malformed
+  extern const char* parsePafLine(const char* begin, const char* end, PafRecord& record, bool& valid,
+                                  PafFieldFinder findFields = _pafFindFields);
+
+}
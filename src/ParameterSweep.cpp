@@ -0,0 +1,225 @@
+#include "SBridger.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <cctype>
+#include <climits>
+#include <algorithm>
+#include <future>
+#include <stdexcept>
+#include <cerrno>
+#include <sys/stat.h>
+#include "thread_pool/thread_pool.hpp"
+
+namespace scara {
+
+  using namespace std;
+
+  // A single setting of the sweep, and the results of the run with it
+  struct SweepSetting {
+    float SImin;
+    float OHmax;
+    uint32_t minPathsInGroup;
+    double pathGroupHalfSize;
+
+    uint32_t numEdges;
+    uint32_t numPaths;
+    uint32_t numPathGroups;
+    uint32_t numScaffolds;
+    std::string strOutput;
+  };
+
+  // A single value of a sweep grid, the whole token must be a non-negative number
+  static bool parseSweepValue(const std::string& strValue, double& value) {
+    if (strValue.empty() || !(isdigit(strValue[0]) || strValue[0] == '.')) return false;
+    size_t idx = 0;
+    try {
+      value = stod(strValue, &idx);
+    } catch (const std::logic_error&) {
+      return false;
+    }
+    return idx == strValue.size() && std::isfinite(value);
+  }
+
+  static bool parseSweepValue(const std::string& strValue, uint32_t& value) {
+    if (strValue.empty() || !isdigit(strValue[0])) return false;
+    size_t idx = 0;
+    unsigned long ulValue;
+    try {
+      ulValue = stoul(strValue, &idx);
+    } catch (const std::logic_error&) {
+      return false;
+    }
+    if (idx != strValue.size() || ulValue > UINT32_MAX) return false;
+    value = ulValue;
+    return true;
+  }
+
+  bool parseSweepGrid(const std::string& strGrid, ParameterSweep& sweep) {
+    std::stringstream ssGrid(strGrid);
+    std::string strParam;
+    while (std::getline(ssGrid, strParam, ';')) {
+      if (strParam.empty()) continue;
+      size_t pos = strParam.find('=');
+      if (pos == std::string::npos) return false;
+      std::string strName = strParam.substr(0, pos);
+      std::vector<std::string> vValues;
+      std::stringstream ssValues(strParam.substr(pos + 1));
+      std::string strValue;
+      while (std::getline(ssValues, strValue, ',')) vValues.emplace_back(strValue);
+      if (vValues.empty()) return false;
+      for (auto const& value : vValues) {
+        double dValue;
+        uint32_t ulValue;
+        if (strName == "pSImin") {
+          if (!parseSweepValue(value, dValue)) return false;
+          sweep.vSImin.emplace_back(dValue);
+        } else if (strName == "pOHmax") {
+          if (!parseSweepValue(value, dValue)) return false;
+          sweep.vOHmax.emplace_back(dValue);
+        } else if (strName == "pMinPathsInGroup") {
+          if (!parseSweepValue(value, ulValue)) return false;
+          sweep.vMinPathsinGroup.emplace_back(ulValue);
+        } else if (strName == "pPathGroupHalfSize") {
+          if (!parseSweepValue(value, dValue)) return false;
+          sweep.vPathGroupHalfSize.emplace_back(dValue);
+        } else {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  /* KK:
+   * Sequences are loaded once. The graph is constructed once with the least strict SImin and OHmax of the grid,
+   * so that it contains all edges usable with any setting. For each SImin and OHmax pair, edges that do not
+   * pass Edge::test with that pair are removed (in stored order, so the graph is the same as if it were
+   * constructed with that pair), and paths are generated. When paths are grouped during generation
+   * (StreamPaths), PathGroupHalfSize is also needed for path generation.
+   * Path grouping, scaffold chaining and output are run for each setting of the pair, in parallel
+   * with multithreading, on copies of the bridger sharing the graph and the paths.
+   */
+  int SBridger::runSweep(const ParameterSweep& sweep, const std::string& strDir) {
+    std::vector<SweepSetting> vSettings;
+    for (auto const& SImin : sweep.vSImin)
+      for (auto const& OHmax : sweep.vOHmax)
+        for (auto const& minPaths : sweep.vMinPathsinGroup)
+          for (auto const& halfSize : sweep.vPathGroupHalfSize) {
+            SweepSetting setting;
+            setting.SImin = SImin;
+            setting.OHmax = OHmax;
+            setting.minPathsInGroup = minPaths;
+            setting.pathGroupHalfSize = halfSize;
+            setting.numEdges = setting.numPaths = setting.numPathGroups = setting.numScaffolds = 0;
+            setting.strOutput = strDir + "/scaffolds_" + to_string(vSettings.size() + 1) + ".fasta";
+            vSettings.emplace_back(setting);
+          }
+    if (vSettings.empty()) return 0;
+
+    if (mkdir(strDir.c_str(), 0755) != 0 && errno != EEXIST) {
+      throw std::runtime_error(std::string("SCARA SWEEP: ERROR - unable to create sweep directory: ") + strDir);
+    }
+
+    const float origSImin = config.SImin;
+    const float origOHmax = config.OHmax;
+    config.SImin = *std::min_element(sweep.vSImin.begin(), sweep.vSImin.end());
+    config.OHmax = *std::max_element(sweep.vOHmax.begin(), sweep.vOHmax.end());
+    generateGraph();
+    if (config.debugLevel >= DL_INFO) {
+      cerr << "\nSCARA SWEEP: Generated graph for " << vSettings.size() << " settings with SImin " << config.SImin
+           << " and OHmax " << config.OHmax << ", usable edges: " << numEdges_usable << endl;
+    }
+
+    // Outgoing edges of the full graph, restricted for each pair of filtering parameters
+    std::vector<std::pair<std::shared_ptr<Node>, std::vector<std::shared_ptr<Edge>>>> vFullEdges;
+    for (auto const* mNodes : {&mAnchorNodes, &mReadNodes}) {
+      for (auto const& it : *mNodes) vFullEdges.emplace_back(it.second, it.second->vOutEdges);
+    }
+
+    // Settings are processed in groups sharing the graph and paths, in order of their first setting
+    std::vector<bool> vDone(vSettings.size(), false);
+    for (uint32_t first = 0; first < vSettings.size(); first++) {
+      if (vDone[first]) continue;
+      const SweepSetting& firstSetting = vSettings[first];
+      std::vector<uint32_t> vGroup;
+      for (uint32_t i = first; i < vSettings.size(); i++) {
+        if (vSettings[i].SImin == firstSetting.SImin && vSettings[i].OHmax == firstSetting.OHmax
+            && (!pathAggregator.streaming || vSettings[i].pathGroupHalfSize == firstSetting.pathGroupHalfSize)) {
+          vGroup.emplace_back(i);
+          vDone[i] = true;
+        }
+      }
+
+      config.SImin = firstSetting.SImin;
+      config.OHmax = firstSetting.OHmax;
+      uint32_t numEdges = 0;
+      for (auto const& it : vFullEdges) {
+        std::vector<std::shared_ptr<Edge>>& vOutEdges = it.first->vOutEdges;
+        vOutEdges.clear();
+        for (auto const& edge_ptr : it.second) {
+          if (edge_ptr->test(config) == 1) vOutEdges.emplace_back(edge_ptr);
+        }
+        numEdges += vOutEdges.size();
+      }
+
+      SBridger pathBridger(*this);
+      pathBridger.setGroupingParameters(firstSetting.minPathsInGroup, firstSetting.pathGroupHalfSize);
+      uint32_t numPaths = pathBridger.generatePaths();
+      if (config.debugLevel >= DL_INFO) {
+        cerr << "\nSCARA SWEEP: SImin " << config.SImin << ", OHmax " << config.OHmax << ": " << numEdges
+             << " edges, " << numPaths << " paths generated, processing " << vGroup.size() << " settings" << endl;
+      }
+
+      // Each setting groups and chains paths on its own copy, the graph and the paths are only read
+      auto runSetting = [&pathBridger, &vSettings, numEdges, numPaths](uint32_t idx) {
+        SweepSetting& setting = vSettings[idx];
+        SBridger settingBridger(pathBridger);
+        settingBridger.setGroupingParameters(setting.minPathsInGroup, setting.pathGroupHalfSize);
+        setting.numEdges = numEdges;
+        setting.numPaths = numPaths;
+        setting.numScaffolds = settingBridger.groupAndProcessPaths();
+        setting.numPathGroups = settingBridger.pathAggregator.vPathGroups.size();
+        settingBridger.generateSequences(setting.strOutput, 1);
+      };
+
+      if (config.multithreading && vGroup.size() > 1) {
+        std::unique_ptr<thread_pool::ThreadPool> threadPool = thread_pool::createThreadPool(std::min((uint32_t)vGroup.size(), config.NumThreads));
+        std::vector<std::future<void>> vFutures;
+        for (auto const& idx : vGroup) vFutures.emplace_back(threadPool->submit(runSetting, idx));
+        // Wait for all settings, even if one of them failed, then report the first error
+        for (auto& f : vFutures) f.wait();
+        for (auto& f : vFutures) f.get();
+      } else {
+        for (auto const& idx : vGroup) runSetting(idx);
+      }
+    }
+
+    // The full graph and the parameters are restored
+    for (auto const& it : vFullEdges) it.first->vOutEdges = it.second;
+    config.SImin = origSImin;
+    config.OHmax = origOHmax;
+
+    std::string strSummary = strDir + "/summary.tsv";
+    ofstream summary(strSummary);
+    summary << "setting\tSImin\tOHmax\tMinPathsinGroup\tPathGroupHalfSize\tedges\tpaths\tpath_groups\tscaffolds\toutput" << endl;
+    for (uint32_t i = 0; i < vSettings.size(); i++) {
+      const SweepSetting& setting = vSettings[i];
+      summary << (i + 1) << '\t' << setting.SImin << '\t' << setting.OHmax << '\t' << setting.minPathsInGroup << '\t'
+              << setting.pathGroupHalfSize << '\t' << setting.numEdges << '\t' << setting.numPaths << '\t'
+              << setting.numPathGroups << '\t' << setting.numScaffolds << '\t' << setting.strOutput << endl;
+    }
+    summary.close();
+    if (!summary) {
+      throw std::runtime_error(std::string("SCARA SWEEP: ERROR - unable to write sweep summary: ") + strSummary);
+    }
+    if (config.debugLevel >= DL_INFO) {
+      cerr << "\nSCARA SWEEP: Finished " << vSettings.size() << " settings, summary written into " << strSummary << endl;
+    }
+
+    return vSettings.size();
+  }
+
+}
@@ -1,27 +1,145 @@
 #include "SBridger.h"
-#include "globals.h"
 #include <vector>
 #include <algorithm>
 // #include <string>
 #include <iostream>
 #include <set>
+#include <unordered_map>
+#include <deque>
+#include <future>
+#include <functional>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <sstream>
+#include <sys/stat.h>
+#include "thread_pool/thread_pool.hpp"
 
 namespace scara {
 
   using namespace std;
 
-  extern int multithreading;
-
-  SBridger::SBridger(const string& strReadsFasta, const string& strContigsFasta, const string& strR2Cpaf, const string& strR2Rpaf) {
+  SBridger::SBridger(const ScaraConfig& t_config, const string& strReadsFasta, const string& strContigsFasta, const string& strR2Cpaf, const string& strR2Rpaf)
+    : config(t_config), pathAggregator(t_config.StreamPaths, t_config.PathGroupHalfSize) {
     Initialize(strReadsFasta, strContigsFasta, strR2Cpaf, strR2Rpaf);
     bGraphCreated = 0;
   }
 
+  SBridger::SBridger(const ScaraConfig& t_config, MapIdToSeq t_mIdToRead, MapIdToSeq t_mIdToContig, VecOvl&& t_vOvlR2C, VecOvl&& t_vOvlR2R)
+    : config(t_config), vOvlR2C(std::move(t_vOvlR2C)), vOvlR2R(std::move(t_vOvlR2R))
+    , mIdToContig(std::move(t_mIdToContig)), mIdToRead(std::move(t_mIdToRead))
+    , pathAggregator(t_config.StreamPaths, t_config.PathGroupHalfSize) {
+    // There are no overlap files to parse during graph construction
+    config.PipelineGraph = false;
+    if (config.PackReads) {
+      for (auto const& it : mIdToRead) it.second->pack();
+    }
+    bGraphCreated = 0;
+  }
+
+  SBridger::SBridger(const SBridger& other)
+    : config(other.config), mIdToContig(other.mIdToContig), mIdToRead(other.mIdToRead), strR2Cpaf(other.strR2Cpaf), strR2Rpaf(other.strR2Rpaf)
+    , numANodes(other.numANodes), numRNodes(other.numRNodes), numEdges_all(other.numEdges_all)
+    , numEdges_usable(other.numEdges_usable), numEdges_contained(other.numEdges_contained)
+    , numEdges_short(other.numEdges_short), numEdges_lowqual(other.numEdges_lowqual), numEdges_zero(other.numEdges_zero)
+    , isolatedANodes(other.isolatedANodes), isolatedRNodes(other.isolatedRNodes), pathAggregator(other.pathAggregator)
+    , vPathInfos(other.vPathInfos), vPathGroups(other.vPathGroups), scaffolds(other.scaffolds)
+    , bGraphCreated(other.bGraphCreated)
+    , mAnchorNodes(other.mAnchorNodes), mReadNodes(other.mReadNodes) {
+  }
+
+  void SBridger::setGroupingParameters(uint32_t t_minPathsInGroup, double t_pathGroupHalfSize) {
+    config.MinPathsinGroup = t_minPathsInGroup;
+    config.PathGroupHalfSize = t_pathGroupHalfSize;
+    pathAggregator.groupHalfSize = t_pathGroupHalfSize;
+  }
+
+  /* KK:
+   * The four input files are independent, with multithreading they are loaded concurrently
+   * and joined before graph construction. Loading time and throughput are reported for each file.
+   */
   void SBridger::Initialize(const string& strReadsFasta, const string& strContigsFasta, const string& strR2Cpaf, const string& strR2Rpaf) {
-      parseProcessFastq(strReadsFasta, mIdToRead);
-      parseProcessFasta(strContigsFasta, mIdToContig);
-      parseProcessPaf(strR2Cpaf, vOvlR2C);
-      parseProcessPaf(strR2Rpaf, vOvlR2R);
+      this->strR2Cpaf = strR2Cpaf;
+      this->strR2Rpaf = strR2Rpaf;
+
+      auto loadReads = [this, &strReadsFasta]() {
+        if (config.LazyReads) {
+          indexProcessReads(strReadsFasta, mIdToRead, config);
+        } else if (config.MapSequences) {
+          mapProcessSequences(strReadsFasta, mIdToRead, config);
+          if (config.PackReads) {
+            for (auto const& it : mIdToRead) it.second->pack();
+          }
+        } else {
+          parseProcessFastq(strReadsFasta, mIdToRead, config);
+        }
+      };
+      auto loadContigs = [this, &strContigsFasta]() {
+        if (config.MapSequences) {
+          mapProcessSequences(strContigsFasta, mIdToContig, config);
+        } else {
+          parseProcessFasta(strContigsFasta, mIdToContig, config);
+        }
+      };
+
+      // KK: Overlap files are parsed concurrently, so worker threads are split between them
+      // in proportion to their sizes, each file gets at least one thread
+      ScaraConfig r2cConfig = config, r2rConfig = config;
+      if (config.multithreading && config.NumThreads > 1) {
+        struct stat stR2C, stR2R;
+        double sizeR2C = (stat(strR2Cpaf.c_str(), &stR2C) == 0) ? stR2C.st_size : 0;
+        double sizeR2R = (stat(strR2Rpaf.c_str(), &stR2R) == 0) ? stR2R.st_size : 0;
+        double share = (sizeR2C + sizeR2R > 0) ? sizeR2C / (sizeR2C + sizeR2R) : 0.5;
+        uint32_t numR2CThreads = (uint32_t)(share * config.NumThreads + 0.5);
+        r2cConfig.NumThreads = std::min(std::max(numR2CThreads, 1u), config.NumThreads - 1);
+        r2rConfig.NumThreads = config.NumThreads - r2cConfig.NumThreads;
+      }
+      auto loadR2C = [this, &strR2Cpaf, &r2cConfig]() { parseProcessPaf(strR2Cpaf, vOvlR2C, r2cConfig); };
+      auto loadR2R = [this, &strR2Rpaf, &r2rConfig]() { parseProcessPaf(strR2Rpaf, vOvlR2R, r2rConfig); };
+
+      // Runs the loading function, returns elapsed time in seconds
+      auto timedLoad = [](std::function<void(void)> load) {
+        auto start = std::chrono::steady_clock::now();
+        load();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+      };
+
+      std::vector<std::string> vFiles = {strReadsFasta, strContigsFasta};
+      std::vector<std::function<void(void)>> vLoads = {loadReads, loadContigs};
+      // With PipelineGraph, overlaps are parsed while the graph is generated,
+      // with a graph index they are not needed at all, when resuming they are loaded only if needed
+      if (!config.PipelineGraph && config.LoadGraphFile.empty() && config.ResumeFrom == CP_NONE) {
+        vFiles.insert(vFiles.end(), {strR2Cpaf, strR2Rpaf});
+        vLoads.insert(vLoads.end(), {loadR2C, loadR2R});
+      }
+      std::vector<double> vTimes(vLoads.size(), 0);
+      auto start = std::chrono::steady_clock::now();
+      if (config.multithreading) {
+        std::unique_ptr<thread_pool::ThreadPool> threadPool = thread_pool::createThreadPool(vLoads.size());
+        std::vector<std::future<double>> vFutures;
+        for (auto const& load : vLoads) vFutures.emplace_back(threadPool->submit(timedLoad, load));
+        // Wait for all files, even if one of them failed, then report the first error
+        for (auto& f : vFutures) f.wait();
+        for (uint32_t i = 0; i < vFutures.size(); i++) vTimes[i] = vFutures[i].get();
+      } else {
+        for (uint32_t i = 0; i < vLoads.size(); i++) vTimes[i] = timedLoad(vLoads[i]);
+      }
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+      if (config.debugLevel >= DL_INFO) {
+        for (uint32_t i = 0; i < vFiles.size(); i++) {
+          struct stat st;
+          double sizeMB = (stat(vFiles[i].c_str(), &st) == 0) ? st.st_size / 1e6 : 0;
+          cerr << "SCARA BRIDGER: Loaded " << vFiles[i] << " (" << sizeMB << " MB) in " << vTimes[i] << " s";
+          if (vTimes[i] > 0) cerr << ", " << sizeMB / vTimes[i] << " MB/s";
+          cerr << endl;
+        }
+        cerr << "SCARA BRIDGER: Loading input files took " << elapsed.count() << " s";
+        cerr << (config.multithreading ? " (concurrently)" : "") << endl;
+      }
   }
 
 	void SBridger::printState() {
@@ -41,13 +159,15 @@ namespace scara {
 	  	std::cerr << "\nOutgoing edges: " << numEdges;
 	  	// std::cerr << "\nAll edges: " << vEdges.size();
 
-	  	std::cerr << "\nPaths vector size: " << vPaths.size();
+	  	std::cerr << "\nPaths generated: " << pathAggregator.numPaths;
+	  	std::cerr << "\nDistinct paths vector size: " << pathAggregator.vPaths.size();
 	  	// Estimating the total size of paths
 	  	numEdges = 0;
-	  	for (auto const& path_ptr: vPaths) numEdges += path_ptr->edges.size();
+	  	for (auto const& path_ptr: pathAggregator.vPaths) numEdges += path_ptr->edges.size();
 	  	std::cerr << "\nTotal number of edges in paths: " << numEdges;
 
 	  	std::cerr << "\nPath infos vector size: " << vPathInfos.size();
+	  	std::cerr << "\nPath groups generated: " << pathAggregator.vPathGroups.size();
 	  	std::cerr << "\nPath groups vector size: " << vPathGroups.size();
 
 	  	std::cerr << "\nFinal scaffolds vector size: " << scaffolds.size();
@@ -91,13 +211,18 @@ namespace scara {
 
 	void SBridger::printPaths(void) {
 		std::cerr << "\nPrinting generated paths!";
-		std::cerr << "\nNumber of paths: " << vPaths.size();
+		std::cerr << "\nNumber of paths: " << pathAggregator.numPaths;
+		std::cerr << "\nNumber of distinct paths: " << pathAggregator.vPaths.size();
+		if (pathAggregator.streaming) {
+			std::cerr << "\nPaths are grouped while streaming, only group representatives are kept!";
+			return;
+		}
 		std::cerr << "\nPaths:\n";
 		int i = 1;
 
-		for (auto const& t_path_ptr : vPaths) {
+		for (auto const& t_path_ptr : pathAggregator.vPaths) {
 			size_t size = t_path_ptr->edges.size();
-			std::cerr << "\nPath #" << i << ", edges: " << size << '\n';
+			std::cerr << "\nPath #" << i << ", edges: " << size << ", generated: " << pathAggregator.vPathCounts[i-1] << " times\n";
 			if (size > 10) {
 				auto first = t_path_ptr->edges.front();
 				auto last  = t_path_ptr->edges.back();
@@ -118,12 +243,12 @@ namespace scara {
 
   void SBridger::print(void) {
   	  ofstream outStream;
-	  outStream.open(scara::logFile);
+	  if (!config.logFile.empty()) outStream.open(config.logFile);
       std::cerr << "\nSBridger:\n";
       printData();
       printGraph();
 
-      if (scara::globalDebugLevel >= DL_VERBOSE) {
+      if (config.debugLevel >= DL_VERBOSE && outStream.is_open()) {
 		  outStream << "OVERLAPS FOR CONTIGS:" << endl << endl;
 		  printOvlToStream(vOvlR2C, outStream);
 
@@ -140,11 +265,7 @@ namespace scara {
  	  outStream.close();
   }
 
-  void SBridger::generateGraph(void) {
-
-  	 numANodes = numRNodes = 0;
-
-	 numEdges_all = numEdges_usable = numEdges_contained = numEdges_short = numEdges_lowqual = numEdges_zero = 0;
+  void SBridger::createNodes(void) {
 
 	// 1. Generate anchor nodes for each original contig and for reverse complement
 	for (auto const& it : mIdToContig) {
@@ -169,62 +290,53 @@ namespace scara {
 		mReadNodes.emplace(it.first + "_RC", node_ptr);
 	}
 	numRNodes = mReadNodes.size();
+  }
+
+  void SBridger::generateGraph(void) {
+
+  	 numANodes = numRNodes = 0;
+
+	 numEdges_all = numEdges_usable = numEdges_contained = numEdges_short = numEdges_lowqual = numEdges_zero = 0;
+
+	createNodes();
 
 	// 3. Generate edges, function Overlap::Test() is used for filtering
-	std::vector<shared_ptr<Edge>> vTempEdges;		// Temporarily store all edges here
-	for (auto const& it : vOvlR2C) {
-		if (it->Test()) {
-			createEdgesFromOverlap(it, mAnchorNodes, mReadNodes, vTempEdges);
-		}
-	}
-	
-	for (auto const& it : vOvlR2R) {
-		if (it->Test()) {
-			createEdgesFromOverlap(it, mAnchorNodes, mReadNodes, vTempEdges);
-		}
+	if (!config.LoadGraphFile.empty()) {
+		// Edges are taken from a prebuilt graph index
+		loadGraphIndex(config.LoadGraphFile);
+	} else if (config.PipelineGraph) {
+		// Overlaps are parsed while edges are generated
+		generateEdgesPipelined();
+	} else if (config.multithreading && config.NumThreads > 1) {
+		generateEdgesParallel();
+	} else {
+		// Edges are tested while they are created, only usable edges are stored
+		std::vector<shared_ptr<Edge>> vTempEdges;
+		EdgeTestCounts counts;
+		createTestedEdges(vOvlR2C.begin(), vOvlR2C.end(), mAnchorNodes, mReadNodes, vTempEdges, counts, config);
+		createTestedEdges(vOvlR2R.begin(), vOvlR2R.end(), mAnchorNodes, mReadNodes, vTempEdges, counts, config);
+
+		// Clear vectors with Overlaps, do not need them any more
+		// TODO: Do not use overlaps at all, just use edges from the start.
+		vOvlR2C.clear();
+		vOvlR2C.shrink_to_fit();
+		vOvlR2R.clear();
+		vOvlR2R.shrink_to_fit();
+
+		// 3.1 Connect Edges to Nodes
+		attachEdges(vTempEdges, counts);
+		vTempEdges.clear(); 
+		vTempEdges.shrink_to_fit();
 	}
 
-	// Clear vectors with Overlaps, do not need them any more
-	// TODO: Do not use overlaps at all, just use edges from the start.
-	vOvlR2C.clear();
-	vOvlR2C.shrink_to_fit();
-	vOvlR2R.clear();
-	vOvlR2R.shrink_to_fit();
+	countIsolatedNodes();
 
-	// 3.1 Connect Edges to Nodes
-	for (auto const& edge_ptr : vTempEdges) {
-		// First test edges
-		int test_val = edge_ptr->test();
-		switch (test_val) {
-			case (-1):
-				numEdges_contained += 1;
-				break;
-			case (-2):
-				numEdges_short += 1;
-				break;
-			case (-3):
-				numEdges_lowqual += 1;
-				break;
-			case (-4):
-				numEdges_zero += 1;
-				break;
-			default:
-				numEdges_usable += 1;
-				break;
-		}
-		if (test_val > 0) {
-			// Add edge to outgoing edges for its startNode
-			std::shared_ptr<Node> startNode = edge_ptr->startNode;
-			std::shared_ptr<Node> endNode = edge_ptr->endNode;
-			startNode->vOutEdges.emplace_back(std::move(edge_ptr));
-			/* KK: trying not to use that any more
-			vEdges.emplace_back(edge_ptr);				// Only usable edges are stored in the vector
-			*/
-		}
-	}
-	vTempEdges.clear(); 
-	vTempEdges.shrink_to_fit();
+	bGraphCreated = 1;
+
+	if (!config.SaveGraphFile.empty() && config.LoadGraphFile.empty()) saveGraphIndex(config.SaveGraphFile);
+  }
 
+  void SBridger::countIsolatedNodes(void) {
 	// 4. Filter nodes
 	// Remove isolated and contained read nodes
 	// TODO:
@@ -239,10 +351,243 @@ namespace scara {
 		std::shared_ptr<Node> rNode = itRNode.second;
 		if (rNode->vOutEdges.size() == 0) isolatedRNodes += 1;
 	}
+  }
+
+
+  void SBridger::addEdgeCounts(const EdgeTestCounts &counts) {
+	numEdges_usable += counts.usable;
+	numEdges_contained += counts.contained;
+	numEdges_short += counts.shortEdges;
+	numEdges_lowqual += counts.lowqual;
+	numEdges_zero += counts.zero;
+  }
+
+  // Adds usable edges to outgoing edges of their start nodes
+  void SBridger::attachEdges(std::vector<shared_ptr<Edge>> &vEdges, const EdgeTestCounts &counts) {
+	addEdgeCounts(counts);
+	for (auto& edge_ptr : vEdges) {
+		std::shared_ptr<Node> startNode = edge_ptr->startNode;
+		startNode->vOutEdges.emplace_back(std::move(edge_ptr));
+		/* KK: trying not to use that any more
+		vEdges.emplace_back(edge_ptr);				// Only usable edges are stored in the vector
+		*/
+	}
+  }
 
-	bGraphCreated = 1;
+  /* KK:
+   * Generates edges from loaded overlaps using multiple threads, without locking.
+   * Each thread creates and tests edges for a contiguous range of overlaps in its own buffer and keeps
+   * its own edge counters. Usable edges are distributed into buckets by ranges of start nodes, then
+   * each thread counts and appends the edges for one range of nodes, taking buckets in thread order.
+   * Outgoing edges therefore end up in the same order as with the serial version.
+   */
+  void SBridger::generateEdgesParallel(void) {
+	const uint32_t numThreads = config.NumThreads;
+
+	// Index all nodes, edges are sorted by the index of their start node
+	std::vector<Node*> vNodes;
+	std::unordered_map<const Node*, uint32_t> mNodeIndex;
+	vNodes.reserve(mAnchorNodes.size() + mReadNodes.size());
+	mNodeIndex.reserve(mAnchorNodes.size() + mReadNodes.size());
+	for (auto const* mNodes : {&mAnchorNodes, &mReadNodes}) {
+		for (auto const& it : *mNodes) {
+			mNodeIndex.emplace(it.second.get(), vNodes.size());
+			vNodes.emplace_back(it.second.get());
+		}
+	}
+	const uint32_t numNodes = vNodes.size();
+	const uint32_t nodesPerRange = std::max((numNodes + numThreads - 1) / numThreads, (uint32_t)1);
+
+	const uint64_t numOvlR2C = vOvlR2C.size();
+	const uint64_t numOvl = numOvlR2C + vOvlR2R.size();
+
+	struct BucketEdge {
+		uint32_t nodeIdx;
+		shared_ptr<Edge> edge_ptr;
+	};
+	std::vector<EdgeTestCounts> vCounts(numThreads);
+	// Usable edges, for each thread and each range of start nodes
+	std::vector<std::vector<std::vector<BucketEdge>>> vBuckets(numThreads, std::vector<std::vector<BucketEdge>>(numThreads));
+
+	auto buildEdges = [&](uint32_t threadIdx) {
+		const uint64_t begin = numOvl * threadIdx / numThreads;
+		const uint64_t end = numOvl * (threadIdx + 1) / numThreads;
+		std::vector<shared_ptr<Edge>> vEdges;
+		if (begin < numOvlR2C) {
+			createTestedEdges(vOvlR2C.begin() + begin, vOvlR2C.begin() + std::min(end, numOvlR2C)
+				, mAnchorNodes, mReadNodes, vEdges, vCounts[threadIdx], config);
+		}
+		if (end > numOvlR2C) {
+			createTestedEdges(vOvlR2R.begin() + (std::max(begin, numOvlR2C) - numOvlR2C), vOvlR2R.begin() + (end - numOvlR2C)
+				, mAnchorNodes, mReadNodes, vEdges, vCounts[threadIdx], config);
+		}
+		for (auto& edge_ptr : vEdges) {
+			uint32_t nodeIdx = mNodeIndex.at(edge_ptr->startNode.get());
+			vBuckets[threadIdx][nodeIdx / nodesPerRange].push_back({nodeIdx, std::move(edge_ptr)});
+		}
+	};
+
+	auto attachEdges = [&](uint32_t rangeIdx) {
+		const uint32_t first = rangeIdx * nodesPerRange;
+		if (first >= numNodes) return;
+		const uint32_t last = std::min(first + nodesPerRange, numNodes);
+		std::vector<uint32_t> vNodeCounts(last - first, 0);
+		for (uint32_t t = 0; t < numThreads; t++) {
+			for (auto const& bEdge : vBuckets[t][rangeIdx]) vNodeCounts[bEdge.nodeIdx - first] += 1;
+		}
+		for (uint32_t i = first; i < last; i++) {
+			if (vNodeCounts[i - first] > 0) vNodes[i]->vOutEdges.reserve(vNodes[i]->vOutEdges.size() + vNodeCounts[i - first]);
+		}
+		for (uint32_t t = 0; t < numThreads; t++) {
+			for (auto& bEdge : vBuckets[t][rangeIdx]) vNodes[bEdge.nodeIdx]->vOutEdges.emplace_back(std::move(bEdge.edge_ptr));
+			std::vector<BucketEdge>().swap(vBuckets[t][rangeIdx]);
+		}
+	};
+
+	std::unique_ptr<thread_pool::ThreadPool> threadPool = thread_pool::createThreadPool(numThreads);
+	for (auto const& phase : std::vector<std::function<void(uint32_t)>>{buildEdges, attachEdges}) {
+		std::vector<std::future<void>> vFutures;
+		for (uint32_t i = 0; i < numThreads; i++) vFutures.emplace_back(threadPool->submit(phase, i));
+		// Wait for all threads, even if one of them failed, then report the first error
+		for (auto& f : vFutures) f.wait();
+		for (auto& f : vFutures) f.get();
+	}
+
+	for (auto const& counts : vCounts) addEdgeCounts(counts);
+
+	// Clear vectors with Overlaps, do not need them any more
+	vOvlR2C.clear();
+	vOvlR2C.shrink_to_fit();
+	vOvlR2R.clear();
+	vOvlR2R.shrink_to_fit();
   }
 
+  /* KK:
+   * Generates edges while the overlap files are parsed. A reader thread parses contig-read and then
+   * read-read overlaps in batches, builder threads create and test edges for each batch, and the results
+   * are attached to nodes in batch order, so edges end up in the same order as when overlaps are loaded first.
+   * The number of batches in flight is limited, so only a small part of overlaps is kept in memory.
+   * Without multithreading batches are processed one after another while they are read.
+   */
+  void SBridger::generateEdgesPipelined(void) {
+	const uint32_t batchSize = 4096;
+
+	// Usable edges created from a batch of overlaps, together with edge counts
+	struct EdgeBatch {
+		std::vector<shared_ptr<Edge>> vEdges;
+		EdgeTestCounts counts;
+	};
+	auto buildEdges = [this](const VecOvl& vOvl, EdgeBatch& edgeBatch) {
+		createTestedEdges(vOvl.begin(), vOvl.end(), mAnchorNodes, mReadNodes, edgeBatch.vEdges, edgeBatch.counts, config);
+	};
+	auto attachBatch = [this](EdgeBatch& edgeBatch) {
+		attachEdges(edgeBatch.vEdges, edgeBatch.counts);
+	};
+
+	if (!config.multithreading) {
+		auto processBatch = [&](VecOvl&& vOvl) {
+			EdgeBatch edgeBatch;
+			buildEdges(vOvl, edgeBatch);
+			attachBatch(edgeBatch);
+			return true;
+		};
+		readPafBatches(strR2Cpaf, batchSize, processBatch);
+		readPafBatches(strR2Rpaf, batchSize, processBatch);
+		return;
+	}
+
+	const uint32_t numBuilders = std::max(config.NumThreads, (uint32_t)1);
+	const uint64_t maxBatchesInFlight = 4 * numBuilders;
+
+	std::mutex mtx;
+	std::condition_variable cvReader, cvBuilders, cvAttach;
+	std::deque<std::pair<uint64_t, VecOvl>> qBatches;		// Parsed batches waiting for builders
+	std::map<uint64_t, EdgeBatch> mResults;					// Built batches waiting to be attached
+	uint64_t numBatches = 0, numAttached = 0;
+	bool readerDone = false, aborted = false;
+	std::exception_ptr error;
+
+	// Stores the first error and wakes up everyone waiting
+	auto fail = [&](std::exception_ptr e) {
+		std::lock_guard<std::mutex> lock(mtx);
+		if (!error) error = e;
+		aborted = true;
+		cvReader.notify_all();
+		cvBuilders.notify_all();
+		cvAttach.notify_all();
+	};
+
+	auto reader = [&]() {
+		try {
+			auto emitBatch = [&](VecOvl&& vOvl) {
+				std::unique_lock<std::mutex> lock(mtx);
+				cvReader.wait(lock, [&]() { return aborted || numBatches - numAttached < maxBatchesInFlight; });
+				if (aborted) return false;
+				qBatches.emplace_back(numBatches++, std::move(vOvl));
+				cvBuilders.notify_one();
+				return true;
+			};
+			readPafBatches(strR2Cpaf, batchSize, emitBatch);
+			readPafBatches(strR2Rpaf, batchSize, emitBatch);
+			std::lock_guard<std::mutex> lock(mtx);
+			readerDone = true;
+			cvBuilders.notify_all();
+			cvAttach.notify_all();
+		} catch (...) {
+			fail(std::current_exception());
+		}
+	};
+
+	auto builder = [&]() {
+		while (true) {
+			std::pair<uint64_t, VecOvl> batch;
+			{
+				std::unique_lock<std::mutex> lock(mtx);
+				cvBuilders.wait(lock, [&]() { return aborted || readerDone || !qBatches.empty(); });
+				if (aborted || qBatches.empty()) return;
+				batch = std::move(qBatches.front());
+				qBatches.pop_front();
+			}
+			EdgeBatch edgeBatch;
+			try {
+				buildEdges(batch.second, edgeBatch);
+			} catch (...) {
+				fail(std::current_exception());
+				return;
+			}
+			std::lock_guard<std::mutex> lock(mtx);
+			mResults.emplace(batch.first, std::move(edgeBatch));
+			cvAttach.notify_one();
+		}
+	};
+
+	std::unique_ptr<thread_pool::ThreadPool> threadPool = thread_pool::createThreadPool(numBuilders + 1);
+	std::vector<std::future<void>> vFutures;
+	vFutures.emplace_back(threadPool->submit(reader));
+	for (uint32_t i = 0; i < numBuilders; i++) vFutures.emplace_back(threadPool->submit(builder));
+
+	// Attach built batches in order
+	while (true) {
+		EdgeBatch edgeBatch;
+		{
+			std::unique_lock<std::mutex> lock(mtx);
+			cvAttach.wait(lock, [&]() {
+				return aborted || mResults.count(numAttached) > 0 || (readerDone && numAttached == numBatches);
+			});
+			auto it = mResults.find(numAttached);
+			if (aborted || it == mResults.end()) break;
+			edgeBatch = std::move(it->second);
+			mResults.erase(it);
+		}
+		attachBatch(edgeBatch);
+		std::lock_guard<std::mutex> lock(mtx);
+		numAttached++;
+		cvReader.notify_one();
+	}
+
+	for (auto& f : vFutures) f.wait();
+	if (error) std::rethrow_exception(error);
+  }
 
   void SBridger::cleanupGraph(void) {
   	// TODO: this is currently a placeholder
@@ -250,31 +595,28 @@ namespace scara {
   }
 
   int SBridger::generatePaths(void) {
-  	uint32_t numPaths_maxOvl = scara::generatePathsDeterministic(vPaths, mAnchorNodes, PGT_MAXOS);
-  	if (scara::print_output)
+  	uint32_t numPaths_maxOvl = scara::generatePathsDeterministic(pathAggregator, mAnchorNodes, PGT_MAXOS, config);
+  	if (config.print_output)
   		std::cerr << "\nSCARA: Generating paths using maximum overlap score. Number of paths generated: " << numPaths_maxOvl;
-    uint32_t numPaths_maxExt = scara::generatePathsDeterministic(vPaths, mAnchorNodes, PGT_MAXES);
-    if (scara::print_output)
+    uint32_t numPaths_maxExt = scara::generatePathsDeterministic(pathAggregator, mAnchorNodes, PGT_MAXES, config);
+    if (config.print_output)
     	std::cerr << "\nSCARA: Generating paths using maximum extension score. Number of paths generated: " << numPaths_maxExt;
     uint32_t minMCPaths = numPaths_maxExt + numPaths_maxOvl;
-    if (minMCPaths < scara::MinMCPaths) minMCPaths = scara::MinMCPaths;
-    uint32_t numPaths_MC = scara::generatePaths_MC(vPaths, mAnchorNodes, minMCPaths);
-    if (scara::print_output)
+    if (minMCPaths < config.MinMCPaths) minMCPaths = config.MinMCPaths;
+    uint32_t numPaths_MC = scara::generatePaths_MC(pathAggregator, mAnchorNodes, minMCPaths, config);
+    if (config.print_output)
   		std::cerr << "\nSCARA: Generating paths using Monte Carlo approach. Number of paths generated: " << numPaths_MC;
 
 
-    return vPaths.size();
+    return pathAggregator.numPaths;
   }
 
   int SBridger::groupAndProcessPaths(void) {
-  	int numGroups = 0;
-  	std::vector<shared_ptr<PathGroup>> tempPathGroups;
-  	
   	/* KK: Was only for testing */
   	// Printing paths before processing
-  	if (scara::globalDebugLevel >= DL_DEBUG) {
+  	if (config.debugLevel >= DL_DEBUG) {
   		std::cerr << "\n\nSCARA: paths before processing:";
-  		for (auto const& path_ptr : vPaths) {
+  		for (auto const& path_ptr : pathAggregator.vPaths) {
   			shared_ptr<PathInfo> pathinfo_ptr = make_shared<PathInfo>(path_ptr);
   			std::cerr << "\nPATHINFO: SNODE(" << pathinfo_ptr->startNodeName << "), ";
   			std::cerr << "ENODE(" << pathinfo_ptr->endNodeName << "), ";
@@ -290,22 +632,15 @@ namespace scara {
 
   	// Path extending to the left are reversed so that all paths extend to the right
   	// Simulaneously paths are grouped into buckets of set size
-  	if (scara::globalDebugLevel >= DL_VERBOSE) {
+  	// In streaming mode this was already done while generating paths
+  	if (config.debugLevel >= DL_VERBOSE) {
   		std::cerr << "\n\nSCARA: paths after processing:";
   	}
-  	for (auto const& path_ptr : vPaths) {
-  		shared_ptr<Edge> firstEdge = path_ptr->edges[0];
-  		Direction dir = D_LEFT;
-        if (firstEdge->QES2 > firstEdge->QES1) dir = D_RIGHT;
-        shared_ptr<PathInfo> pathinfo_ptr;
-        if (dir == D_RIGHT) pathinfo_ptr = make_shared<PathInfo>(path_ptr);
-        else {
-        	shared_ptr<Path> revPath = path_ptr->reversedPath();
-        	pathinfo_ptr = make_shared<PathInfo>(revPath);
-        }
+  	for (uint32_t i = 0; i < pathAggregator.vPaths.size(); i++) {
+  		shared_ptr<PathInfo> pathinfo_ptr = pathAggregator.groupPath(pathAggregator.vPaths[i], pathAggregator.vPathCounts[i]);
 
   		vPathInfos.emplace_back(pathinfo_ptr);
-  		if (scara::globalDebugLevel >= DL_VERBOSE) {
+  		if (config.debugLevel >= DL_VERBOSE) {
   			std::cerr << "\nPATHINFO: SNODE(" << pathinfo_ptr->startNodeName << "), ";
   			std::cerr << "ENODE(" << pathinfo_ptr->endNodeName << "), ";
  			std::cerr << "DIRECTION(" << Direction2String(pathinfo_ptr->pathDir) << "), ";
@@ -313,29 +648,16 @@ namespace scara {
   			std::cerr << "BASES(" << pathinfo_ptr->length << "), ";
   			std::cerr << "BASES2(" << pathinfo_ptr->length2 << "), ";
   			std::cerr << "AVG SI(" << pathinfo_ptr->avgSI << "), ";
+  			std::cerr << "COUNT(" << pathinfo_ptr->multiplicity << "), ";
   			std::cerr << "CONSISTENT(" << checkPath(pathinfo_ptr->path_ptr) << ")";
   		}
-
-  		// Grouping the path
-  		bool grouped = false;
-  		for (auto const& pgroup_ptr : tempPathGroups) {
-  			if (pgroup_ptr->addPathInfo(pathinfo_ptr)) {
-  				grouped = true;
-  				break;
-  			}
-  		}
-
-  		if (!grouped) {
-  			numGroups += 1;
-  			shared_ptr<PathGroup> pgroup_ptr = make_shared<PathGroup>(pathinfo_ptr);
-  			tempPathGroups.emplace_back(pgroup_ptr);
-  		}
   	}
+  	std::vector<shared_ptr<PathGroup>> &tempPathGroups = pathAggregator.vPathGroups;
 
-  	if (scara::globalDebugLevel >= DL_INFO) std::cerr << "\n\nSCARA: Discarding groups with less than :" << scara::MinPathsinGroup << " paths!";
+  	if (config.debugLevel >= DL_INFO) std::cerr << "\n\nSCARA: Discarding groups with less than :" << config.MinPathsinGroup << " paths!";
   	for (auto const& pgroup_ptr : tempPathGroups) {
-  		if (pgroup_ptr->numPaths < scara::MinPathsinGroup) {
-  			if (scara::globalDebugLevel >= DL_VERBOSE) {
+  		if (pgroup_ptr->numPaths < config.MinPathsinGroup) {
+  			if (config.debugLevel >= DL_VERBOSE) {
   				std::cerr << "\nSCARA: Discarding PATHGROUP: SNODE(" << pgroup_ptr->startNodeName << "), ";
 	  			std::cerr << "ENODE(" << pgroup_ptr->endNodeName << "), ";
 	  			std::cerr << "BASES(" << pgroup_ptr->length << "), ";
@@ -346,7 +668,7 @@ namespace scara {
   	}
 
 
-  	if (scara::globalDebugLevel >= DL_VERBOSE) {
+  	if (config.debugLevel >= DL_VERBOSE) {
   		std::cerr << "\n\nSCARA: Groups before processing:";
 	  	for (auto const& pgroup_ptr : vPathGroups) {
 	  		std::cerr << "\nPATHGROUP: SNODE(" << pgroup_ptr->startNodeName << "), ";
@@ -486,7 +808,7 @@ namespace scara {
 
 	}
 
-	if (scara::globalDebugLevel >= DL_VERBOSE) {
+	if (config.debugLevel >= DL_VERBOSE) {
   		std::cerr << "\n\nSCARA: Initial scaffolds:";
   		int i= 0;
 	  	for (auto const& vec_ptr : scaffolds_temp) {
@@ -501,29 +823,37 @@ namespace scara {
 	// Eliminating duplicate scaffolds
 	// Since two nodes were generated for each contig and read (FW and RC), and two edges for each overlap
 	// there should be two identical scaffolds, one on FW and the other on RC strand
-	// Drop one of them
+	// Each scaffold is reduced to an orientation independent fingerprint, so that both copies hash to the same value
+	// Of the two, the one supported by more paths is kept
 
-	std::cerr << "\n\nSCARA: Eliminating duplicate scaffolds:";
-	std::cerr << "\n......";
+	if (config.debugLevel >= DL_INFO) {
+		std::cerr << "\n\nSCARA: Eliminating duplicate scaffolds:";
+		std::cerr << "\n......";
+	}
+	std::unordered_map<uint64_t, std::vector<uint32_t>> mFingerprints;		// Fingerprint -> indices in scaffolds_filtered
 	for (auto const& vec_ptr : scaffolds_temp) {
+		uint64_t fingerprint = scaffoldFingerprint(vec_ptr);
+		std::vector<uint32_t> &indices = mFingerprints[fingerprint];
 		bool found = false;
-		for (auto const& vec_ptr2 : scaffolds_filtered) {
-			found = scaffoldsEqual(vec_ptr, vec_ptr2);
-			if (found) {
+		for (auto const& idx : indices) {
+			// Fingerprints can collide, so equal scaffolds are confirmed by comparing node names
+			if (scaffoldsEqual(vec_ptr, scaffolds_filtered[idx])) {
+				found = true;
+				// If equivalent scaffold already exists, keep the one with more paths
+				if (scaffoldNumPaths(vec_ptr) > scaffoldNumPaths(scaffolds_filtered[idx])) {
+					scaffolds_filtered[idx] = vec_ptr;
+				}
 				break;
 			}
 		}
-		if (found) {
-		// If equivalent scaffold already exists in the list of final scaffolds, jusr skip this one
-		// TODO: check which one is better and use that one
-		}
-		else {
+		if (!found) {
+			indices.emplace_back(scaffolds_filtered.size());
 			scaffolds_filtered.emplace_back(vec_ptr);
 		}
 
 	}
 
-	if (scara::globalDebugLevel >= DL_VERBOSE) {
+	if (config.debugLevel >= DL_VERBOSE) {
   		std::cerr << "\n\nSCARA: Final scaffolds before sequence generation:";
   		int i= 0;
 	  	for (auto const& vec_ptr : scaffolds_filtered) {
@@ -541,15 +871,7 @@ namespace scara {
 	for (auto const&  vec_ptr: scaffolds_filtered) {
 		auto newVec = make_shared<std::vector<shared_ptr<PathInfo>>>();
 		for (auto const& pgroup_ptr : (*vec_ptr)) {
-			auto best_pinfo_ptr = pgroup_ptr->vPathInfos[0];
-	  		auto best_avgSI = best_pinfo_ptr->avgSI;
-	  		for (auto const& pinfo_ptr : pgroup_ptr->vPathInfos) {		// KK: looking at the first element again, lazy to write it better
-				if (pinfo_ptr->avgSI > best_avgSI) {
-					best_avgSI = pinfo_ptr->avgSI;
-					best_pinfo_ptr = pinfo_ptr;
-				}
-			}
-			newVec->emplace_back(best_pinfo_ptr);
+			newVec->emplace_back(pgroup_ptr->bestPathInfo);
 		}
 		scaffolds.emplace_back(newVec);
 	}
@@ -565,46 +887,153 @@ namespace scara {
    * 2. Itterate over paths and generate sequence for each path
    *	Take care to use each contig only once (since they are present twice, except for the first and last one)
    */
-  int SBridger::generateSequences(void) {
-  	int i = 0;
-  	std::set<std::string> usedContigs;
-  	for (auto const&  vec_ptr: scaffolds) {
-  		// bool fistContigUsed = false;
-  		i++;
-  		// Generate header and calculate scaffold length
-  		std::string header = ">Scaffold_" + to_string(i);
-  		if (scara::globalDebugLevel >= DL_INFO) {
-	  		cerr << "\nSCARA: Generating sequence and header for scaffold " << i << endl;
-	  		cerr << "SCARA: scaffold edges: ";
+  // Adds a sequence span to the scaffold, only spans that can not be written from the mapped input are copied
+  void SBridger::appendScaffoldPart(ScaffoldSequence &scaffSeq, const Sequence &seq, uint32_t start, uint32_t length, bool reverseComplement) {
+  	if (scaffSeq.writer != NULL) {
+  		if (!reverseComplement) {
+  			scaffSeq.writer->writeMappedSequence(seq, start, length);
+  		} else {
+  			scaffSeq.writer->writeReverseComplement(seq, start, length);
   		}
+  		return;
+  	}
+  	if (!reverseComplement && seq.seq_mapData != NULL && length >= SequenceWriter::MinExternalSpan) {
+  		scaffSeq.parts.push_back({&seq, start, length});
+  		return;
+  	}
+
+  	size_t pos = scaffSeq.buffer.length();
+  	scaffSeq.buffer.resize(pos + length);
+  	if (!reverseComplement) {
+  		seq.copyTo(start, length, &scaffSeq.buffer[pos]);
+  	} else {
+  		seq.copyReverseComplementTo(start, length, &scaffSeq.buffer[pos]);
+  	}
+  	// Consecutive buffer parts are merged
+  	if (!scaffSeq.parts.empty() && scaffSeq.parts.back().seq_ptr == NULL) {
+  		scaffSeq.parts.back().length += length;
+  	} else {
+  		scaffSeq.parts.push_back({NULL, (uint32_t)pos, length});
+  	}
+  }
 
-  		uint32_t slength = 0;
-		uint32_t lastNodeLength = 0;
-		uint32_t numNodes = 1;
-  		for (auto const& pinfo_ptr : (*vec_ptr)) {
-  			header += ' ' + pinfo_ptr->path_ptr->edges.front()->getStartNodeName();
-  			slength += pinfo_ptr->length;
-  			// Remove the length of the endNode (as not to be added twice)
-  			auto lastEdge = pinfo_ptr->path_ptr->edges.back();
-  			lastNodeLength = lastEdge->ELen;
-  			slength -= lastNodeLength;
-  			numNodes += pinfo_ptr->path_ptr->edges.size();
-
-  			cerr << pinfo_ptr->path_ptr->edges.size() << " (" << pinfo_ptr->length << ") ";
+  void SBridger::writeScaffold(SequenceWriter &writer, const ScaffoldSequence &scaffSeq) {
+  	writer.writeHeader(scaffSeq.header);
+  	for (auto const& part : scaffSeq.parts) {
+  		if (part.seq_ptr == NULL) {
+  			writer.writeSequence(scaffSeq.buffer.data() + part.start, part.length);
+  		} else {
+  			writer.writeMappedSequence(*(part.seq_ptr), part.start, part.length);
   		}
-  		header += ' ' + vec_ptr->back()->path_ptr->edges.back()->getEndNodeName();		// Add the last endNode
-  		slength += lastNodeLength;		// For the last path, add the endNode length
+  	}
+  	writer.endSequence();
+  }
 
-  		// Output the scaffold header to cout!
-  		if (scara::globalDebugLevel >= DL_INFO) cerr << "\nSCARA generated header " << header << endl;
-  		cout << header << endl;
+  /* KK:
+   * Assembles the header and the sequence of a single scaffold into independent buffers, or writes them
+   * directly to the writer set in scaffSeq. Progress messages are collected in scaffSeq, not printed.
+   * Only reads the graph and the paths, so it can be called for different scaffolds in parallel
+   */
+  void SBridger::assembleScaffold(uint32_t scaffIdx, ScaffoldSequence &scaffSeq) {
+  	auto const& vec_ptr = scaffolds[scaffIdx];
+  	std::string &header = scaffSeq.header;
+  	std::ostringstream log;
+  	// Generate header and calculate scaffold length
+  	header = ">Scaffold_" + to_string(scaffIdx + 1);
+  	if (config.debugLevel >= DL_INFO) {
+  		log << "\nSCARA: Generating sequence and header for scaffold " << scaffIdx + 1 << endl;
+  	}
 
-  		if (scara::globalDebugLevel >= DL_INFO) 
-  			cerr << "SCARA generating sequence of length " << slength << " from " << numNodes << " nodes!" << endl;
+  	uint32_t slength = 0;
+	uint32_t lastNodeLength = 0;
+	uint32_t numNodes = 1;
+  	for (auto const& pinfo_ptr : (*vec_ptr)) {
+  		shared_ptr<Path> path_ptr = pinfo_ptr->path_ptr;
+  		header += ' ' + path_ptr->startNode()->nName;
+  		slength += pinfo_ptr->length;
+  		// Remove the length of the endNode (as not to be added twice)
+  		lastNodeLength = path_ptr->edgeAt(path_ptr->size() - 1).ELen();
+  		slength -= lastNodeLength;
+  		numNodes += path_ptr->size();
+  	}
+  	header += ' ' + vec_ptr->back()->path_ptr->endNode()->nName;		// Add the last endNode
+  	slength += lastNodeLength;		// For the last path, add the endNode length
 
-  		// Calculate scaffold sequence from scaffoldPath and output it to cout
-  		// NOTE: Assuming direction RIGHT!
-  		std::shared_ptr<Node> lastEndNode = NULL;
+  	if (config.debugLevel >= DL_INFO) {
+  		log << "SCARA generated header " << header << endl;
+  		log << "SCARA generating sequence of length " << slength << " from " << numNodes << " nodes!" << endl;
+  	}
+
+  	// Calculate scaffold sequence from scaffoldPath
+  	// NOTE: Assuming direction RIGHT!
+  	scaffSeq.buffer.clear();
+  	scaffSeq.parts.clear();
+  	if (scaffSeq.writer != NULL) scaffSeq.writer->writeHeader(header);
+  	std::shared_ptr<Node> lastEndNode = NULL;
+	for (auto const& pinfo_ptr : (*vec_ptr)) {
+		// Reversed paths are resolved here, edges are viewed in path direction
+		shared_ptr<Path> path_ptr = pinfo_ptr->path_ptr;
+		for (uint32_t e = 0; e < (uint32_t)(path_ptr->size()); e++) {
+			EdgeView edge = path_ptr->edgeAt(e);
+  			// Determine part of the startNode that will be put into the final sequence
+  			shared_ptr<Node> startNode = edge.startNode();
+  			uint32_t seq_part_start, seq_part_end, seq_part_size;
+  			
+			seq_part_start = 0;
+			seq_part_end = edge.SStart() - edge.EStart();	  			
+  			seq_part_size = seq_part_end - seq_part_start;
+  			if (seq_part_size <= 0) {
+  				throw std::runtime_error(std::string("SCARA BRIDGER: ERROR - invalid sequence part size: "));
+  			}
+  			if (config.debugLevel >= DL_DEBUG) {
+	  			log << "SCARA BRIDGER: Printing node " << startNode->nName << " with length " << seq_part_size << " - ";
+	  			log << seq_part_size << "/" << startNode->seq_ptr->length();
+	  			log << endl;
+  			}
+
+  			// localStrand = strand;
+  			const Sequence &seq = *(startNode->seq_ptr);
+  			if (!(startNode->isReverseComplement)) {
+  				// Relevant part of the string
+  				appendScaffoldPart(scaffSeq, seq, seq_part_start, seq_part_size, false);
+  			} else {
+  				// If the strand is reverse, reverse complement the same part counting from the end of the string
+  				uint32_t seq_end = seq.length();
+  				appendScaffoldPart(scaffSeq, seq, seq_end - seq_part_start - seq_part_size, seq_part_size, true);
+  			}
+
+  			// Setting the endNode of the previous path for the next iteration
+  			lastEndNode = edge.endNode();
+  		}
+	}
+
+  	if (config.debugLevel >= DL_DEBUG) {
+  		log << "SCARA BRIDGER: Printing node " << lastEndNode->nName << " with length ";
+  		log << lastEndNode->seq_ptr->length() << "/" << lastEndNode->seq_ptr->length();
+  		log << endl;
+  	}
+  	
+  	const Sequence &last_seq = *(lastEndNode->seq_ptr);
+  	appendScaffoldPart(scaffSeq, last_seq, 0, last_seq.length(), lastEndNode->isReverseComplement);
+  	if (scaffSeq.writer != NULL) scaffSeq.writer->endSequence();
+  	scaffSeq.messages = log.str();
+  }
+
+  /* KK:
+   * Scaffolds are assembled by worker threads into independent buffers (when using multithreading)
+   * and written to the output in scaffold order. The number of scaffolds in flight is bounded,
+   * a scaffold is written as soon as all scaffolds before it have been written.
+   * Without worker threads scaffolds are written directly to the output, without buffering.
+   */
+  int SBridger::generateSequences(void) {
+  	// Output goes to the file set with -O, or to the standard output
+  	return generateSequences(config.outputFile, config.numThreads());
+  }
+
+  int SBridger::generateSequences(const std::string& strOutput, uint32_t numThreads) {
+  	SequenceWriter writer(strOutput, config.FastaLineWidth);
+  	std::set<std::string> usedContigs;
+  	for (auto const&  vec_ptr: scaffolds) {
 		for (auto const& pinfo_ptr : (*vec_ptr)) {
 			std::string startNodeName = pinfo_ptr->startNodeName;
 			std::string endNodeName = pinfo_ptr->endNodeName;
@@ -613,66 +1042,48 @@ namespace scara {
 			usedContigs.emplace(endNodeName);
 			usedContigs.emplace(getRCNodeName(endNodeName));
 			// TODO: Check if any of the contigs were used more than once
-			for (auto const& edge_ptr: pinfo_ptr->path_ptr->edges) {
-	  			// Determine part of the startNode that will be put into the final sequence
-	  			shared_ptr<Node> startNode = edge_ptr->startNode;
-	  			uint32_t seq_part_start, seq_part_end, seq_part_size;
-	  			std::string seq_part = "";
-	  			
-  				seq_part_start = 0;
-  				seq_part_end = edge_ptr->SStart - edge_ptr->EStart;	  			
-	  			seq_part_size = seq_part_end - seq_part_start;
-	  			if (seq_part_size <= 0) {
-	  				throw std::runtime_error(std::string("SCARA BRIDGER: ERROR - invalid sequence part size: "));
-	  			}
-	  			seq_part.reserve(seq_part_size + 10);		// adding 10 just to avoid missing something by 1
-
-	  			// localStrand = strand;
-	  			if (!(startNode->isReverseComplement)) {
-	  				// Copy relevant part of the string
-	  				uint32_t k=0;
-	  				for (; k<seq_part_size; k++) {
-	  					seq_part += (startNode->seq_ptr->seq_strData)[seq_part_start+k];
-	  				}
-	  				// seq_part[k] = '\0';
-	  			} else {
-	  				// If the strand is reverse, go from the end of the string and rev
-	  				uint32_t k=0;
-	  				for (; k<seq_part_size; k++) {
-	  					uint32_t seq_end = (startNode->seq_ptr->seq_strData).length();
-	  					seq_part += _bioBaseComplement((startNode->seq_ptr->seq_strData)[seq_end-seq_part_start-k-1]);
-	  				}
-	  				// seq_part[k] = '\0';
-	  			}
-
-	  			// Output the sequence part to the standard output
-	  			if (scara::globalDebugLevel >= DL_DEBUG) {
-		  			cerr << "SCARA BRIDGER: Printing node " << startNode->nName << " with length " << seq_part_size << " - ";
-		  			cerr << seq_part.length() << "/" << startNode->seq_ptr->seq_strData.length();
-		  			cerr << endl;
-	  			}
-	  			cout << seq_part;
-
-	  			// Setting the endNode of the previous path for the next iteration
-	  			lastEndNode = edge_ptr->endNode;
-	  		}
-  		}
+		}
+  	}
 
-  		// auto lastEndNode = scaffoldPath.edges.back()->endNode;
-  		if (scara::globalDebugLevel >= DL_DEBUG) {
-  			cerr << "SCARA BRIDGER: Printing node " << lastEndNode->nName << " with length ";
-  			cerr << lastEndNode->seq_ptr->seq_strData.length() << "/" << lastEndNode->seq_ptr->seq_strData.length();
-  			cerr << endl;
+  	uint32_t numScaffolds = scaffolds.size();
+  	if (numThreads < 2 || numScaffolds < 2) {
+  		ScaffoldSequence scaffSeq;
+  		scaffSeq.writer = &writer;
+  		for (uint32_t i = 0; i < numScaffolds; i++) {
+  			assembleScaffold(i, scaffSeq);
+  			cerr << scaffSeq.messages;
   		}
-  		
-  		if (!(lastEndNode->isReverseComplement)) {
-  			cout << lastEndNode->seq_ptr->seq_strData << endl;
-  		} else {
-  			cout << _bioReverseComplement(lastEndNode->seq_ptr->seq_strData) << endl;
-  		} 
+  	} else {
+  		numThreads = std::min(numThreads, numScaffolds);
+  		uint32_t window = 2 * numThreads;
+  		if (config.debugLevel >= DL_INFO) {
+  			cerr << "SCARA BRIDGER: Generating " << numScaffolds << " scaffolds using " << numThreads << " threads" << endl;
+  		}
+  		auto assemble = [this](uint32_t scaffIdx) {
+  			ScaffoldSequence scaffSeq;
+  			assembleScaffold(scaffIdx, scaffSeq);
+  			return scaffSeq;
+  		};
+
+  		// Messages of worker threads are printed here, together with the scaffold, so they are not interleaved
+  		auto writeOldest = [this, &writer](std::deque<std::future<ScaffoldSequence>>& inFlight) {
+  			ScaffoldSequence scaffSeq = inFlight.front().get();
+  			inFlight.pop_front();
+  			cerr << scaffSeq.messages;
+  			writeScaffold(writer, scaffSeq);
+  		};
+
+  		std::unique_ptr<thread_pool::ThreadPool> threadPool = thread_pool::createThreadPool(numThreads);
+  		std::deque<std::future<ScaffoldSequence>> inFlight;
+  		for (uint32_t i = 0; i < numScaffolds; i++) {
+  			// Wait for the oldest scaffold, when the window is full
+  			if (inFlight.size() >= window) writeOldest(inFlight);
+  			inFlight.emplace_back(threadPool->submit(assemble, i));
+  		}
+  		while (!inFlight.empty()) writeOldest(inFlight);
   	}
 
-  	if (scara::globalDebugLevel >= DL_INFO) {
+  	if (config.debugLevel >= DL_INFO) {
   		cerr << "\nSCARA BRIDGER: Used contigs: ";
 	  	for (auto const& usedContig : usedContigs) {
 	  		cerr << usedContig + ", ";
@@ -680,17 +1091,21 @@ namespace scara {
   		cerr << endl;
   	}
 
-  	cerr << "SCARA BRIDGER: Printing sequences for unsued contigs! There are " << (mAnchorNodes.size() - usedContigs.size());
-  	cerr << " potentially unused contigs!" << endl;
+  	if (config.debugLevel >= DL_INFO) {
+  		cerr << "SCARA BRIDGER: Printing sequences for unsued contigs! There are " << (mAnchorNodes.size() - usedContigs.size());
+  		cerr << " potentially unused contigs!" << endl;
+  	}
 	for (auto const& aNodePair : mAnchorNodes) {
 		auto aNode = aNodePair.second;
 		std::string nodeNameOG = getOGNodeName(aNode->nName);
 		// Print only original unused contigs, and not RC ones that were generated 
 		if ((aNode->nName == nodeNameOG) && (usedContigs.find(aNode->nName) == usedContigs.end())) {
-			cout << ">" << aNode->nName << endl;
-			cout << aNode->seq_ptr->seq_strData << endl;
+			writer.writeHeader(">" + aNode->nName);
+			writer.writeMappedSequence(*(aNode->seq_ptr), 0, aNode->seq_ptr->length());
+			writer.endSequence();
 		}
 	}
+	writer.flush();
 
 
    	return scaffolds.size();
@@ -717,6 +1132,32 @@ namespace scara {
   	}
   }
 
+  // Calculate an orientation independent fingerprint for a scaffold
+  // Scaffold is represented by a sequence of its nodes, the fingerprint is the smaller of the hashes
+  // of that sequence and of its reverse complement (reversed order, each node on the other strand)
+  uint64_t SBridger::scaffoldFingerprint(shared_ptr<std::vector<shared_ptr<PathGroup>>> scaff) {
+  	uint64_t hashFW = 0, hashRC = 0;
+  	const uint64_t mult = 0x100000001B3ULL;
+  	uint32_t size = scaff->size();
+  	for (uint32_t i=0; i<size; i++) {
+  		hashFW = hashFW * mult + nodeNameHash((*scaff)[i]->startNodeName, false);
+  		hashRC = hashRC * mult + nodeNameHash((*scaff)[size-1-i]->endNodeName, true);
+  	}
+  	if (size > 0) {
+  		hashFW = hashFW * mult + nodeNameHash(scaff->back()->endNodeName, false);
+  		hashRC = hashRC * mult + nodeNameHash(scaff->front()->startNodeName, true);
+  	}
+
+  	return (hashFW < hashRC) ? hashFW : hashRC;
+  }
+
+  // Total number of paths supporting a scaffold
+  uint32_t SBridger::scaffoldNumPaths(shared_ptr<std::vector<shared_ptr<PathGroup>>> scaff) {
+  	uint32_t numPaths = 0;
+  	for (auto const& pgroup_ptr : (*scaff)) numPaths += pgroup_ptr->numPaths;
+  	return numPaths;
+  }
+
   // Check if two scaffolds are equivalent
   // First scaffold is checked from the start to the end
   // Second scaffold is checked from the end to the start
@@ -2,6 +2,8 @@
 #include "Graph.h"
 #include "Overlap.h"
 #include "Loader.h"
+#include "Sequence.h"
+#include "Writer.h"
 #include <string>
 #include <fstream>
 
@@ -9,13 +11,37 @@ namespace scara {
 
 	using namespace std;
 
+	std::string CheckpointPhase2String(CheckpointPhase phase);
+
+	/* KK:
+	 * Grid of parameter values for a parameter sweep, each combination of values is one setting
+	 * Settings with the same SImin and OHmax share the graph and the generated paths
+	 */
+	struct ParameterSweep {
+		std::vector<float> vSImin;
+		std::vector<float> vOHmax;
+		std::vector<uint32_t> vMinPathsinGroup;
+		std::vector<double> vPathGroupHalfSize;
+	};
+
+	// Parses a sweep grid given as "pSImin=0.5,0.6;pMinPathsInGroup=2,3", returns false if the grid is invalid
+	// Parameters that are not given keep their single value (ParameterSweep.cpp)
+	extern bool parseSweepGrid(const std::string& strGrid, ParameterSweep& sweep);
+
 	class SBridger {
 	private:
+		// Parameters of this bridger, there is no global state, so bridgers can run concurrently
+		ScaraConfig config;
+
 		VecOvl vOvlR2C;
 	  	VecOvl vOvlR2R;
 	  	MapIdToSeq mIdToContig;
 	  	MapIdToSeq mIdToRead;
 
+	  	// Overlap files, kept for parsing them during graph construction (PipelineGraph), empty for in-memory input
+	  	string strR2Cpaf;
+	  	string strR2Rpaf;
+
 	  	// Statistical information
 	  	uint32_t numANodes;
 	  	uint32_t numRNodes;
@@ -30,8 +56,8 @@ namespace scara {
 	  	uint32_t isolatedANodes = 0;
 	  	uint32_t isolatedRNodes = 0;
 
-	  	// Paths generated through the graph
-	  	std::vector<shared_ptr<Path>> vPaths;
+	  	// Paths generated through the graph, grouped either during or after path generation
+	  	PathAggregator pathAggregator;
 
 	  	// Path info vector, for faster analysis
 	  	std::vector<shared_ptr<PathInfo>> vPathInfos;
@@ -49,7 +75,17 @@ namespace scara {
 		MapIdToNode mReadNodes;
 		// std::vector<shared_ptr<Edge>> vEdges;
 
-		SBridger(const string& strReadsFasta, const string& strContigsFasta, const string& strR2Cpaf, const string& strR2Rpaf);
+		SBridger(const ScaraConfig& t_config, const string& strReadsFasta, const string& strContigsFasta, const string& strR2Cpaf, const string& strR2Rpaf);
+
+		// Bridger for sequences and overlaps already in memory, e.g. when scara is used as a library
+		// Overlaps are moved into the bridger, graph construction from overlap files (PipelineGraph) is not used
+		SBridger(const ScaraConfig& t_config, MapIdToSeq t_mIdToRead, MapIdToSeq t_mIdToContig, VecOvl&& t_vOvlR2C, VecOvl&& t_vOvlR2R);
+
+		// Copies the bridger after graph construction, nodes, edges and paths are shared with the original
+		// Overlaps are not copied, they are only used for graph construction
+		SBridger(const SBridger& other);
+
+	  	const ScaraConfig& getConfig(void) const { return config; }
 
 	  	void Initialize(const string& strReadsFasta, const string& strContigsFasta, const string& strR2Cpaf, const string& strR2CRaf);
 
@@ -70,17 +106,71 @@ namespace scara {
 	  	int groupAndProcessPaths(void);
 
 	  	int generateSequences(void);
+	  	int generateSequences(const std::string& strOutput, uint32_t numThreads);
+
+	  	void setGroupingParameters(uint32_t t_minPathsInGroup, double t_pathGroupHalfSize);
+
+	  	// Generates paths and scaffolds for each connected component of the graph independently (GraphPartition.cpp)
+	  	// Replaces generatePaths and groupAndProcessPaths, edges are freed as components are finished
+	  	// MinMCPaths and MaxMCIterations apply to each component, not to the whole graph
+	  	int processComponents(void);
+
+	  	// Runs all settings of the parameter sweep, writing scaffolds and a summary into strDir (ParameterSweep.cpp)
+	  	int runSweep(const ParameterSweep& sweep, const std::string& strDir);
 
 	  	void Execute(void);
 
 	  	void printState();
 
+	  	// Phase checkpoints, stored in the checkpoint directory (Checkpoint.cpp)
+	  	void saveCheckpoint(CheckpointPhase phase);
+	  	CheckpointPhase resumeFromCheckpoint(CheckpointPhase phase);
+
 	private:
+		// Bridger for a single connected component, sharing nodes with the whole graph (GraphPartition.cpp)
+		SBridger(const ScaraConfig& t_config, MapIdToNode&& t_mAnchorNodes);
+
 		shared_ptr<PathInfo> getBestPath_AvgSI();
 
 		void printOvlToStream(VecOvl &vOvl, ofstream& outStream);
 		void printNodeToStream(MapIdToNode &map, ofstream& outStream);
 
+		void addEdgeCounts(const EdgeTestCounts &counts);
+		void attachEdges(std::vector<shared_ptr<Edge>> &vEdges, const EdgeTestCounts &counts);
+		void generateEdgesPipelined(void);
+		void generateEdgesParallel(void);
+
+		void createNodes(void);
+		void countIsolatedNodes(void);
+		void loadCheckpoint(CheckpointPhase phase);
+		void saveGraphIndex(const std::string& strIndex);
+		void loadGraphIndex(const std::string& strIndex);
+
+		/* KK:
+		 * Scaffold sequence ready for output. Sequence parts are either materialized in the buffer
+		 * (read fragments and reverse complemented spans), or refer to forward spans of mapped sequences
+		 */
+		struct ScaffoldPart {
+			const Sequence* seq_ptr;	// NULL if the part is in the buffer
+			uint32_t start;
+			uint32_t length;
+		};
+		struct ScaffoldSequence {
+			std::string header;
+			std::string buffer;
+			std::vector<ScaffoldPart> parts;
+			// If set, the scaffold is written directly to the writer while it is assembled, nothing is buffered
+			SequenceWriter* writer = NULL;
+			// Progress messages, printed by the thread writing the scaffold
+			std::string messages;
+		};
+
+		void assembleScaffold(uint32_t scaffIdx, ScaffoldSequence &scaffSeq);
+		void appendScaffoldPart(ScaffoldSequence &scaffSeq, const Sequence &seq, uint32_t start, uint32_t length, bool reverseComplement);
+		void writeScaffold(SequenceWriter &writer, const ScaffoldSequence &scaffSeq);
+
+		uint64_t scaffoldFingerprint(shared_ptr<std::vector<shared_ptr<PathGroup>>> scaff);
+		uint32_t scaffoldNumPaths(shared_ptr<std::vector<shared_ptr<PathGroup>>> scaff);
 		bool scaffoldsEqual(shared_ptr<std::vector<shared_ptr<PathGroup>>> scaff1, shared_ptr<std::vector<shared_ptr<PathGroup>>> scaff2);
 		// int compareScaffolds(shared_ptr<std::vector<shared_ptr<PathGroup>>> scaff1, shared_ptr<std::vector<shared_ptr<PathGroup>>> scaff2);
 	};
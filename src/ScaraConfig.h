@@ -0,0 +1,107 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <thread>
+#include <algorithm>
+
+namespace scara {
+
+	enum DebugLevel {
+	    DL_NONE = 0,
+	    DL_INFO = 1 << 0,
+	    DL_VERBOSE = 1 << 1,
+	    DL_DEBUG = 1 << 2,
+	  };
+
+	// Phases after which a checkpoint is written, in the order of execution
+	enum CheckpointPhase {
+	    CP_NONE = 0,
+	    CP_GRAPH = 1,
+	    CP_PATHS = 2,
+	    CP_SCAFFOLDS = 3,
+	  };
+
+	/* KK:
+	 * Parameters of a single scaffolding run, each SBridger keeps its own copy
+	 * There is no global state, so several bridgers with different parameters can run in the same process
+	 * Default values are the defaults of the scara executable
+	 */
+	struct ScaraConfig {
+		// Not using multithreading unless specified in the parameters
+		int multithreading = 0;
+		// Number of worker threads used when multithreading, defaults to the number of hardware threads
+		uint32_t NumThreads = std::max(1u, std::thread::hardware_concurrency());
+
+		// A minimum number of paths generated by Monte Carlo method
+		uint32_t MinMCPaths = 40;
+		// A maximum number of nodes that a path can contain, longer paths will not be generated
+		uint32_t HardNodeLimit = 1000;
+		// A number of nodes in a path that will cause a warning to be displayed
+		uint32_t SoftNodeLimit = 100;
+		// A maximum length of a path in bases, longer paths are pruned during DFS (0 - no limit)
+		uint32_t MaxPathLength = 0;
+
+		// A number of nodes added to the stack in each step of DFS graph traversal
+		uint32_t NumDFSNodes = 5;
+		// Maximum number of iterations using Monte Carlo approach
+		uint32_t MaxMCIterations = 100000;
+
+		// A minimum number of paths in a group that will generate a scaffold
+		uint32_t MinPathsinGroup = 3;
+		// A path is placed in a group if its length falls within PathGroupHalfSize of groups representative length
+		double PathGroupHalfSize = 5000;
+
+		// Minimum sequence identity for filtering overlaps
+		float SImin = 0.60f;
+		// Maximum allowed overhang percentage for filtering overlaps
+		float OHmax = 0.25f;
+
+		bool test_short_length = true;
+		bool test_contained_reads = true;
+		bool test_low_quality = true;
+
+		// Determines if more verbose messages are printed
+		bool print_output = true;
+		DebugLevel debugLevel = DL_INFO;
+
+		// Group paths as they are generated, storing only group representatives
+		bool StreamPaths = false;
+
+		// Store reads packed with 2 bits per base, decoded only when written to the output
+		bool PackReads = false;
+		// Keep only an index of reads in memory, read sequences are read from the reads file when writing the output
+		bool LazyReads = false;
+		// Load reads and contigs through a memory mapping, keeping sequences as views into the mapped files
+		bool MapSequences = false;
+		// Parse overlap files while graph edges are created, instead of loading them before graph construction
+		bool PipelineGraph = false;
+		// Generate paths and scaffolds separately for each connected component of the graph
+		bool PartitionGraph = false;
+
+		// Graph index file written after graph construction, not written if empty
+		std::string SaveGraphFile = "";
+		// Graph index file used instead of overlap files for graph construction, not used if empty
+		std::string LoadGraphFile = "";
+
+		// Directory for phase checkpoints, checkpoints are not written if empty
+		std::string CheckpointDir = "";
+		// Phase after which the run is resumed from checkpoints
+		CheckpointPhase ResumeFrom = CP_NONE;
+
+		// Directory for scaffolds and the summary of a parameter sweep
+		std::string SweepDir = "scara_sweep";
+
+		// Log file with the graph, not written if empty
+		std::string logFile = "";
+
+		// Output file for scaffolds, standard output if empty
+		std::string outputFile = "";
+		// Line width for output FASTA, 0 means that each sequence is written in a single line
+		uint32_t FastaLineWidth = 0;
+
+		// Number of threads used for parallel work
+		uint32_t numThreads(void) const { return multithreading ? NumThreads : 1; }
+	};
+
+}
@@ -1,23 +1,152 @@
 #include "Sequence.h"
+#include "InputFile.h"
 #include <string>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCARA_X86_KERNELS
+#include <immintrin.h>
+#endif
 
 namespace scara {
 
+  // Complements for letters, indexed by the lower 5 bits of the character ('A' = 1)
+  // IUPAC codes are complemented (including U -> A), 0 marks letters which are left unchanged
+  // As for ACGT, lowercase letters are complemented into uppercase
+  static const char letterComplement[32] = {
+    0,   'T', 'V', 'G', 'H', 0,   0,   'C', 'D', 0,   0,   'M', 0,   'K', 'N', 0,
+    0,   0,   'Y', 'S', 'A', 'A', 'B', 'W', 0,   'R', 0,   0,   0,   0,   0,   0
+  };
+
+  // Complement for each character
+  struct ComplementTable {
+    char table[256];
+
+    ComplementTable() {
+      for (int c = 0; c < 256; c++) {
+        table[c] = (char)c;
+        bool isLetter = ((c | 0x20) >= 'a' && (c | 0x20) <= 'z');
+        if (isLetter && letterComplement[c & 0x1F] != 0) table[c] = letterComplement[c & 0x1F];
+      }
+    }
+  };
+  static const ComplementTable complementTable;
+
   char _bioBaseComplement(char c) {
-    if ((c == 'A') || c == 'a') return 'T';
-    if ((c == 'T') || c == 't') return 'A';
-    if ((c == 'G') || c == 'g') return 'C';
-    if ((c == 'C') || c == 'c') return 'G';
+    return complementTable.table[(unsigned char)c];
+  }
+
+  void _bioReverseComplementScalar(const char* src, uint32_t len, char* dst) {
+    for (uint32_t i = 0; i < len; i++) {
+      dst[i] = complementTable.table[(unsigned char)src[len - i - 1]];
+    }
+  }
+
+#ifdef SCARA_X86_KERNELS
+  // Vectorized kernels complement letters using two byte shuffles over letterComplement (lower and upper half)
+  // Characters that are not letters, or are letters without a complement, are copied unchanged
+  // Blocks are loaded from the end of the source and reversed in registers
+  __attribute__((target("ssse3")))
+  static void _bioReverseComplementSSSE3(const char* src, uint32_t len, char* dst) {
+    const __m128i reverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    const __m128i tableLo = _mm_loadu_si128((const __m128i*)letterComplement);
+    const __m128i tableHi = _mm_loadu_si128((const __m128i*)(letterComplement + 16));
+    const __m128i mask1F = _mm_set1_epi8(0x1F);
+    const __m128i mask10 = _mm_set1_epi8(0x10);
+    const __m128i mask20 = _mm_set1_epi8(0x20);
+    const __m128i lowerA = _mm_set1_epi8('a');
+    const __m128i maxLetter = _mm_set1_epi8(25);
+    const __m128i zero = _mm_setzero_si128();
+
+    uint32_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+      __m128i c = _mm_loadu_si128((const __m128i*)(src + len - i - 16));
+      c = _mm_shuffle_epi8(c, reverse);
+
+      __m128i idx = _mm_and_si128(c, mask1F);
+      __m128i lo = _mm_shuffle_epi8(tableLo, idx);
+      __m128i hi = _mm_shuffle_epi8(tableHi, idx);
+      __m128i useHi = _mm_cmpeq_epi8(_mm_and_si128(idx, mask10), mask10);
+      __m128i comp = _mm_or_si128(_mm_and_si128(useHi, hi), _mm_andnot_si128(useHi, lo));
+
+      __m128i letter = _mm_sub_epi8(_mm_or_si128(c, mask20), lowerA);
+      __m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(letter, maxLetter), letter);
+      __m128i valid = _mm_andnot_si128(_mm_cmpeq_epi8(comp, zero), isLetter);
+
+      _mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_and_si128(valid, comp), _mm_andnot_si128(valid, c)));
+    }
+    _bioReverseComplementScalar(src, len - i, dst + i);
+  }
+
+  __attribute__((target("avx2")))
+  static void _bioReverseComplementAVX2(const char* src, uint32_t len, char* dst) {
+    const __m256i reverse = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                                             15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    const __m256i tableLo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)letterComplement));
+    const __m256i tableHi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(letterComplement + 16)));
+    const __m256i mask1F = _mm256_set1_epi8(0x1F);
+    const __m256i mask10 = _mm256_set1_epi8(0x10);
+    const __m256i mask20 = _mm256_set1_epi8(0x20);
+    const __m256i lowerA = _mm256_set1_epi8('a');
+    const __m256i maxLetter = _mm256_set1_epi8(25);
+    const __m256i zero = _mm256_setzero_si256();
+
+    uint32_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+      __m256i c = _mm256_loadu_si256((const __m256i*)(src + len - i - 32));
+      // Reverse bytes within each 128-bit lane, then swap the lanes
+      c = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(c, reverse), 0x4E);
 
-    return c;
+      __m256i idx = _mm256_and_si256(c, mask1F);
+      __m256i lo = _mm256_shuffle_epi8(tableLo, idx);
+      __m256i hi = _mm256_shuffle_epi8(tableHi, idx);
+      __m256i comp = _mm256_blendv_epi8(lo, hi, _mm256_cmpeq_epi8(_mm256_and_si256(idx, mask10), mask10));
+
+      __m256i letter = _mm256_sub_epi8(_mm256_or_si256(c, mask20), lowerA);
+      __m256i isLetter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, maxLetter), letter);
+      __m256i valid = _mm256_andnot_si256(_mm256_cmpeq_epi8(comp, zero), isLetter);
+
+      _mm256_storeu_si256((__m256i*)(dst + i), _mm256_blendv_epi8(c, comp, valid));
+    }
+    _bioReverseComplementSSSE3(src, len - i, dst + i);
+  }
+#endif
+
+  // Choose the fastest kernel supported by the CPU, done once
+  struct ReverseComplementKernel {
+    void (*kernel)(const char*, uint32_t, char*);
+    const char* name;
+
+    ReverseComplementKernel() : kernel(_bioReverseComplementScalar), name("scalar") {
+#ifdef SCARA_X86_KERNELS
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx2")) {
+        kernel = _bioReverseComplementAVX2;
+        name = "avx2";
+      }
+      else if (__builtin_cpu_supports("ssse3")) {
+        kernel = _bioReverseComplementSSSE3;
+        name = "ssse3";
+      }
+#endif
+    }
+  };
+  static const ReverseComplementKernel reverseComplementKernel;
+
+  void _bioReverseComplement(const char* src, uint32_t len, char* dst) {
+    reverseComplementKernel.kernel(src, len, dst);
+  }
+
+  const char* _bioReverseComplementKernelName(void) {
+    return reverseComplementKernel.name;
   }
 
   std::string _bioReverseComplement(const std::string& strData, uint32_t ulStart, uint32_t ulEnd)
   {
     std::string strRc(ulEnd - ulStart, 'x');
-    for(uint32_t ulPos = ulStart; ulPos < ulEnd; ulPos++) {
-      strRc[ulEnd - ulPos - 1] = _bioBaseComplement(strData[ulPos]);
-    }
+    _bioReverseComplement(strData.data() + ulStart, ulEnd - ulStart, &strRc[0]);
 
     return strRc;
   }
@@ -29,15 +158,177 @@ namespace scara {
 
   Sequence::Sequence(const char* name, uint32_t name_length,
     const char* sequence, uint32_t sequence_length
-  ) : seq_strName(name, name_length), seq_strData(sequence, sequence_length)
+  ) : seq_strName(name, name_length), seq_strData(sequence, sequence_length),
+    seq_lineWidth(0), seq_lineStride(0), seq_mapData(NULL), seq_lazyOffset(0), seq_mapView(false), seq_length(0),
+    seq_packed(false), seq_packedLength(0)
   {
   }
 
   Sequence::Sequence(const char* name, uint32_t name_length,
     const char* sequence, uint32_t sequence_length,
     const char* quality, uint32_t quality_length
-  ) : seq_strName(name, name_length), seq_strData(sequence, sequence_length) , seq_strQuality(quality, quality_length)
+  ) : seq_strName(name, name_length), seq_strData(sequence, sequence_length) , seq_strQuality(quality, quality_length),
+    seq_lineWidth(0), seq_lineStride(0), seq_mapData(NULL), seq_lazyOffset(0), seq_mapView(false), seq_length(0),
+    seq_packed(false), seq_packedLength(0)
+  {
+  }
+
+  Sequence::Sequence(const std::string& name, std::shared_ptr<InputFile> file, uint64_t offset, uint32_t length,
+    uint32_t lineWidth, uint32_t lineStride
+  ) : seq_strName(name), seq_lineWidth(lineWidth), seq_lineStride(lineStride), seq_mapData(NULL),
+    seq_lazyFile(file), seq_lazyOffset(offset), seq_mapView(false), seq_length(length), seq_packed(false), seq_packedLength(0)
   {
   }
 
+  Sequence::Sequence(const std::string& name, std::shared_ptr<MappedFile> file, const char* data, uint32_t length
+  ) : seq_strName(name), seq_lineWidth(0), seq_lineStride(0), seq_mapFile(file), seq_mapData(data),
+    seq_lazyOffset(0), seq_mapView(true), seq_length(length), seq_packed(false), seq_packedLength(0)
+  {
+  }
+
+  uint32_t Sequence::length(void) const {
+    if (seq_packed) return seq_packedLength;
+    if (seq_lazyFile != NULL || seq_mapView) return seq_length;
+    return seq_strData.length();
+  }
+
+  const char* Sequence::data(void) const {
+    if (seq_packed || seq_lazyFile != NULL) return NULL;
+    return seq_mapView ? seq_mapData : seq_strData.data();
+  }
+
+  // Reads bases of a lazy sequence from the input file, skipping line breaks
+  static void readLazySequence(const Sequence& seq, uint32_t start, uint32_t len, char* dst) {
+    if (len == 0) return;
+    if (seq.seq_lineWidth == 0) {
+      seq.seq_lazyFile->readAt(seq.seq_lazyOffset + start, len, dst);
+      return;
+    }
+    // Read the whole range of lines with a single read, then remove line breaks
+    uint32_t end = start + len;
+    uint64_t first = (uint64_t)(start / seq.seq_lineWidth) * seq.seq_lineStride + start % seq.seq_lineWidth;
+    uint64_t last = (uint64_t)((end - 1) / seq.seq_lineWidth) * seq.seq_lineStride + (end - 1) % seq.seq_lineWidth + 1;
+    std::vector<char> raw(last - first);
+    seq.seq_lazyFile->readAt(seq.seq_lazyOffset + first, raw.size(), raw.data());
+    uint32_t offset = start % seq.seq_lineWidth;
+    uint64_t pos = 0;
+    while (len > 0) {
+      uint32_t piece = std::min(len, seq.seq_lineWidth - offset);
+      memcpy(dst, raw.data() + pos, piece);
+      dst += piece;
+      len -= piece;
+      pos += piece + (seq.seq_lineStride - seq.seq_lineWidth);
+      offset = 0;
+    }
+  }
+
+  // Packed base codes for each character, 4 marks characters that are stored as exceptions
+  struct PackTable {
+    uint8_t code[256];
+    // Bases for each packed byte, forward and reverse complemented
+    char forward[256][4];
+    char reverse[256][4];
+
+    PackTable() {
+      const char bases[4] = {'A', 'C', 'G', 'T'};
+      memset(code, 4, sizeof(code));
+      for (uint8_t b = 0; b < 4; b++) code[(unsigned char)bases[b]] = b;
+      for (int byte = 0; byte < 256; byte++) {
+        for (int k = 0; k < 4; k++) {
+          forward[byte][k] = bases[(byte >> (2 * k)) & 3];
+          reverse[byte][3 - k] = bases[3 - ((byte >> (2 * k)) & 3)];
+        }
+      }
+    }
+  };
+  static const PackTable packTable;
+
+  void Sequence::pack(void) {
+    if (seq_packed || seq_lazyFile != NULL) return;
+    const char* bases = data();
+    seq_packedLength = length();
+    seq_packedData.assign((seq_packedLength + 3) / 4, 0);
+    seq_packedExceptions.clear();
+    for (uint32_t i = 0; i < seq_packedLength; i++) {
+      uint8_t code = packTable.code[(unsigned char)bases[i]];
+      if (code == 4) {
+        seq_packedExceptions.emplace_back(i, bases[i]);
+        code = 0;
+      }
+      seq_packedData[i >> 2] |= code << (2 * (i & 3));
+    }
+    seq_packedExceptions.shrink_to_fit();
+    std::string().swap(seq_strData);
+    seq_mapView = false;
+    seq_packed = true;
+  }
+
+  // First exception at or after pos, compared on the position only (exception characters can be negative)
+  static std::vector<std::pair<uint32_t, char>>::const_iterator firstException(const std::vector<std::pair<uint32_t, char>>& vExceptions, uint32_t pos) {
+    return std::lower_bound(vExceptions.begin(), vExceptions.end(), pos, [](const std::pair<uint32_t, char>& exception, uint32_t value) {
+      return exception.first < value;
+    });
+  }
+
+  void Sequence::copyTo(uint32_t start, uint32_t len, char* dst) const {
+    if (seq_lazyFile != NULL) {
+      readLazySequence(*this, start, len, dst);
+      return;
+    }
+    if (!seq_packed) {
+      memcpy(dst, data() + start, len);
+      return;
+    }
+
+    uint32_t i = 0;
+    // Bases before the first whole byte, then whole bytes, then the remaining bases
+    for (; i < len && ((start + i) & 3) != 0; i++) {
+      dst[i] = packTable.forward[seq_packedData[(start + i) >> 2]][(start + i) & 3];
+    }
+    for (; i + 4 <= len; i += 4) {
+      memcpy(dst + i, packTable.forward[seq_packedData[(start + i) >> 2]], 4);
+    }
+    for (; i < len; i++) {
+      dst[i] = packTable.forward[seq_packedData[(start + i) >> 2]][(start + i) & 3];
+    }
+
+    auto it = firstException(seq_packedExceptions, start);
+    for (; it != seq_packedExceptions.end() && it->first < start + len; ++it) {
+      dst[it->first - start] = it->second;
+    }
+  }
+
+  void Sequence::copyReverseComplementTo(uint32_t start, uint32_t len, char* dst) const {
+    if (seq_lazyFile != NULL) {
+      std::vector<char> fwd(len);
+      readLazySequence(*this, start, len, fwd.data());
+      _bioReverseComplement(fwd.data(), len, dst);
+      return;
+    }
+    if (!seq_packed) {
+      _bioReverseComplement(data() + start, len, dst);
+      return;
+    }
+
+    // Bases are read backwards from the end of the span
+    uint32_t i = 0;
+    uint32_t end = start + len;
+    for (; i < len && ((end - i) & 3) != 0; i++) {
+      uint32_t pos = end - i - 1;
+      dst[i] = packTable.reverse[seq_packedData[pos >> 2]][3 - (pos & 3)];
+    }
+    for (; i + 4 <= len; i += 4) {
+      memcpy(dst + i, packTable.reverse[seq_packedData[((end - i) >> 2) - 1]], 4);
+    }
+    for (; i < len; i++) {
+      uint32_t pos = end - i - 1;
+      dst[i] = packTable.reverse[seq_packedData[pos >> 2]][3 - (pos & 3)];
+    }
+
+    auto it = firstException(seq_packedExceptions, start);
+    for (; it != seq_packedExceptions.end() && it->first < end; ++it) {
+      dst[end - 1 - it->first] = _bioBaseComplement(it->second);
+    }
+  }
+
 }
@@ -1,11 +1,25 @@
 #pragma once
 
 #include <string>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <utility>
 
 namespace scara {
 
+  class MappedFile;
+  class InputFile;
+
   extern char _bioBaseComplement(char c);
 
+  // Write the reverse complement of len characters from src into dst, using the fastest kernel for the CPU
+  extern void _bioReverseComplement(const char* src, uint32_t len, char* dst);
+
+  extern void _bioReverseComplementScalar(const char* src, uint32_t len, char* dst);
+
+  extern const char* _bioReverseComplementKernelName(void);
+
   extern std::string _bioReverseComplement(const std::string& strData, uint32_t ulStart, uint32_t ulEnd);
 
   extern std::string _bioReverseComplement(const std::string& strData);
@@ -16,6 +30,34 @@ namespace scara {
     std::string seq_strData;
     std::string seq_strQuality;
 
+    // Layout of the sequence in the input file, used for mapped and lazily loaded sequences
+    uint32_t seq_lineWidth;      // Bases per line in the input file, 0 if the sequence is in a single line
+    uint32_t seq_lineStride;     // Distance between the starts of consecutive lines in the input file
+
+    // KK: Location of the sequence in a memory mapped input file, used for zero-copy output
+    // seq_mapData is NULL if the sequence is not mapped
+    std::shared_ptr<MappedFile> seq_mapFile;
+    const char* seq_mapData;
+
+    // KK: Lazily loaded sequence, only the length and the offset of the sequence in the input file are kept
+    // Bases are read from the file when accessed through copyTo and copyReverseComplementTo
+    std::shared_ptr<InputFile> seq_lazyFile;     // NULL if the sequence is not lazily loaded
+    uint64_t seq_lazyOffset;
+
+    // KK: Sequence is a view into seq_mapData, seq_strData is not used
+    bool seq_mapView;
+
+    // Length of mapped views and lazy sequences, which do not use seq_strData
+    uint32_t seq_length;
+
+    // KK: Packed storage, 2 bits per base (A, C, G, T), 4 bases per byte starting from the lowest bits
+    // Other characters (N, IUPAC codes, lowercase) are stored as A and listed in the exceptions
+    // When packed, seq_strData is empty and bases are accessed through copyTo and copyReverseComplementTo
+    bool seq_packed;
+    uint32_t seq_packedLength;
+    std::vector<uint8_t> seq_packedData;
+    std::vector<std::pair<uint32_t, char>> seq_packedExceptions;     // (position, character), sorted by position
+
   public:
     Sequence(const char* name, uint32_t name_length,
       const char* sequence, uint32_t sequence_length
@@ -25,6 +67,29 @@ namespace scara {
       const char* sequence, uint32_t sequence_length,
       const char* quality, uint32_t quality_length
     );
+
+    // View of a sequence in a single line of a mapped file
+    Sequence(const std::string& name, std::shared_ptr<MappedFile> file, const char* data, uint32_t length);
+
+    // Sequence that is read from the input file when accessed
+    Sequence(const std::string& name, std::shared_ptr<InputFile> file, uint64_t offset, uint32_t length,
+      uint32_t lineWidth, uint32_t lineStride
+    );
+
+    uint32_t length(void) const;
+    bool isPacked(void) const { return seq_packed; }
+    bool isLazy(void) const { return seq_lazyFile != NULL; }
+
+    // Contiguous bases of the sequence, NULL for packed and lazy sequences
+    const char* data(void) const;
+
+    // Convert the sequence into packed storage, releasing the string
+    void pack(void);
+
+    // Decode len bases starting at start into dst (or read them from the input file for lazy sequences)
+    void copyTo(uint32_t start, uint32_t len, char* dst) const;
+    // Decode reverse complement of len bases starting at start into dst
+    void copyReverseComplementTo(uint32_t start, uint32_t len, char* dst) const;
   };
 
 }
@@ -10,6 +10,7 @@ namespace scara {
   class Overlap;
   class Node;
   class Edge;
+  class PathAggregator;
 
   using MapIdToOvl = std::map<std::pair<std::string, uint32_t>, std::vector<std::shared_ptr<Overlap>>>;
   using MapIdToSeq = std::map<std::string, std::shared_ptr<Sequence>>;
@@ -0,0 +1,231 @@
+#include "Writer.h"
+#include "Sequence.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+namespace scara {
+
+  SequenceWriter::SequenceWriter(const std::string& strFile, uint32_t t_lineWidth, size_t t_bufferSize)
+    : fd(STDOUT_FILENO), ownFd(false), buffer(NULL), bufferSize(t_bufferSize), used(0), lineWidth(t_lineWidth), linePos(0), pendingFrom(0)
+  {
+    if (!strFile.empty()) {
+      fd = open(strFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+      if (fd < 0) {
+        throw std::runtime_error(std::string("SCARA WRITER: ERROR - unable to open output file: ") + strFile);
+      }
+      ownFd = true;
+    }
+
+    void* ptr = NULL;
+    if (posix_memalign(&ptr, 4096, bufferSize) != 0) {
+      if (ownFd) close(fd);
+      throw std::runtime_error(std::string("SCARA WRITER: ERROR - unable to allocate output buffer"));
+    }
+    buffer = (char*)ptr;
+  }
+
+  SequenceWriter::~SequenceWriter() {
+    // KK: Destructor must not throw, errors are only reported when flush is called explicitly
+    try {
+      flush();
+    } catch (...) {
+    }
+    free(buffer);
+    if (ownFd) close(fd);
+  }
+
+  // Write data to the output, retrying on partial writes
+  void SequenceWriter::writeBuffer(const char* data, size_t size) {
+    while (size > 0) {
+      ssize_t written = write(fd, data, size);
+      if (written < 0) {
+        if (errno == EINTR) continue;
+        throw std::runtime_error(std::string("SCARA WRITER: ERROR - writing output failed: ") + strerror(errno));
+      }
+      data += written;
+      size -= written;
+    }
+  }
+
+  // Write all pending regions with writev, retrying on partial writes
+  void SequenceWriter::writePending(void) {
+    size_t first = 0;
+    while (first < vPending.size()) {
+      int count = (int)std::min(vPending.size() - first, (size_t)IOV_MAX);
+      ssize_t written = writev(fd, &vPending[first], count);
+      if (written < 0) {
+        if (errno == EINTR) continue;
+        throw std::runtime_error(std::string("SCARA WRITER: ERROR - writing output failed: ") + strerror(errno));
+      }
+      while (first < vPending.size() && (size_t)written >= vPending[first].iov_len) {
+        written -= vPending[first].iov_len;
+        first++;
+      }
+      if (written > 0) {
+        vPending[first].iov_base = (char*)vPending[first].iov_base + written;
+        vPending[first].iov_len -= written;
+      }
+    }
+    vPending.clear();
+  }
+
+  void SequenceWriter::flush(void) {
+    if (!vPending.empty()) {
+      if (used > pendingFrom) vPending.push_back({buffer + pendingFrom, used - pendingFrom});
+      used = pendingFrom = 0;
+      writePending();
+    }
+    else if (used > 0) {
+      size_t size = used;
+      used = 0;
+      writeBuffer(buffer, size);
+    }
+  }
+
+  // Number of bases that can be copied into the buffer at once, respecting line width
+  // Emits a line break if the current line is full, and flushes the buffer if it is full
+  uint32_t SequenceWriter::chunkSize(uint32_t remaining) {
+    if (lineWidth > 0 && linePos == lineWidth) {
+      if (used == bufferSize) flush();
+      buffer[used++] = '\n';
+      linePos = 0;
+    }
+    if (used == bufferSize) flush();
+
+    size_t chunk = bufferSize - used;
+    if (chunk > remaining) chunk = remaining;
+    if (lineWidth > 0 && chunk > lineWidth - linePos) chunk = lineWidth - linePos;
+    return chunk;
+  }
+
+  // Header line, the leading '>' should be included
+  void SequenceWriter::writeHeader(const std::string& header) {
+    if (used + header.size() + 1 > bufferSize) flush();
+    if (header.size() + 1 > bufferSize) {
+      writeBuffer(header.data(), header.size());
+      writeBuffer("\n", 1);
+      return;
+    }
+    memcpy(buffer + used, header.data(), header.size());
+    used += header.size();
+    buffer[used++] = '\n';
+  }
+
+  void SequenceWriter::writeSequence(const char* data, uint32_t len) {
+    // Large unwrapped spans are written directly, without copying
+    if (lineWidth == 0 && len >= bufferSize) {
+      flush();
+      writeBuffer(data, len);
+      return;
+    }
+
+    while (len > 0) {
+      uint32_t chunk = chunkSize(len);
+      memcpy(buffer + used, data, chunk);
+      used += chunk;
+      linePos += chunk;
+      data += chunk;
+      len -= chunk;
+    }
+  }
+
+  // Packed and lazy sequences are decoded directly into the buffer
+  void SequenceWriter::writeSequence(const Sequence& seq, uint32_t start, uint32_t len) {
+    if (!seq.isPacked() && !seq.isLazy()) {
+      writeSequence(seq.data() + start, len);
+      return;
+    }
+
+    while (len > 0) {
+      uint32_t chunk = chunkSize(len);
+      seq.copyTo(start, chunk, buffer + used);
+      used += chunk;
+      linePos += chunk;
+      start += chunk;
+      len -= chunk;
+    }
+  }
+
+  // Reverse complement is written starting from the end of the span
+  void SequenceWriter::writeReverseComplement(const char* data, uint32_t len) {
+    while (len > 0) {
+      uint32_t chunk = chunkSize(len);
+      _bioReverseComplement(data + len - chunk, chunk, buffer + used);
+      used += chunk;
+      linePos += chunk;
+      len -= chunk;
+    }
+  }
+
+  void SequenceWriter::writeReverseComplement(const Sequence& seq, uint32_t start, uint32_t len) {
+    if (!seq.isPacked() && !seq.isLazy()) {
+      writeReverseComplement(seq.data() + start, len);
+      return;
+    }
+
+    while (len > 0) {
+      uint32_t chunk = chunkSize(len);
+      seq.copyReverseComplementTo(start + len - chunk, chunk, buffer + used);
+      used += chunk;
+      linePos += chunk;
+      len -= chunk;
+    }
+  }
+
+  // Queue a span to be written on flush, after the buffer contents written so far
+  void SequenceWriter::queueExternal(const char* data, uint32_t len) {
+    if (vPending.size() + 2 > IOV_MAX) flush();
+    if (used > pendingFrom) vPending.push_back({buffer + pendingFrom, used - pendingFrom});
+    pendingFrom = used;
+    vPending.push_back({(void*)data, len});
+  }
+
+  void SequenceWriter::writeExternal(const char* data, uint32_t len) {
+    if (lineWidth > 0 || len < MinExternalSpan) {
+      writeSequence(data, len);
+      return;
+    }
+    queueExternal(data, len);
+  }
+
+  void SequenceWriter::writeMappedSequence(const Sequence& seq, uint32_t start, uint32_t len) {
+    if (seq.seq_mapData == NULL || lineWidth > 0 || len < MinExternalSpan) {
+      writeSequence(seq, start, len);
+      return;
+    }
+    if (seq.seq_lineWidth == 0) {
+      queueExternal(seq.seq_mapData + start, len);
+      return;
+    }
+    // KK: Skip line breaks of the input file, each input line is a separate iovec
+    // Measured on 60 bases per line, writev of per-line iovecs is as fast as copying the lines
+    uint32_t line = start / seq.seq_lineWidth;
+    uint32_t offset = start % seq.seq_lineWidth;
+    while (len > 0) {
+      uint32_t piece = std::min(len, seq.seq_lineWidth - offset);
+      queueExternal(seq.seq_mapData + (uint64_t)line * seq.seq_lineStride + offset, piece);
+      len -= piece;
+      line++;
+      offset = 0;
+    }
+  }
+
+  // End the current sequence with a line break
+  void SequenceWriter::endSequence(void) {
+    if (lineWidth == 0 || linePos > 0) {
+      if (used == bufferSize) flush();
+      buffer[used++] = '\n';
+    }
+    linePos = 0;
+  }
+
+}
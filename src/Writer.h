@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <sys/uio.h>
+
+namespace scara {
+
+  class Sequence;
+
+  /* KK:
+   * Buffered writer for output sequences
+   * Sequence spans (and their reverse complements) are copied directly into a large aligned buffer,
+   * which is written to the output with few large write calls
+   * If lineWidth is larger than 0, sequences are wrapped into lines of that width
+   * Large spans of memory mapped input can be queued without copying, they are written
+   * together with the buffer contents using writev on flush. Spans of wrapped input are queued
+   * as one iovec per input line. Only the copy into the output buffer is avoided, the kernel
+   * still copies the data into the page cache or the pipe.
+   */
+  class SequenceWriter {
+  public:
+    // Minimum span length that is worth writing without copying, the whole span counts for wrapped input
+    static const uint32_t MinExternalSpan = 1 << 15;
+
+  private:
+    int fd;
+    bool ownFd;
+    char* buffer;
+    size_t bufferSize;
+    size_t used;
+    uint32_t lineWidth;
+    uint32_t linePos;       // Number of bases in the current sequence line
+
+    std::vector<struct iovec> vPending;     // Buffer regions and external spans waiting to be written, in order
+    size_t pendingFrom;                     // Start of the buffer region not yet added to vPending
+
+    void writeBuffer(const char* data, size_t size);
+    void writePending(void);
+    void queueExternal(const char* data, uint32_t len);
+    uint32_t chunkSize(uint32_t remaining);
+
+  public:
+    // Empty file name means standard output
+    SequenceWriter(const std::string& strFile, uint32_t t_lineWidth, size_t t_bufferSize = (size_t)1 << 24);
+    ~SequenceWriter();
+
+    SequenceWriter(const SequenceWriter&) = delete;
+    SequenceWriter& operator=(const SequenceWriter&) = delete;
+
+    void writeHeader(const std::string& header);
+    void writeSequence(const char* data, uint32_t len);
+    void writeSequence(const Sequence& seq, uint32_t start, uint32_t len);
+    void writeReverseComplement(const char* data, uint32_t len);
+    // Reverse complement of len bases of a sequence starting at start, decoded straight into the buffer
+    void writeReverseComplement(const Sequence& seq, uint32_t start, uint32_t len);
+    // Span must stay valid until the next flush, small spans and wrapped output are copied
+    void writeExternal(const char* data, uint32_t len);
+    // Forward span of a sequence, written from the mapped input if the sequence is mapped,
+    // the span is large enough and the output is not wrapped
+    void writeMappedSequence(const Sequence& seq, uint32_t start, uint32_t len);
+    void endSequence(void);
+
+    void flush(void);
+  };
+
+}
@@ -0,0 +1,153 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <random>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+
+#include <unistd.h>
+
+#include "bioparser/bioparser.hpp"
+#include "PafTokenizer.h"
+#include "Overlap.h"
+#include "MappedFile.h"
+
+// Microbenchmark for PAF parsing
+// Compares parsing with bioparser with the specialized tokenizer, using the scalar and the dispatched kernel
+// Usage: bench_paf [PAF file] [repeats], a synthetic file is generated in TMPDIR (or /tmp) if no file is given
+
+// Synthetic PAF file, removed when the benchmark ends
+struct TemporaryFile {
+  std::string strFile;
+  ~TemporaryFile() { if (!strFile.empty()) std::remove(strFile.c_str()); }
+};
+
+static std::string generatePaf(TemporaryFile& tmpFile, uint32_t numLines) {
+  const char* tmpDir = std::getenv("TMPDIR");
+  std::string strTemplate = std::string((tmpDir != NULL && tmpDir[0] != 0) ? tmpDir : "/tmp") + "/bench_paf_XXXXXX";
+  std::vector<char> fileName(strTemplate.begin(), strTemplate.end());
+  fileName.push_back(0);
+  int fd = mkstemp(fileName.data());
+  if (fd < 0) {
+    std::cerr << "\nERROR: unable to create a temporary file " << strTemplate << std::endl;
+    std::exit(1);
+  }
+  close(fd);
+  tmpFile.strFile = fileName.data();
+
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<uint32_t> dist(0, 1000000);
+  std::ofstream out(tmpFile.strFile);
+  for (uint32_t i = 0; i < numLines; i++) {
+    uint32_t qLen = 5000 + dist(generator) % 50000, tLen = 5000 + dist(generator) % 50000;
+    uint32_t qBegin = dist(generator) % (qLen / 2), tBegin = dist(generator) % (tLen / 2);
+    uint32_t ovl = std::min(qLen - qBegin, tLen - tBegin) / 2;
+    out << "read_" << dist(generator) << "_" << i << "\t" << qLen << "\t" << qBegin << "\t" << qBegin + ovl << "\t"
+        << ((i % 2) ? '+' : '-') << "\t" << "read_" << dist(generator) << "\t" << tLen << "\t" << tBegin << "\t"
+        << tBegin + ovl << "\t" << ovl * 9 / 10 << "\t" << ovl << "\t" << 60 << "\ttp:A:S\tcm:i:" << ovl / 100 << "\n";
+  }
+  return tmpFile.strFile;
+}
+
+static double measure(const std::string& strFile, uint64_t fileSize, int repeats, size_t& numOverlaps,
+                      void (*parse)(const std::string&, std::vector<std::unique_ptr<scara::Overlap>>&)) {
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repeats; r++) {
+    std::vector<std::unique_ptr<scara::Overlap>> vOvl;
+    parse(strFile, vOvl);
+    numOverlaps = vOvl.size();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return (double)fileSize * repeats / elapsed.count() / 1e9;
+}
+
+static void parseBioparser(const std::string& strFile, std::vector<std::unique_ptr<scara::Overlap>>& vOvl) {
+  auto pafParser = bioparser::createParser<bioparser::PafParser, scara::Overlap>(strFile);
+  pafParser->parse_objects(vOvl, -1);
+}
+
+static void parseTokenizer(const std::string& strFile, std::vector<std::unique_ptr<scara::Overlap>>& vOvl, scara::PafFieldFinder findFields) {
+  scara::MappedFile file(strFile);
+  const char* pos = file.data();
+  const char* end = pos + file.size();
+  scara::PafRecord record;
+  bool valid;
+  while (pos < end) {
+    pos = scara::parsePafLine(pos, end, record, valid, findFields);
+    if (valid && record.qName != NULL) {
+      vOvl.emplace_back(new scara::Overlap(record.qName, record.qNameLength, record.qLength, record.qBegin, record.qEnd, record.orientation,
+                                           record.tName, record.tNameLength, record.tLength, record.tBegin, record.tEnd,
+                                           record.matchingBases, record.overlapLength, record.mappingQuality));
+    }
+  }
+}
+
+static void parseTokenizerScalar(const std::string& strFile, std::vector<std::unique_ptr<scara::Overlap>>& vOvl) {
+  parseTokenizer(strFile, vOvl, scara::_pafFindFieldsScalar);
+}
+
+static void parseTokenizerDispatched(const std::string& strFile, std::vector<std::unique_ptr<scara::Overlap>>& vOvl) {
+  parseTokenizer(strFile, vOvl, scara::_pafFindFields);
+}
+
+// Tokenizing only, without constructing overlaps
+// The checksum of parsed fields is printed, so that parsing is not optimized away
+static double measureTokenizer(const scara::MappedFile& file, int repeats, scara::PafFieldFinder findFields, uint64_t& checksum) {
+  checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repeats; r++) {
+    const char* pos = file.data();
+    const char* end = pos + file.size();
+    scara::PafRecord record;
+    bool valid;
+    while (pos < end) {
+      pos = scara::parsePafLine(pos, end, record, valid, findFields);
+      if (valid && record.qName != NULL) checksum += record.qEnd;
+    }
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return (double)file.size() * repeats / elapsed.count() / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+  TemporaryFile tmpFile;
+  std::string strFile = (argc > 1) ? argv[1] : generatePaf(tmpFile, 1000000);
+  int repeats = (argc > 2) ? std::stoi(argv[2]) : 3;
+  scara::MappedFile file(strFile);
+
+  // Check that both kernels find the same fields on every line
+  const char* pos = file.data();
+  const char* end = pos + file.size();
+  while (pos < end) {
+    const char* expected[scara::PafNumFields];
+    const char* result[scara::PafNumFields];
+    uint32_t numExpected = scara::_pafFindFieldsScalar(pos, end, expected, scara::PafNumFields);
+    uint32_t numResult = scara::_pafFindFields(pos, end, result, scara::PafNumFields);
+    if (numExpected != numResult || memcmp(expected, result, numExpected * sizeof(const char*)) != 0) {
+      std::cerr << "\nERROR: " << scara::_pafTokenizerKernelName() << " kernel does not match the scalar kernel!\n";
+      return 1;
+    }
+    const char* nl = (const char*)memchr(pos, '\n', end - pos);
+    pos = (nl != NULL) ? nl + 1 : end;
+  }
+
+  size_t numOverlaps = 0;
+  uint64_t checksum = 0;
+  std::cerr << "\nParsing " << strFile << " (" << file.size() << " bytes), " << repeats << " repeats";
+  std::cerr << "\nbioparser (GB/s): " << measure(strFile, file.size(), repeats, numOverlaps, parseBioparser);
+  std::cerr << "\nTokenizer, scalar (GB/s): " << measure(strFile, file.size(), repeats, numOverlaps, parseTokenizerScalar);
+  std::cerr << "\nTokenizer, " << scara::_pafTokenizerKernelName() << " (GB/s): " << measure(strFile, file.size(), repeats, numOverlaps, parseTokenizerDispatched);
+  std::cerr << "\nTokenizing only, scalar (GB/s): " << measureTokenizer(file, repeats, scara::_pafFindFieldsScalar, checksum);
+  std::cerr << " (checksum " << checksum << ")";
+  std::cerr << "\nTokenizing only, " << scara::_pafTokenizerKernelName() << " (GB/s): " << measureTokenizer(file, repeats, scara::_pafFindFields, checksum);
+  std::cerr << " (checksum " << checksum << ")";
+  std::cerr << "\nOverlaps: " << numOverlaps;
+  std::cerr << std::endl;
+
+  return 0;
+}
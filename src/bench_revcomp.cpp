@@ -0,0 +1,65 @@
+#include <iostream>
+#include <string>
+#include <random>
+#include <chrono>
+
+#include "Sequence.h"
+
+// Microbenchmark for reverse complement kernels
+// Compares the per-base scalar kernel with the kernel chosen for this CPU and checks that they agree
+
+// Per base complement with a chain of branches, as used before the lookup table kernels
+static char branchComplement(char c) {
+  if ((c == 'A') || c == 'a') return 'T';
+  if ((c == 'T') || c == 't') return 'A';
+  if ((c == 'G') || c == 'g') return 'C';
+  if ((c == 'C') || c == 'c') return 'G';
+
+  return c;
+}
+
+static void branchReverseComplement(const char* src, uint32_t len, char* dst) {
+  for (uint32_t i = 0; i < len; i++) dst[i] = branchComplement(src[len - i - 1]);
+}
+
+static double measure(void (*kernel)(const char*, uint32_t, char*), const std::string& data, std::string& out, int repeats) {
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repeats; r++) kernel(data.data(), data.size(), &out[0]);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return (double)data.size() * repeats / elapsed.count() / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t length = 50000000;
+  int repeats = 10;
+  if (argc > 1) length = std::stoul(argv[1]);
+  if (argc > 2) repeats = std::stoi(argv[2]);
+
+  // Mostly ACGT, with some lowercase and IUPAC characters
+  const std::string alphabet = "ACGTACGTACGTACGTacgtNRYSWKMBDHVn";
+  std::string data(length, 'A');
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<uint32_t> dist(0, alphabet.size() - 1);
+  for (auto& c : data) c = alphabet[dist(generator)];
+
+  // Check all characters against the scalar kernel
+  std::string allChars(256 * 3 + 29, 'x');
+  for (uint32_t i = 0; i < allChars.size(); i++) allChars[i] = (char)(i % 256);
+  std::string expected(allChars.size(), 'x'), result(allChars.size(), 'x');
+  scara::_bioReverseComplementScalar(allChars.data(), allChars.size(), &expected[0]);
+  scara::_bioReverseComplement(allChars.data(), allChars.size(), &result[0]);
+  if (expected != result) {
+    std::cerr << "\nERROR: " << scara::_bioReverseComplementKernelName() << " kernel does not match the scalar kernel!\n";
+    return 1;
+  }
+
+  std::string out(length, 'x');
+  std::cerr << "\nReverse complement of " << length << " bases, " << repeats << " repeats";
+  std::cerr << "\nBranching (GB/s): " << measure(branchReverseComplement, data, out, repeats);
+  std::cerr << "\nScalar table (GB/s): " << measure(scara::_bioReverseComplementScalar, data, out, repeats);
+  std::cerr << "\nDispatched, " << scara::_bioReverseComplementKernelName() << " (GB/s): " << measure(scara::_bioReverseComplement, data, out, repeats);
+  std::cerr << std::endl;
+
+  return 0;
+}
@@ -7,6 +7,10 @@
 #include <algorithm>
 #include <set>
 #include <iterator>
+#include <sstream>
+#include <cmath>
+#include <cctype>
+#include <climits>
 #include <unordered_set>
 
 #include <unistd.h>
@@ -17,32 +21,16 @@
 #include <sys/resource.h>
 
 #include <getopt.h>
+#include <thread>
 
 #include "scara.h"
 #include "SBridger.h"
-#include "globals.h"
+#include "OverlapCache.h"
+#include "BatchScheduler.h"
 
 using namespace std;
 using namespace scara;
 
-namespace scara {
-
-int multithreading;
-
-uint32_t MinMCPaths, HardNodeLimit, SoftNodeLimit;
-uint32_t NumDFSNodes, MaxMCIterations;
-uint32_t MinPathsinGroup;
-float SImin, OHmax;
-
-bool test_short_length, test_contained_reads, test_low_quality;
-bool print_output;
-double PathGroupHalfSize;
-
-std::string logFile;
-
-DebugLevel globalDebugLevel;
-}
-
 // For tracking memory usage withing the program
 // Taken from:
 // https://www.tutorialspoint.com/how-to-get-memory-usage-at-runtime-using-cplusplus
@@ -74,69 +62,40 @@ void print_mem_usage(std::string location) {
    cerr << "\nVirtual Memory: " << vm << "\nResident set size: " << rss << endl;
 }
 
-// Setting global parameters, variables are defined in globals.h
-void setGlobalParameters() {
-
-  // Global variable that determines whether to use multithreading or not
-  // Not using multithreading unless specified in the parameters
-  scara::multithreading = 0;
-
-  // A minimum number of paths generated by Monte Carlo method
-  scara::MinMCPaths = 40;
-  // A maximum number of nodes that a path can contain, longer paths will not be generated
-  scara::HardNodeLimit = 1000;
-  // A number of nodes in a path that will cause a warning to be displayed
-  scara::SoftNodeLimit = 100;
-
-  // A number of nodes added to the stack in each step of DFS graph traversal
-  scara::NumDFSNodes = 5;
-  // Maximum number of iterations using Monte Carlo approach
-  scara::MaxMCIterations = 100000;
-
-  // A minimum number of paths in a group that will generate a scaffold
-  scara::MinPathsinGroup = 3;
-
-  // Minimum sequence identity for filtering overlaps
-  scara::SImin = 0.60;
-  // Maximum allowed overhang percentage for filtering overlaps
-  scara::OHmax = 0.25;
-
-  scara::test_short_length = true;
-  scara::test_contained_reads = true;
-  scara::test_low_quality = true;
-
-  // Determines if more verbose messages are printed
-  // TODO: replace this with DEBUG_LEVEL with multiple levels
-  scara::print_output = true;
-
-  // A path is placed in a group if its length falls within pathGtoupHalfSize of groups representative length
-  scara::PathGroupHalfSize = 5000;
-
-  // Setting default Debugg level
-  scara::globalDebugLevel = DL_INFO;
-
-  // Setting Log file
-  scara::logFile = "scaraLog.txt";
-}
-
-void printGlobalParameters() {
+void printGlobalParameters(const scara::ScaraConfig& config) {
 
   std::cerr << "\nSCARA global parameters:";
-  std::cerr << "\nUsing multithreading: " << (scara::multithreading == 0?"NO":"YES");
-  std::cerr << "\nglobalDebugLevel: " << scara::globalDebugLevel;
-
-  std::cerr << "\nMinMCPaths: " << scara::MinMCPaths;
-  std::cerr << "\nHardNodeLimit: " << scara::HardNodeLimit;
-  std::cerr << "\nSoftNodeLimit: " << scara::SoftNodeLimit;
-  std::cerr << "\nNumDFSNodes: " << scara::NumDFSNodes;
-  std::cerr << "\nMaxMCIterations: " << scara::MaxMCIterations;
-  std::cerr << "\nMinPathsinGroup: " << scara::MinPathsinGroup;
-  std::cerr << "\nPathGroupHalfSize: " << scara::PathGroupHalfSize;
-
-  std::cerr << "\nSImin: " << scara::SImin;
-  std::cerr << "\nOHmax: " << scara::OHmax;
-
-  std::cerr << "\nLog file: " << scara::logFile;
+  std::cerr << "\nUsing multithreading: " << (config.multithreading == 0?"NO":"YES");
+  std::cerr << "\nNumThreads: " << config.NumThreads;
+  std::cerr << "\ndebugLevel: " << config.debugLevel;
+
+  std::cerr << "\nMinMCPaths: " << config.MinMCPaths;
+  std::cerr << "\nHardNodeLimit: " << config.HardNodeLimit;
+  std::cerr << "\nSoftNodeLimit: " << config.SoftNodeLimit;
+  std::cerr << "\nMaxPathLength: " << config.MaxPathLength;
+  std::cerr << "\nNumDFSNodes: " << config.NumDFSNodes;
+  std::cerr << "\nMaxMCIterations: " << config.MaxMCIterations;
+  std::cerr << "\nMinPathsinGroup: " << config.MinPathsinGroup;
+  std::cerr << "\nPathGroupHalfSize: " << config.PathGroupHalfSize;
+
+  std::cerr << "\nStreamPaths: " << (config.StreamPaths?"YES":"NO");
+  std::cerr << "\nPackReads: " << (config.PackReads?"YES":"NO");
+  std::cerr << "\nLazyReads: " << (config.LazyReads?"YES":"NO");
+  std::cerr << "\nMapSequences: " << (config.MapSequences?"YES":"NO");
+  std::cerr << "\nPipelineGraph: " << (config.PipelineGraph?"YES":"NO");
+  std::cerr << "\nPartitionGraph: " << (config.PartitionGraph?"YES":"NO");
+  std::cerr << "\nSaveGraphFile: " << config.SaveGraphFile;
+  std::cerr << "\nLoadGraphFile: " << config.LoadGraphFile;
+  std::cerr << "\nCheckpointDir: " << config.CheckpointDir;
+  std::cerr << "\nResumeFrom: " << scara::CheckpointPhase2String(config.ResumeFrom);
+  std::cerr << "\nSweepDir: " << config.SweepDir;
+
+  std::cerr << "\nSImin: " << config.SImin;
+  std::cerr << "\nOHmax: " << config.OHmax;
+
+  std::cerr << "\nLog file: " << config.logFile;
+  std::cerr << "\nOutput file: " << (config.outputFile.empty() ? "standard output" : config.outputFile);
+  std::cerr << "\nFASTA line width: " << config.FastaLineWidth;
 
 }
 
@@ -148,6 +107,13 @@ DebugLevel debugLevelFromString(std::string str) {
 	else return DL_NONE;
 }
 
+scara::CheckpointPhase checkpointPhaseFromString(std::string str) {
+	if (str == "graph") return scara::CP_GRAPH;
+	else if (str == "paths") return scara::CP_PATHS;
+	else if (str == "scaffolds") return scara::CP_SCAFFOLDS;
+	else return scara::CP_NONE;
+}
+
 void print_version_message_and_exit() {
   const char* versionmessage = "\nScaRa version 1.3!\n";
   std::cerr << versionmessage;
@@ -160,7 +126,7 @@ void print_help_message_and_exit() {
     "\n    or"
     "\nScaRa -r <Reads file> -c <Contigs file> -o <Reads to Contigs Overlaps file> -s <Reads to Reds Overlaps file>"
     "\n    The program will perform one iteration of the algorithm"
-    "\n    and output contigs to the standard output!."
+    "\n    and output contigs to the standard output (or the file set with -O)!."
     "\n    <Input foder> must contain the following files:"
     "\n    - reads.fastq - reads in FASTQ/FASTA format"
     "\n    - readsToContigs.paf - overlaps between reads and contigs"
@@ -168,13 +134,59 @@ void print_help_message_and_exit() {
     "\n    - contigs.fasta - contigs in FASTA format"
     "\nIf Reads file, Contigs file or Overlaps are specified,"
 	  "\nthey will not be looked for in the Input folder!"
+    "\n"
+    "\nScaRa cacheOverlaps <Overlaps file> [<Overlaps file> ...]"
+    "\n    Converts overlaps into binary overlap caches (<Overlaps file>.scovl),"
+    "\n    which are used instead of the overlaps files while they do not change."
+    "\n    A cache file can also be given instead of an overlaps file."
     "\nGeneral options:"
     "\n-f (--folder)     specify input folder for ScaRa"
     "\n-r (--reads)      specify reads file for ScaRa"
     "\n-c (--contigs)    specify contigs file ScaRa"
     "\n-o (--overlapsRC)   specify contig-read overlaps file for ScaRa"
     "\n-s (--overlapsRR)   specify read self overlaps file for ScaRa"
+    "\n-O (--output)      write scaffolds to a file instead of the standard output"
+    "\n-w (--lineWidth)   wrap output sequences into lines of given width"
+    "\n                   (default 0, each sequence in a single line)"
     "\n-m (--multithreading)   use multithreading"
+    "\n-t (--threads)     number of threads used with multithreading (implies -m)"
+    "\n                   (default: number of hardware threads)"
+    "\n--streamPaths      group paths while they are generated, keeping only"
+    "\n                   group representatives (lower memory usage)"
+    "\n--packReads        store reads with 2 bits per base (lower memory usage)"
+    "\n--lazyReads        keep only an index of reads in memory (stored as <reads>.scidx),"
+    "\n                   read sequences are loaded from the reads file when needed"
+    "\n--mapSequences     load reads and contigs through a memory mapping, sequences"
+    "\n                   in a single line are not copied"
+    "\n--pipelineGraph    parse overlap files while graph edges are being created"
+    "\n                   (overlaps are not kept in memory)"
+    "\n--partitionGraph   generate paths and scaffolds separately for each connected"
+    "\n                   component of the graph, in parallel with multithreading;"
+    "\n                   pMinMCPaths and pMAXMCIterations apply to each component;"
+    "\n                   only the graph phase is checkpointed"
+    "\n--saveGraph [file] save the constructed graph into a graph index file"
+    "\n--loadGraph [file] load the graph from a graph index file instead of"
+    "\n                   constructing it from overlaps (overlap files are not needed)"
+    "\n--checkpointDir [dir] write a checkpoint into the directory after each phase"
+    "\n                   (graph, paths and scaffolds)"
+    "\n--resume-from [phase] resume the run after the given phase (graph, paths or"
+    "\n                   scaffolds) using checkpoints, if its checkpoint is not valid"
+    "\n                   the latest valid earlier checkpoint is used (requires --checkpointDir);"
+    "\n                   checkpoints created with different path parameters are not valid"
+    "\n--sweep [grid]     run a parameter sweep over a grid of values, given as"
+    "\n                   \"pSImin=0.5,0.6;pOHmax=0.25;pMinPathsInGroup=2,3;pPathGroupHalfSize=5000\","
+    "\n                   parameters not given keep their value; one scaffolds file"
+    "\n                   per setting and summary.tsv are written into the sweep directory"
+    "\n--sweepDir [dir]   directory for parameter sweep results (default scara_sweep)"
+    "\n--batch [manifest] scaffold many datasets in one process, the manifest lists"
+    "\n                   one dataset folder per line (same layout as with -f),"
+    "\n                   optionally followed by the output file (default"
+    "\n                   <folder>/scaffolds.fasta); datasets are run in parallel on"
+    "\n                   a shared thread pool and timings are written into"
+    "\n                   <manifest>.report.tsv; free threads are shared among"
+    "\n                   running jobs, their messages are printed only from -D 2 on"
+    "\n--memoryBudget [MB] estimated memory that batch jobs running at once may use"
+    "\n                   (default: physical memory)"
     "\n-D (--debug_level) [level] set a debugg level which determines "
     "\n 					the amount of output the program generates to stderr"
     "\n 					level can be set to values 0 - 3, with 0 being the least"
@@ -182,9 +194,12 @@ void print_help_message_and_exit() {
     "\n________________________________________________________________________"
     "\nAlgorithm parameter options:"
     "\npMinMCPaths - minimum number of paths that will try to be generated using"
-    "\n              Monte Carlo method (defult 40)."
-    "\npMAXMCIterations - maximum nbumber of iterations during Monte Carlo (defualt 100000)"
+    "\n              Monte Carlo method (defult 40), for each component with --partitionGraph."
+    "\npMAXMCIterations - maximum nbumber of iterations during Monte Carlo (defualt 100000),"
+    "\n                   for each component with --partitionGraph"
     "\npHardNodeLimit - a maximum number of nodes in a path (defult 1000)"
+    "\npMaxPathLength - a maximum length of a path in bases, longer paths are"
+    "\n                 pruned during graph traversal (default 0, no limit)"
     "\npNumDFSNodes - a number of nodes that will be placed on the stack during"
     "\n               DSF search of the graph (defult 5)"
     "\npMinPathsInGroup - a minimum number of paths in a path group (default 3)"
@@ -203,11 +218,32 @@ void print_help_message_and_exit() {
   exit(0);
 }
 
+// Converts each given PAF file into an overlap cache next to it
+int cache_overlaps(int argc, char **argv) {
+  if (argc < 1) {
+    std::cerr << "\nNo overlaps files specified!";
+    print_help_message_and_exit();
+  }
+  // A file that can not be converted is reported and left without a cache, remaining files are still converted
+  int numFailed = 0;
+  for (int i = 0; i < argc; i++) {
+    std::string strPaf = argv[i];
+    try {
+      scara::writeOverlapCache(strPaf, strPaf + scara::OverlapCacheSuffix);
+    } catch (const std::exception& e) {
+      std::cerr << e.what() << "\nSCARA: " << strPaf << " will be used without an overlap cache" << std::endl;
+      numFailed++;
+    }
+  }
+  return (numFailed > 0) ? 1 : 0;
+}
+
 int main(int argc, char **argv)
 {
+  if (argc >= 2 && std::string(argv[1]) == "cacheOverlaps") return cache_overlaps(argc - 2, argv + 2);
 
   // KK: Defining basic program options
-  const char* const short_opts = "hvr:c:o:s:f:mD:";
+  const char* const short_opts = "hvr:c:o:s:f:mD:O:w:t:";
   const option long_opts[] = {
     {"help", no_argument, NULL, 'h'},                   // option_index = 0
     {"version", no_argument, NULL, 'v'},                // option_index = 1
@@ -227,6 +263,24 @@ int main(int argc, char **argv)
     {"pPathGroupHalfSize", required_argument, NULL, 0}, // option_index = 15
     {"pSImin", required_argument, NULL, 0},             // option_index = 16
     {"pOHmax", required_argument, NULL, 0},             // option_index = 17
+    {"streamPaths", no_argument, NULL, 0},              // option_index = 18
+    {"pMaxPathLength", required_argument, NULL, 0},     // option_index = 19
+    {"output", required_argument, NULL, 'O'},           // option_index = 20
+    {"lineWidth", required_argument, NULL, 'w'},        // option_index = 21
+    {"threads", required_argument, NULL, 't'},          // option_index = 22
+    {"packReads", no_argument, NULL, 0},                // option_index = 23
+    {"lazyReads", no_argument, NULL, 0},                // option_index = 24
+    {"mapSequences", no_argument, NULL, 0},             // option_index = 25
+    {"pipelineGraph", no_argument, NULL, 0},            // option_index = 26
+    {"saveGraph", required_argument, NULL, 0},          // option_index = 27
+    {"loadGraph", required_argument, NULL, 0},          // option_index = 28
+    {"checkpointDir", required_argument, NULL, 0},      // option_index = 29
+    {"resume-from", required_argument, NULL, 0},        // option_index = 30
+    {"sweep", required_argument, NULL, 0},              // option_index = 31
+    {"sweepDir", required_argument, NULL, 0},           // option_index = 32
+    {"batch", required_argument, NULL, 0},              // option_index = 33
+    {"memoryBudget", required_argument, NULL, 0},       // option_index = 34
+    {"partitionGraph", no_argument, NULL, 0},           // option_index = 35
     {NULL, no_argument, NULL, 0}
   };
 
@@ -234,7 +288,15 @@ int main(int argc, char **argv)
   readsSet = contigsSet = RCOverlapsSet = RROverlapsSet = 0;
   string strData, strReadsFasta, strContigsFasta, strR2COvlPaf, strR2ROvlPaf;
 
-  setGlobalParameters();
+  bool sweepSet = false;
+  scara::ParameterSweep sweep;
+
+  string strBatchManifest;
+  uint64_t memoryBudget = 0;
+
+  // Default parameters, the executable also writes the graph into the log file
+  scara::ScaraConfig config;
+  config.logFile = "scaraLog.txt";
 
   int opt, option_index;
   while ((opt = getopt_long(argc, argv, short_opts, long_opts, &option_index)) != -1)
@@ -270,52 +332,151 @@ int main(int argc, char **argv)
       strR2ROvlPaf = optarg;
       break;
     case 'm':
-      scara::multithreading = 1;
+      config.multithreading = 1;
+      break;
+    case 't':
+      config.multithreading = 1;
+      config.NumThreads = std::max(1, stoi(optarg));
       break;
     case 'D':
-      scara::globalDebugLevel = debugLevelFromString(optarg);
+      config.debugLevel = debugLevelFromString(optarg);
+      break;
+    case 'O':
+      config.outputFile = optarg;
+      break;
+    case 'w':
+      config.FastaLineWidth = stoi(optarg);
       break;
     case 0:
-      if (option_index == 9)  scara::MinMCPaths = stoi(optarg);
-      if (option_index == 10) scara::MaxMCIterations = stoi(optarg);
-      if (option_index == 11) scara::HardNodeLimit = stoi(optarg);
-      if (option_index == 12) scara::NumDFSNodes = stoi(optarg);
-      if (option_index == 13) scara::MinPathsinGroup = stoi(optarg);
-      if (option_index == 14) scara::PathGroupHalfSize = stoi(optarg);
-      if (option_index == 15) scara::PathGroupHalfSize = stoi(optarg);
-      if (option_index == 16) scara::SImin = stof(optarg);
-      if (option_index == 17) scara::OHmax = stof(optarg);
+      if (option_index == 9)  config.MinMCPaths = stoi(optarg);
+      if (option_index == 10) config.MaxMCIterations = stoi(optarg);
+      if (option_index == 11) config.HardNodeLimit = stoi(optarg);
+      if (option_index == 12) config.NumDFSNodes = stoi(optarg);
+      if (option_index == 13) config.MinPathsinGroup = stoi(optarg);
+      if (option_index == 14) config.PathGroupHalfSize = stoi(optarg);
+      if (option_index == 15) config.PathGroupHalfSize = stoi(optarg);
+      if (option_index == 16) config.SImin = stof(optarg);
+      if (option_index == 17) config.OHmax = stof(optarg);
+      if (option_index == 18) config.StreamPaths = true;
+      if (option_index == 19) config.MaxPathLength = stoi(optarg);
+      if (option_index == 23) config.PackReads = true;
+      if (option_index == 24) config.LazyReads = true;
+      if (option_index == 25) config.MapSequences = true;
+      if (option_index == 26) config.PipelineGraph = true;
+      if (option_index == 27) config.SaveGraphFile = optarg;
+      if (option_index == 28) config.LoadGraphFile = optarg;
+      if (option_index == 29) config.CheckpointDir = optarg;
+      if (option_index == 30) {
+        config.ResumeFrom = checkpointPhaseFromString(optarg);
+        if (config.ResumeFrom == scara::CP_NONE) {
+          std::cerr << "\nInvalid phase for --resume-from: " << optarg;
+          print_help_message_and_exit();
+        }
+      }
+      if (option_index == 31) {
+        sweepSet = true;
+        if (!parseSweepGrid(optarg, sweep)) {
+          std::cerr << "\nInvalid parameter grid for --sweep: " << optarg;
+          print_help_message_and_exit();
+        }
+      }
+      if (option_index == 32) config.SweepDir = optarg;
+      if (option_index == 33) strBatchManifest = optarg;
+      if (option_index == 34) {
+        if (!parseMemoryBudget(optarg, memoryBudget)) {
+          std::cerr << "\nInvalid memory budget for --memoryBudget (a positive number of MB): " << optarg;
+          print_help_message_and_exit();
+        }
+      }
+      if (option_index == 35) config.PartitionGraph = true;
       break;
     default:
       print_help_message_and_exit();
     }
 
 
-  if (argc < 2 || readsSet == 0 || contigsSet == 0 || RCOverlapsSet == 0 || RROverlapsSet == 0) {
+  if (!strBatchManifest.empty()) {
+    if (sweepSet || config.ResumeFrom != scara::CP_NONE || !config.CheckpointDir.empty()
+        || !config.LoadGraphFile.empty() || !config.SaveGraphFile.empty() || !config.outputFile.empty()) {
+      std::cerr << "\nBatch mode can not be combined with --sweep, checkpoints, graph index files or --output!";
+      print_help_message_and_exit();
+    }
+    if (config.debugLevel >= DL_VERBOSE) printGlobalParameters(config);
+
+    std::vector<scara::BatchJob> vJobs = scara::readBatchManifest(strBatchManifest);
+    if (memoryBudget == 0) memoryBudget = scara::physicalMemory();
+    uint32_t numSucceeded = scara::runBatch(vJobs, config, memoryBudget, strBatchManifest + ".report.tsv");
+    return (numSucceeded == vJobs.size()) ? 0 : 1;
+  }
+
+  if (argc < 2 || readsSet == 0 || contigsSet == 0 || ((RCOverlapsSet == 0 || RROverlapsSet == 0) && config.LoadGraphFile.empty())) {
      std::cerr << "\nNot all arguments specified!";
      print_help_message_and_exit();
   }
 
-  if (scara::globalDebugLevel >= DL_VERBOSE) printGlobalParameters();
+  if (config.ResumeFrom != scara::CP_NONE && config.CheckpointDir.empty()) {
+     std::cerr << "\nResuming from a checkpoint requires a checkpoint directory (--checkpointDir)!";
+     print_help_message_and_exit();
+  }
+
+  if (config.PartitionGraph && config.ResumeFrom > scara::CP_GRAPH) {
+     std::cerr << "\nWith --partitionGraph paths and scaffolds are not checkpointed, only --resume-from graph can be used!";
+     print_help_message_and_exit();
+  }
+
+  if (sweepSet && (config.ResumeFrom != scara::CP_NONE || !config.LoadGraphFile.empty() || !config.CheckpointDir.empty()
+      || config.PartitionGraph)) {
+     std::cerr << "\nParameter sweep constructs the graph itself, it can not be combined with checkpoints, --loadGraph or --partitionGraph!";
+     print_help_message_and_exit();
+  }
+
+  if (config.debugLevel >= DL_VERBOSE) printGlobalParameters(config);
 
   std::time_t start_time = std::time(nullptr);
   std::cerr << "\nSCARA: Starting ScaRa: " << std::asctime(std::localtime(&start_time)) << start_time << " seconds since the Epoch";
-  if (scara::globalDebugLevel == DL_DEBUG) print_mem_usage("Start");
+  if (config.debugLevel == DL_DEBUG) print_mem_usage("Start");
 
   std::time_t current_time = std::time(nullptr);
   std::cerr << "\nSCARA: Finished loading: " << std::asctime(std::localtime(&current_time)) << (current_time - start_time) << " seconds since the start\n";
 
-  scara::SBridger sbridger(strReadsFasta, strContigsFasta, strR2COvlPaf, strR2ROvlPaf);
-  if (scara::globalDebugLevel >= DL_VERBOSE) {
+  scara::SBridger sbridger(config, strReadsFasta, strContigsFasta, strR2COvlPaf, strR2ROvlPaf);
+  if (config.debugLevel >= DL_VERBOSE) {
     print_mem_usage("After initialization");
     sbridger.printState();
   }
 
   current_time = std::time(nullptr);
   std::cerr << "\nSCARA: Finished initializing bridger: " << std::asctime(std::localtime(&current_time)) << (current_time - start_time) << " seconds since the start\n";
-  std::cerr << "\nSCARA: Generating graph:";
+  if (sweepSet) {
+    // Parameters that are not swept keep their single value
+    if (sweep.vSImin.empty()) sweep.vSImin.emplace_back(config.SImin);
+    if (sweep.vOHmax.empty()) sweep.vOHmax.emplace_back(config.OHmax);
+    if (sweep.vMinPathsinGroup.empty()) sweep.vMinPathsinGroup.emplace_back(config.MinPathsinGroup);
+    if (sweep.vPathGroupHalfSize.empty()) sweep.vPathGroupHalfSize.emplace_back(config.PathGroupHalfSize);
+
+    std::cerr << "\nSCARA: Running parameter sweep:";
+    int numSettings = sbridger.runSweep(sweep, config.SweepDir);
+
+    current_time = std::time(nullptr);
+    std::cerr << "\nSCARA: Finished parameter sweep with " << numSettings << " settings: " << std::asctime(std::localtime(&current_time)) << (current_time - start_time) << " seconds since the start\n";
+    return 0;
+  }
 
-  sbridger.generateGraph();
+  // Phases up to and including the resumed one are restored from checkpoints instead of being run
+  scara::CheckpointPhase resumed = scara::CP_NONE;
+  if (config.ResumeFrom != scara::CP_NONE) {
+    std::cerr << "\nSCARA: Resuming from checkpoints:";
+    resumed = sbridger.resumeFromCheckpoint(config.ResumeFrom);
+    std::cerr << "\nSCARA: Resumed after phase: " << scara::CheckpointPhase2String(resumed);
+  }
+  bool writeCheckpoints = !config.CheckpointDir.empty();
+
+  if (resumed < scara::CP_GRAPH) {
+    std::cerr << "\nSCARA: Generating graph:";
+
+    sbridger.generateGraph();
+    if (writeCheckpoints) sbridger.saveCheckpoint(scara::CP_GRAPH);
+  }
   sbridger.print();
 
   current_time = std::time(nullptr);
@@ -324,39 +485,60 @@ int main(int argc, char **argv)
 
   sbridger.cleanupGraph();
   sbridger.print();
-  if (scara::globalDebugLevel >= DL_VERBOSE) {
+  if (config.debugLevel >= DL_VERBOSE) {
     print_mem_usage("After graph generation");
     sbridger.printState();
   }
 
   current_time = std::time(nullptr);
   std::cerr << "\nSCARA: Finished cleaning up the graph: " << std::asctime(std::localtime(&current_time)) << (current_time - start_time) << " seconds since the start\n";
-  std::cerr << "\nSCARA: Generating paths:";
 
-  int numPaths = sbridger.generatePaths();
+  if (config.PartitionGraph) {
+    std::cerr << "\nSCARA: Generating paths and scaffolds for connected components:";
 
-  if (scara::globalDebugLevel >= DL_VERBOSE) {
-    print_mem_usage("After path generation");
-    sbridger.printState();
+    int numScaffolds = sbridger.processComponents();
+
+    if (config.debugLevel >= DL_VERBOSE) {
+      print_mem_usage("After processing components");
+      sbridger.printState();
+    }
+    current_time = std::time(nullptr);
+    std::cerr << "\nSCARA: Finished processing components: " << std::asctime(std::localtime(&current_time)) << (current_time - start_time) << " seconds since the start\n";
+    std::cerr << "\nSCARA: Final number of scaffolds: " << numScaffolds;
   }
-  current_time = std::time(nullptr);
-  std::cerr << "\nSCARA: Finished generating paths: " << std::asctime(std::localtime(&current_time)) << (current_time - start_time) << " seconds since the start\n";
-  std::cerr << "\nSCARA: Paths generated: " << numPaths;
 
-  std::cerr << "\nSCARA: printing paths:";
-  sbridger.printPaths();
+  if (!config.PartitionGraph && resumed < scara::CP_PATHS) {
+    std::cerr << "\nSCARA: Generating paths:";
 
-  std::cerr << "\nSCARA: Grouping and processing paths:";
+    int numPaths = sbridger.generatePaths();
+    if (writeCheckpoints) sbridger.saveCheckpoint(scara::CP_PATHS);
 
-  int numGroups = sbridger.groupAndProcessPaths();
+    if (config.debugLevel >= DL_VERBOSE) {
+      print_mem_usage("After path generation");
+      sbridger.printState();
+    }
+    current_time = std::time(nullptr);
+    std::cerr << "\nSCARA: Finished generating paths: " << std::asctime(std::localtime(&current_time)) << (current_time - start_time) << " seconds since the start\n";
+    std::cerr << "\nSCARA: Paths generated: " << numPaths;
+  }
 
-  if (scara::globalDebugLevel >= DL_VERBOSE) {
-    print_mem_usage("After path grouping");
-    sbridger.printState();
+  if (!config.PartitionGraph && resumed < scara::CP_SCAFFOLDS) {
+    std::cerr << "\nSCARA: printing paths:";
+    sbridger.printPaths();
+
+    std::cerr << "\nSCARA: Grouping and processing paths:";
+
+    int numGroups = sbridger.groupAndProcessPaths();
+    if (writeCheckpoints) sbridger.saveCheckpoint(scara::CP_SCAFFOLDS);
+
+    if (config.debugLevel >= DL_VERBOSE) {
+      print_mem_usage("After path grouping");
+      sbridger.printState();
+    }
+    current_time = std::time(nullptr);
+    std::cerr << "\nSCARA: Finished grouping and processing paths: " << std::asctime(std::localtime(&current_time)) << (current_time - start_time) << " seconds since the start\n";
+    std::cerr << "\nSCARA: Final number of path groups: " << numGroups;
   }
-  current_time = std::time(nullptr);
-  std::cerr << "\nSCARA: Finished grouping and processing paths: " << std::asctime(std::localtime(&current_time)) << (current_time - start_time) << " seconds since the start\n";
-  std::cerr << "\nSCARA: Final number of path groups: " << numGroups;
   std::cerr << "\nSCARA: Generating sequences:";
 
   int numSeq = sbridger.generateSequences();
@@ -365,7 +547,7 @@ int main(int argc, char **argv)
   std::cerr << "\nSCARA: Finished generating sequences: " << std::asctime(std::localtime(&current_time)) << (current_time - start_time) << " seconds since the start\n";
   std::cerr << "\nSCARA: Final number of sequences generated: " << numSeq;
 
-  if (scara::globalDebugLevel >= DL_VERBOSE) {
+  if (config.debugLevel >= DL_VERBOSE) {
     print_mem_usage("After sequence generation");
     sbridger.printState();
   }
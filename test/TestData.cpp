@@ -0,0 +1,84 @@
+#include "TestUtils.h"
+#include "Sequence.h"
+
+#include <random>
+#include <algorithm>
+
+namespace scara {
+namespace test {
+
+  // Location of a contig or a read on its genome
+  struct GenomeInterval {
+    std::string name;
+    uint32_t start, end;
+    bool forward;
+  };
+
+  static void writePafLine(std::ostringstream& ss, const GenomeInterval& query, const GenomeInterval& target
+                           , uint32_t start, uint32_t end, std::mt19937& generator) {
+    uint32_t qLen = query.end - query.start, tLen = target.end - target.start;
+    uint32_t qBegin = query.forward ? start - query.start : query.end - end;
+    uint32_t tBegin = target.forward ? start - target.start : target.end - end;
+    uint32_t ovl = end - start;
+    // Identities between 0.55 and 1, some overlaps fail the identity test
+    std::uniform_int_distribution<uint32_t> identity(55, 100);
+    uint32_t matching = (uint64_t)ovl * identity(generator) / 100;
+    ss << query.name << "\t" << qLen << "\t" << qBegin << "\t" << qBegin + ovl << "\t" << ((query.forward == target.forward) ? '+' : '-')
+       << "\t" << target.name << "\t" << tLen << "\t" << tBegin << "\t" << tBegin + ovl << "\t" << matching << "\t" << ovl << "\t60\ttp:A:P\n";
+  }
+
+  /* KK:
+   * Each component is a random genome, covered by contigs separated by gaps and by reads on both strands
+   * Overlaps are exact intersections of genome intervals, so the graph is consistent and scaffolds join the contigs
+   * of each genome. Contained reads and low identities give edges that fail the tests.
+   */
+  void writeSyntheticDataset(const std::string& strDir, uint32_t seed, uint32_t numComponents) {
+    std::mt19937 generator(seed);
+    static const char Bases[] = "ACGT";
+    std::uniform_int_distribution<uint32_t> base(0, 3), readLength(1500, 4000), strand(0, 1);
+    const uint32_t NumContigs = 4, ContigLength = 15000, GapLength = 2500, NumReads = 450, MinOverlap = 500;
+
+    std::ostringstream ssReads, ssContigs, ssR2C, ssR2R;
+    for (uint32_t comp = 0; comp < numComponents; comp++) {
+      std::string strPrefix = (numComponents > 1) ? "g" + std::to_string(comp) + "_" : "";
+      uint32_t genomeLength = NumContigs * (ContigLength + GapLength) + GapLength;
+      std::string strGenome(genomeLength, 'A');
+      for (auto& c : strGenome) c = Bases[base(generator)];
+
+      std::vector<GenomeInterval> vContigs, vReads;
+      for (uint32_t i = 0; i < NumContigs; i++) {
+        uint32_t start = GapLength + i * (ContigLength + GapLength);
+        vContigs.push_back({strPrefix + "ctg" + std::to_string(i + 1), start, start + ContigLength, true});
+        ssContigs << ">" << vContigs.back().name << "\n" << strGenome.substr(start, ContigLength) << "\n";
+      }
+      for (uint32_t i = 0; i < NumReads; i++) {
+        uint32_t length = readLength(generator);
+        uint32_t start = std::uniform_int_distribution<uint32_t>(0, genomeLength - length)(generator);
+        vReads.push_back({strPrefix + "read" + std::to_string(i + 1), start, start + length, strand(generator) == 1});
+        std::string strRead = strGenome.substr(start, length);
+        if (!vReads.back().forward) strRead = _bioReverseComplement(strRead);
+        ssReads << "@" << vReads.back().name << "\n" << strRead << "\n+\n" << std::string(length, 'I') << "\n";
+      }
+
+      for (auto const& read : vReads) {
+        for (auto const& contig : vContigs) {
+          uint32_t start = std::max(read.start, contig.start), end = std::min(read.end, contig.end);
+          if (end >= start + MinOverlap) writePafLine(ssR2C, read, contig, start, end, generator);
+        }
+      }
+      for (uint32_t i = 0; i < vReads.size(); i++) {
+        for (uint32_t j = i + 1; j < vReads.size(); j++) {
+          uint32_t start = std::max(vReads[i].start, vReads[j].start), end = std::min(vReads[i].end, vReads[j].end);
+          if (end >= start + MinOverlap) writePafLine(ssR2R, vReads[i], vReads[j], start, end, generator);
+        }
+      }
+    }
+
+    writeFile(strDir + "/reads.fastq", ssReads.str());
+    writeFile(strDir + "/contigs.fasta", ssContigs.str());
+    writeFile(strDir + "/readsToContigs.paf", ssR2C.str());
+    writeFile(strDir + "/readsToReads.paf", ssR2R.str());
+  }
+
+}
+}
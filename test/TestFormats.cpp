@@ -0,0 +1,158 @@
+#include "TestUtils.h"
+#include "SBridger.h"
+#include "OverlapCache.h"
+#include "Sequence.h"
+
+#include <iterator>
+#include <algorithm>
+
+namespace scara {
+namespace test {
+
+  // Overlap cache gives the same overlaps as the PAF file while the file does not change, a cache file
+  // can be used instead of the PAF file
+  SCARA_TEST(overlap_cache_round_trip) {
+    TemporaryDirectory dataset;
+    writeSyntheticDataset(dataset.path(), 44);
+    for (auto const& strPaf : {dataset.path() + "/readsToContigs.paf", dataset.path() + "/readsToReads.paf"}) {
+      VecOvl vParsed;
+      parseProcessPaf(strPaf, vParsed, quietConfig());
+      CHECK(findOverlapCache(strPaf).empty());
+
+      std::string strCache = strPaf + OverlapCacheSuffix;
+      writeOverlapCache(strPaf, strCache, DL_NONE);
+      CHECK_EQ(findOverlapCache(strPaf), strCache);
+      CHECK_EQ(findOverlapCache(strCache), strCache);
+
+      ScaraConfig config = quietConfig();
+      config.multithreading = 1;
+      for (uint32_t numThreads : {1u, 4u}) {
+        config.NumThreads = numThreads;
+        VecOvl vCached;
+        parseProcessPaf(strPaf, vCached, config);
+        CHECK_EQ(countDifferentOverlaps(vParsed, vCached), (uint32_t)0);
+      }
+      VecOvl vBatches;
+      readOverlapCacheBatches(strCache, 1000, [&](VecOvl&& vBatch) {
+        std::move(vBatch.begin(), vBatch.end(), std::back_inserter(vBatches));
+        return true;
+      });
+      CHECK_EQ(countDifferentOverlaps(vParsed, vBatches), (uint32_t)0);
+
+      // Same size, changed contents: the cache is not used any more
+      std::string strData = readFile(strPaf);
+      size_t pos = strData.find("\t60\t");
+      CHECK(pos != std::string::npos);
+      strData.replace(pos, 4, "\t59\t");
+      writeFile(strPaf, strData);
+      CHECK(findOverlapCache(strPaf).empty());
+    }
+  }
+
+  // Graph loaded from an index has the same edges as the graph built from overlaps, an index built with
+  // different filtering parameters is rejected
+  SCARA_TEST(graph_index_round_trip) {
+    TemporaryDirectory dataset;
+    writeSyntheticDataset(dataset.path(), 45);
+    std::string strReads = dataset.path() + "/reads.fastq", strContigs = dataset.path() + "/contigs.fasta";
+    std::string strR2C = dataset.path() + "/readsToContigs.paf", strR2R = dataset.path() + "/readsToReads.paf";
+    std::string strIndex = dataset.path() + "/graph.index";
+
+    ScaraConfig config = quietConfig();
+    config.SaveGraphFile = strIndex;
+    SBridger built(config, strReads, strContigs, strR2C, strR2R);
+    built.generateGraph();
+    std::string strBuilt = graphSignature(built);
+
+    config = quietConfig();
+    config.LoadGraphFile = strIndex;
+    SBridger loaded(config, strReads, strContigs, "", "");
+    loaded.generateGraph();
+    CHECK(graphSignature(loaded) == strBuilt);
+
+    config.SImin = 0.7f;
+    SBridger mismatched(config, strReads, strContigs, "", "");
+    bool rejected = false;
+    try {
+      mismatched.generateGraph();
+    } catch (const std::runtime_error&) {
+      rejected = true;
+    }
+    CHECK(rejected);
+  }
+
+  // Runs the phases after resumed as scara does, writing checkpoints into the checkpoint directory if set,
+  // returns the output sequences independent of the strand
+  static std::vector<std::string> runFromCheckpoint(SBridger& sbridger, CheckpointPhase resumed, std::string& strGraph) {
+    bool writeCheckpoints = !sbridger.getConfig().CheckpointDir.empty();
+    if (resumed < CP_GRAPH) {
+      sbridger.generateGraph();
+      if (writeCheckpoints) sbridger.saveCheckpoint(CP_GRAPH);
+    }
+    if (resumed <= CP_GRAPH) strGraph = graphSignature(sbridger);
+    sbridger.cleanupGraph();
+    if (resumed < CP_PATHS) {
+      sbridger.generatePaths();
+      if (writeCheckpoints) sbridger.saveCheckpoint(CP_PATHS);
+    }
+    if (resumed < CP_SCAFFOLDS) {
+      sbridger.groupAndProcessPaths();
+      if (writeCheckpoints) sbridger.saveCheckpoint(CP_SCAFFOLDS);
+    }
+    TemporaryFile output(".fasta");
+    sbridger.generateSequences(output.path(), 1);
+    return canonicalSequences(readFastaRecords(output.path()));
+  }
+
+  // A run resumed after any phase gives the same graph and scaffolds as the run that wrote the checkpoints,
+  // checkpoints written with different path parameters are not used
+  SCARA_TEST(checkpoint_round_trip) {
+    TemporaryDirectory dataset;
+    writeSyntheticDataset(dataset.path(), 46);
+    std::string strReads = dataset.path() + "/reads.fastq", strContigs = dataset.path() + "/contigs.fasta";
+    std::string strR2C = dataset.path() + "/readsToContigs.paf", strR2R = dataset.path() + "/readsToReads.paf";
+
+    ScaraConfig config = quietConfig();
+    config.CheckpointDir = dataset.path() + "/checkpoints";
+    std::string strGraph;
+    std::vector<std::string> vSequences;
+    {
+      SBridger sbridger(config, strReads, strContigs, strR2C, strR2R);
+      vSequences = runFromCheckpoint(sbridger, CP_NONE, strGraph);
+    }
+    CHECK(!vSequences.empty());
+
+    for (CheckpointPhase phase : {CP_GRAPH, CP_PATHS, CP_SCAFFOLDS}) {
+      ScaraConfig resumeConfig = config;
+      resumeConfig.ResumeFrom = phase;
+      SBridger sbridger(resumeConfig, strReads, strContigs, strR2C, strR2R);
+      CheckpointPhase resumed = sbridger.resumeFromCheckpoint(phase);
+      CHECK_EQ(resumed, phase);
+      std::string strResumedGraph;
+      std::vector<std::string> vResumed = runFromCheckpoint(sbridger, resumed, strResumedGraph);
+      CHECK(vResumed == vSequences);
+      if (phase == CP_GRAPH) CHECK(strResumedGraph == strGraph);
+    }
+
+    // Paths were generated with a different number of Monte Carlo paths, the run continues after the graph phase
+    config.ResumeFrom = CP_SCAFFOLDS;
+    config.MinMCPaths += 10;
+    SBridger mismatched(config, strReads, strContigs, strR2C, strR2R);
+    CHECK_EQ(mismatched.resumeFromCheckpoint(CP_SCAFFOLDS), CP_GRAPH);
+
+    // Checkpoint directory can not be created
+    config = quietConfig();
+    config.CheckpointDir = strReads + "/checkpoints";
+    SBridger unwritable(config, strReads, strContigs, strR2C, strR2R);
+    unwritable.generateGraph();
+    bool rejected = false;
+    try {
+      unwritable.saveCheckpoint(CP_GRAPH);
+    } catch (const std::runtime_error&) {
+      rejected = true;
+    }
+    CHECK(rejected);
+  }
+
+}
+}
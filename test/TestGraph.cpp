@@ -0,0 +1,564 @@
+#include "TestUtils.h"
+#include "SBridger.h"
+#include "Overlap.h"
+
+#include <iomanip>
+#include <algorithm>
+#include <random>
+#include <memory>
+#include <map>
+#include <functional>
+#include <set>
+#include <sstream>
+
+namespace scara {
+namespace test {
+
+  static std::string edgeSignature(const Edge& edge) {
+    std::ostringstream ss;
+    ss << std::setprecision(9);
+    ss << edge.startNode->nName << ">" << edge.endNode->nName << " " << edge.SLen << "," << edge.SStart << "," << edge.SEnd << ","
+       << edge.ELen << "," << edge.EStart << "," << edge.EEnd << "," << edge.ovl_bOrientation << "," << edge.paf_matching_bases << ","
+       << edge.paf_overlap_length << "," << edge.paf_mapping_quality << "," << edge.QOH1 << "," << edge.QOH2 << "," << edge.TOH1 << ","
+       << edge.TOH2 << "," << edge.QOL << "," << edge.TOL << "," << edge.SI << "," << edge.OS << "," << edge.QES1 << "," << edge.QES2
+       << "," << edge.TES1 << "," << edge.TES2;
+    return ss.str();
+  }
+
+  std::string graphSignature(const SBridger& sbridger) {
+    std::string strSignature;
+    for (auto const* mNodes : {&sbridger.mAnchorNodes, &sbridger.mReadNodes}) {
+      for (auto const& it : *mNodes) {
+        strSignature += it.first + ":";
+        for (auto const& edge_ptr : it.second->vOutEdges) strSignature += " " + edgeSignature(*edge_ptr);
+        strSignature += "\n";
+      }
+    }
+    return strSignature;
+  }
+
+  static std::string buildGraph(const std::string& strDir, const ScaraConfig& config) {
+    SBridger sbridger(config, strDir + "/reads.fastq", strDir + "/contigs.fasta", strDir + "/readsToContigs.paf", strDir + "/readsToReads.paf");
+    sbridger.generateGraph();
+    return graphSignature(sbridger);
+  }
+
+  // Number of usable edges in a graph signature
+  static uint32_t countEdges(const std::string& strSignature) {
+    return std::count(strSignature.begin(), strSignature.end(), '>');
+  }
+
+  // Edges built from overlaps parsed in batches are the same as edges built from all overlaps, in the same order
+  SCARA_TEST(graph_pipelined_matches_serial) {
+    TemporaryDirectory dataset;
+    writeSyntheticDataset(dataset.path(), 41);
+    ScaraConfig config = quietConfig();
+    std::string strSerial = buildGraph(dataset.path(), config);
+    CHECK(countEdges(strSerial) > 1000);
+
+    config.PipelineGraph = true;
+    CHECK(buildGraph(dataset.path(), config) == strSerial);
+    config.multithreading = 1;
+    for (uint32_t numThreads : {1u, 2u, 8u}) {
+      config.NumThreads = numThreads;
+      CHECK(buildGraph(dataset.path(), config) == strSerial);
+    }
+  }
+
+  // Edges built by several threads from loaded overlaps are the same as edges built by a single thread, in the same order
+  SCARA_TEST(graph_parallel_matches_serial) {
+    TemporaryDirectory dataset;
+    writeSyntheticDataset(dataset.path(), 42, 2);
+    ScaraConfig config = quietConfig();
+    std::string strSerial = buildGraph(dataset.path(), config);
+    CHECK(countEdges(strSerial) > 1000);
+
+    config.multithreading = 1;
+    for (uint32_t numThreads : {2u, 3u, 8u, 64u}) {
+      config.NumThreads = numThreads;
+      CHECK(buildGraph(dataset.path(), config) == strSerial);
+    }
+  }
+
+  // Input files loaded concurrently, with worker threads split between the two overlap files, give the same graph
+  // (edges follow overlaps in file order) and scaffolds as files loaded one after another; a missing file is reported in both modes
+  SCARA_TEST(inputs_loaded_concurrently_match_serial) {
+    TemporaryDirectory dataset;
+    writeSyntheticDataset(dataset.path(), 40, 2);
+    const std::string strDir = dataset.path();
+    for (int variant = 0; variant < 3; variant++) {
+      ScaraConfig config = deterministicConfig();
+      config.PackReads = (variant == 1);
+      config.MapSequences = (variant == 2);
+      const std::string strGraph = buildGraph(strDir, config);
+      CHECK(countEdges(strGraph) > 1000);
+      const auto vScaffolds = canonicalSequences(scaffoldDataset(strDir, config));
+      CHECK(!vScaffolds.empty());
+
+      config.multithreading = 1;
+      for (uint32_t numThreads : {1u, 2u, 3u, 8u}) {
+        config.NumThreads = numThreads;
+        CHECK(buildGraph(strDir, config) == strGraph);
+        CHECK(canonicalSequences(scaffoldDataset(strDir, config)) == vScaffolds);
+      }
+    }
+
+    for (int multithreading : {0, 1}) {
+      ScaraConfig config = quietConfig();
+      config.multithreading = multithreading;
+      config.NumThreads = 4;
+      bool thrown = false;
+      try {
+        SBridger sbridger(config, strDir + "/reads.fastq", strDir + "/contigs.fasta", strDir + "/missing.paf", strDir + "/readsToReads.paf");
+      } catch (const std::runtime_error&) {
+        thrown = true;
+      }
+      CHECK(thrown);
+    }
+  }
+
+  // Reference for createTestedEdges: edges created for each overlap one by one and tested with Edge::test()
+  static void createTestedEdgesReference(const VecOvl& vOvl, MapIdToNode& mAnchorNodes, MapIdToNode& mReadNodes
+                                         , std::vector<shared_ptr<Edge>>& vEdges, EdgeTestCounts& counts, const ScaraConfig& config) {
+    for (auto const& ovl_ptr : vOvl) {
+      if (!ovl_ptr->Test()) continue;
+      std::vector<shared_ptr<Edge>> vOvlEdges;
+      createEdgesFromOverlap(ovl_ptr, mAnchorNodes, mReadNodes, vOvlEdges);
+      for (auto& edge_ptr : vOvlEdges) {
+        switch (edge_ptr->test(config)) {
+          case -1: counts.contained++; break;
+          case -2: counts.shortEdges++; break;
+          case -3: counts.lowqual++; break;
+          case -4: counts.zero++; break;
+          default:
+            counts.usable++;
+            vEdges.emplace_back(edge_ptr);
+            break;
+        }
+      }
+    }
+  }
+
+  // Batched scoring gives the same usable edges (with all scores) and the same counts as Edge::test(), for overlaps
+  // of a synthetic dataset and random overlaps with overhangs, with different filtering parameters
+  SCARA_TEST(edge_scoring_matches_edge_test) {
+    TemporaryDirectory dataset;
+    writeSyntheticDataset(dataset.path(), 43);
+    MapIdToSeq mIdToRead, mIdToContig;
+    parseProcessFastq(dataset.path() + "/reads.fastq", mIdToRead, quietConfig());
+    parseProcessFasta(dataset.path() + "/contigs.fasta", mIdToContig, quietConfig());
+    MapIdToNode mAnchorNodes, mReadNodes;
+    for (auto const& it : mIdToContig) {
+      mAnchorNodes.emplace(it.first, make_shared<Node>(it.second, NT_ANCHOR, false));
+      mAnchorNodes.emplace(it.first + "_RC", make_shared<Node>(it.second, NT_ANCHOR, true));
+    }
+    for (auto const& it : mIdToRead) {
+      mReadNodes.emplace(it.first, make_shared<Node>(it.second, NT_READ, false));
+      mReadNodes.emplace(it.first + "_RC", make_shared<Node>(it.second, NT_READ, true));
+    }
+
+    VecOvl vOvl;
+    parseProcessPaf(dataset.path() + "/readsToContigs.paf", vOvl, quietConfig());
+    parseProcessPaf(dataset.path() + "/readsToReads.paf", vOvl, quietConfig());
+    std::mt19937 generator(43);
+    std::vector<std::pair<std::string, uint32_t>> vSeqs;
+    for (auto const* mIdToSeq : {&mIdToRead, &mIdToContig}) {
+      for (auto const& it : *mIdToSeq) vSeqs.emplace_back(it.first, it.second->length());
+    }
+    std::uniform_int_distribution<uint32_t> seqDist(0, vSeqs.size() - 1);
+    for (uint32_t i = 0; i < 5000; i++) {
+      auto const& query = vSeqs[seqDist(generator)];
+      auto const& target = vSeqs[seqDist(generator)];
+      if (query.first == target.first) continue;
+      uint32_t qBegin = std::uniform_int_distribution<uint32_t>(0, query.second - 1)(generator);
+      uint32_t qEnd = std::uniform_int_distribution<uint32_t>(qBegin + 1, query.second)(generator);
+      uint32_t tBegin = std::uniform_int_distribution<uint32_t>(0, target.second - 1)(generator);
+      uint32_t tEnd = std::uniform_int_distribution<uint32_t>(tBegin + 1, target.second)(generator);
+      uint32_t ovlLength = std::max(qEnd - qBegin, tEnd - tBegin);
+      uint32_t matching = std::uniform_int_distribution<uint32_t>(0, ovlLength)(generator);
+      vOvl.emplace_back(new Overlap(query.first.c_str(), query.first.length(), query.second, qBegin, qEnd, (i % 2) ? '+' : '-',
+                                    target.first.c_str(), target.first.length(), target.second, tBegin, tEnd, matching, ovlLength, 60));
+    }
+
+    std::vector<ScaraConfig> vConfigs(4, quietConfig());
+    vConfigs[1].SImin = 0.9f;
+    vConfigs[1].OHmax = 0.05f;
+    vConfigs[2].test_short_length = vConfigs[2].test_contained_reads = false;
+    vConfigs[3].test_low_quality = false;
+    vConfigs[3].OHmax = 1.5f;
+    for (auto const& config : vConfigs) {
+      std::vector<shared_ptr<Edge>> vEdges, vReference;
+      EdgeTestCounts counts, countsReference;
+      createTestedEdges(vOvl.begin(), vOvl.end(), mAnchorNodes, mReadNodes, vEdges, counts, config);
+      createTestedEdgesReference(vOvl, mAnchorNodes, mReadNodes, vReference, countsReference, config);
+
+      CHECK(counts.usable > 0);
+      CHECK_EQ(counts.usable, countsReference.usable);
+      CHECK_EQ(counts.contained, countsReference.contained);
+      CHECK_EQ(counts.shortEdges, countsReference.shortEdges);
+      CHECK_EQ(counts.lowqual, countsReference.lowqual);
+      CHECK_EQ(counts.zero, countsReference.zero);
+      CHECK_EQ(vEdges.size(), vReference.size());
+      uint32_t numDifferent = 0;
+      for (size_t i = 0; i < std::min(vEdges.size(), vReference.size()); i++) {
+        if (edgeSignature(*vEdges[i]) != edgeSignature(*vReference[i])) numDifferent++;
+      }
+      CHECK_EQ(numDifferent, (uint32_t)0);
+    }
+  }
+
+
+  // Graph of a synthetic dataset, for path tests
+  static std::unique_ptr<SBridger> syntheticGraph(const std::string& strDir, uint32_t seed) {
+    writeSyntheticDataset(strDir, seed);
+    std::unique_ptr<SBridger> sbridger(new SBridger(deterministicConfig(), strDir + "/reads.fastq", strDir + "/contigs.fasta"
+                                                    , strDir + "/readsToContigs.paf", strDir + "/readsToReads.paf"));
+    sbridger->generateGraph();
+    return sbridger;
+  }
+
+  // Edges of a path in path direction, as seen from the path
+  static std::string pathSignature(Path& path) {
+    std::ostringstream ss;
+    ss << std::setprecision(9);
+    for (uint32_t i = 0; i < (uint32_t)path.size(); i++) {
+      EdgeView edge = path.edgeAt(i);
+      ss << edge.startNode()->nName << ">" << edge.endNode()->nName << " " << edge.SLen() << "," << edge.SStart() << ","
+         << edge.SEnd() << "," << edge.ELen() << "," << edge.EStart() << "," << edge.EEnd() << "," << edge.SI() << ","
+         << edge.direction() << " ";
+    }
+    return ss.str();
+  }
+
+  // Path groups in order of creation, with the best path of each group
+  static std::string groupsSignature(const PathAggregator& paths) {
+    std::ostringstream ss;
+    ss << std::setprecision(17);
+    for (auto const& pgroup_ptr : paths.vPathGroups) {
+      ss << pgroup_ptr->startNodeName << ">" << pgroup_ptr->endNodeName << " " << pgroup_ptr->length << " " << pgroup_ptr->numPaths
+         << " " << pgroup_ptr->bestPathInfo->avgSI << " " << pathSignature(*pgroup_ptr->bestPathInfo->path_ptr) << "\n";
+    }
+    return ss.str();
+  }
+
+  // Paths grouped while they are generated (streaming) give the same groups, counts and best paths as paths
+  // grouped after generation, also when paths are generated repeatedly; scaffolds are the same
+  SCARA_TEST(path_streaming_matches_grouping) {
+    TemporaryDirectory dataset;
+    auto sbridger = syntheticGraph(dataset.path(), 27);
+    ScaraConfig config = deterministicConfig();
+    PathAggregator batch(false, config.PathGroupHalfSize), stream(true, config.PathGroupHalfSize);
+    for (auto* paths : {&batch, &stream}) {
+      generatePathsDeterministic(*paths, sbridger->mAnchorNodes, PGT_MAXOS, config);
+      generatePathsDeterministic(*paths, sbridger->mAnchorNodes, PGT_MAXES, config);
+    }
+    std::vector<shared_ptr<Path>> vGenerated = batch.vPaths;
+    CHECK(vGenerated.size() > 10);
+    for (uint32_t i = 0; i < vGenerated.size(); i++) {
+      for (uint32_t k = 0; k < i % 3; k++) {
+        batch.addPath(vGenerated[i]);
+        stream.addPath(vGenerated[i]);
+      }
+    }
+    for (uint32_t i = 0; i < batch.vPaths.size(); i++) batch.groupPath(batch.vPaths[i], batch.vPathCounts[i]);
+
+    CHECK_EQ(stream.numPaths, batch.numPaths);
+    CHECK(stream.vPaths.empty());
+    CHECK(!batch.vPathGroups.empty());
+    CHECK(groupsSignature(stream) == groupsSignature(batch));
+    uint32_t numGrouped = 0;
+    for (auto const& pgroup_ptr : stream.vPathGroups) {
+      numGrouped += pgroup_ptr->numPaths;
+      CHECK(pgroup_ptr->vPathInfos.empty());
+    }
+    CHECK_EQ(numGrouped, stream.numPaths);
+
+    config.StreamPaths = true;
+    auto vStreamed = canonicalSequences(scaffoldDataset(dataset.path(), config));
+    config.StreamPaths = false;
+    auto vGrouped = canonicalSequences(scaffoldDataset(dataset.path(), config));
+    CHECK_EQ(vGrouped.size(), (size_t)1);
+    CHECK(vStreamed == vGrouped);
+  }
+
+
+  // Distinct deterministic paths through the graph
+  static std::vector<shared_ptr<Path>> deterministicPaths(SBridger& sbridger) {
+    ScaraConfig config = deterministicConfig();
+    PathAggregator paths(false, config.PathGroupHalfSize);
+    generatePathsDeterministic(paths, sbridger.mAnchorNodes, PGT_MAXOS, config);
+    generatePathsDeterministic(paths, sbridger.mAnchorNodes, PGT_MAXES, config);
+    return paths.vPaths;
+  }
+
+  static shared_ptr<Path> copyPath(const std::vector<shared_ptr<Edge>>& edges) {
+    auto path_ptr = make_shared<Path>();
+    for (auto const& edge_ptr : edges) path_ptr->appendEdge(edge_ptr);
+    return path_ptr;
+  }
+
+  // Paths with the same edges are stored once, in order of their first occurrence, with the number of times they
+  // were added; paths sharing a prefix are distinct
+  SCARA_TEST(paths_interned_with_counts) {
+    TemporaryDirectory dataset;
+    auto sbridger = syntheticGraph(dataset.path(), 28);
+    std::vector<shared_ptr<Path>> vGenerated = deterministicPaths(*sbridger);
+    CHECK(vGenerated.size() > 10);
+
+    // Copies of generated paths (separate objects with the same edges) and their prefixes, in random order
+    std::vector<shared_ptr<Path>> vInput;
+    for (uint32_t i = 0; i < vGenerated.size(); i++) {
+      auto const& edges = vGenerated[i]->edges;
+      for (uint32_t k = 0; k <= i % 4; k++) vInput.emplace_back(copyPath(edges));
+      if (edges.size() > 2) {
+        vInput.emplace_back(copyPath(std::vector<shared_ptr<Edge>>(edges.begin(), edges.end() - 1)));
+        // Same prefix and length, another edge at the end
+        for (auto const& edge_ptr : edges[edges.size() - 2]->endNode->vOutEdges) {
+          if (edge_ptr == edges.back()) continue;
+          std::vector<shared_ptr<Edge>> vSibling(edges.begin(), edges.end() - 1);
+          vSibling.emplace_back(edge_ptr);
+          vInput.emplace_back(copyPath(vSibling));
+          break;
+        }
+      }
+    }
+    std::mt19937 generator(28);
+    std::shuffle(vInput.begin(), vInput.end(), generator);
+
+    std::vector<std::vector<const Edge*>> vReference;
+    std::vector<uint32_t> vReferenceCounts;
+    std::map<std::vector<const Edge*>, uint32_t> mReference;
+    PathAggregator interned(false, deterministicConfig().PathGroupHalfSize);
+    for (auto const& path_ptr : vInput) {
+      interned.addPath(path_ptr);
+      std::vector<const Edge*> vEdges;
+      for (auto const& edge_ptr : path_ptr->edges) vEdges.emplace_back(edge_ptr.get());
+      auto res = mReference.emplace(vEdges, (uint32_t)vReference.size());
+      if (res.second) {
+        vReference.emplace_back(vEdges);
+        vReferenceCounts.emplace_back(0);
+      }
+      vReferenceCounts[res.first->second]++;
+    }
+
+    CHECK_EQ(interned.numPaths, (uint32_t)vInput.size());
+    CHECK_EQ(interned.vPaths.size(), vReference.size());
+    CHECK(interned.vPathCounts == vReferenceCounts);
+    uint32_t numDifferent = 0;
+    for (uint32_t i = 0; i < std::min(interned.vPaths.size(), vReference.size()); i++) {
+      std::vector<const Edge*> vEdges;
+      for (auto const& edge_ptr : interned.vPaths[i]->edges) vEdges.emplace_back(edge_ptr.get());
+      if (vEdges != vReference[i]) numDifferent++;
+    }
+    CHECK_EQ(numDifferent, (uint32_t)0);
+  }
+
+
+  // Path metrics computed from all edges of a path, as before they were maintained incrementally
+  struct PathMetrics {
+    double length;
+    uint32_t length2;
+    double avgSI;
+    uint32_t numNegativeExtensions;
+    bool consistent;
+    Direction direction;
+
+    bool operator==(const PathMetrics& other) const {
+      return length == other.length && length2 == other.length2 && avgSI == other.avgSI
+          && numNegativeExtensions == other.numNegativeExtensions && consistent == other.consistent && direction == other.direction;
+    }
+  };
+
+  static PathMetrics recomputedMetrics(const std::vector<shared_ptr<Edge>>& edges) {
+    PathMetrics metrics = {0.0, 0, 0.0, 0, true, D_LEFT};
+    if (edges.empty()) return metrics;
+    int64_t extLength = 0;
+    double sumSI = 0.0;
+    metrics.direction = edges.front()->direction();
+    for (auto const& edge_ptr : edges) {
+      extLength += (int64_t)(edge_ptr->ELen - edge_ptr->EEnd) - (int64_t)(edge_ptr->SLen - edge_ptr->SEnd);
+      metrics.length2 += edge_ptr->SStart - edge_ptr->EStart;
+      sumSI += edge_ptr->SI;
+      if ((edge_ptr->SStart <= edge_ptr->EStart) || ((edge_ptr->ELen - edge_ptr->EEnd) <= (edge_ptr->SLen - edge_ptr->SEnd))) {
+        metrics.numNegativeExtensions++;
+      }
+      if (edge_ptr->direction() != metrics.direction) metrics.consistent = false;
+    }
+    metrics.length = edges.front()->SLen + extLength;
+    metrics.length2 += edges.back()->ELen;
+    metrics.avgSI = sumSI / edges.size();
+    return metrics;
+  }
+
+  static PathMetrics pathMetrics(Path& path) {
+    return {path.length(), path.length2(), path.avgSI(), path.numNegativeExtensions(), path.isConsistent(), path.direction()};
+  }
+
+  // Random walk from an anchor node, edges (some of them on the other strand) are appended and removed at random,
+  // fn is called after each step
+  static void randomWalk(SBridger& sbridger, std::mt19937& generator, std::function<void(Path&)> fn) {
+    std::vector<shared_ptr<Node>> vAnchors;
+    for (auto const& it : sbridger.mAnchorNodes) {
+      if (!it.second->vOutEdges.empty()) vAnchors.emplace_back(it.second);
+    }
+    auto const& aNode = vAnchors[std::uniform_int_distribution<size_t>(0, vAnchors.size() - 1)(generator)];
+    Path path(aNode->vOutEdges[std::uniform_int_distribution<size_t>(0, aNode->vOutEdges.size() - 1)(generator)]);
+    fn(path);
+    for (uint32_t step = 0; step < 40; step++) {
+      auto const& vOutEdges = path.endNode()->vOutEdges;
+      if (path.size() > 1 && (vOutEdges.empty() || std::uniform_int_distribution<uint32_t>(0, 3)(generator) == 0)) {
+        path.removeLastEdge();
+      } else if (!vOutEdges.empty()) {
+        auto const& edge_ptr = vOutEdges[std::uniform_int_distribution<size_t>(0, vOutEdges.size() - 1)(generator)];
+        if (std::uniform_int_distribution<uint32_t>(0, 7)(generator) > 0) {
+          path.appendEdge(edge_ptr);
+        } else {
+          // Copy of the edge with both nodes on the other strand, it changes direction and extends backwards
+          auto reversed_ptr = make_shared<Edge>(*edge_ptr);
+          reversed_ptr->reverseStrand();
+          path.appendEdge(reversed_ptr);
+        }
+      }
+      fn(path);
+    }
+  }
+
+  // Metrics maintained while edges are appended and removed are the same as metrics computed from all edges,
+  // for generated paths and for random walks through the graph
+  SCARA_TEST(path_metrics_match_recomputed) {
+    TemporaryDirectory dataset;
+    auto sbridger = syntheticGraph(dataset.path(), 29);
+    uint32_t numChecked = 0, numDifferent = 0, numInconsistent = 0, numNegative = 0;
+    auto checkMetrics = [&](Path& path) {
+      PathMetrics metrics = recomputedMetrics(path.edges);
+      if (!(pathMetrics(path) == metrics)) numDifferent++;
+      if (!metrics.consistent) numInconsistent++;
+      if (metrics.numNegativeExtensions > 0) numNegative++;
+      numChecked++;
+    };
+    for (auto const& path_ptr : deterministicPaths(*sbridger)) checkMetrics(*path_ptr);
+    std::mt19937 generator(29);
+    for (uint32_t i = 0; i < 500; i++) randomWalk(*sbridger, generator, checkMetrics);
+
+    CHECK(numChecked > 10000);
+    CHECK_EQ(numDifferent, (uint32_t)0);
+    // Random walks change direction and extend backwards, so all metrics are exercised
+    CHECK(numInconsistent > 0);
+    CHECK(numNegative > 0);
+  }
+
+
+  // Reversed path built explicitly, with a reversed copy of each edge, as before reversed paths were views
+  static shared_ptr<Path> reversedCopy(Path& path) {
+    auto reversed_ptr = make_shared<Path>();
+    for (auto it = path.edges.rbegin(); it != path.edges.rend(); it++) reversed_ptr->appendEdge((*it)->getReversedEdge());
+    return reversed_ptr;
+  }
+
+  // A reversed view of a path has the same edges (as seen from the path), nodes and metrics as an explicitly
+  // reversed copy; reversing the view gives the original path
+  SCARA_TEST(reversed_path_matches_copy) {
+    TemporaryDirectory dataset;
+    auto sbridger = syntheticGraph(dataset.path(), 30);
+    uint32_t numChecked = 0, numDifferent = 0;
+    auto checkReversed = [&](Path& path) {
+      shared_ptr<Path> path_ptr = copyPath(path.edges);
+      shared_ptr<Path> view_ptr = path_ptr->reversedPath();
+      shared_ptr<Path> copy_ptr = reversedCopy(path);
+      numChecked++;
+      if (!view_ptr->isReversed() || view_ptr->reversedPath() != path_ptr || view_ptr->size() != copy_ptr->size()
+          || view_ptr->startNode() != copy_ptr->startNode() || view_ptr->endNode() != copy_ptr->endNode()
+          || pathSignature(*view_ptr) != pathSignature(*copy_ptr) || !(pathMetrics(*view_ptr) == pathMetrics(*copy_ptr))) {
+        numDifferent++;
+      }
+    };
+    for (auto const& path_ptr : deterministicPaths(*sbridger)) checkReversed(*path_ptr);
+    std::mt19937 generator(30);
+    for (uint32_t i = 0; i < 200; i++) randomWalk(*sbridger, generator, checkReversed);
+
+    CHECK(numChecked > 1000);
+    CHECK_EQ(numDifferent, (uint32_t)0);
+  }
+
+
+  // A graph constructed with the least strict SImin and OHmax of a sweep, restricted for each pair of values with Edge::test,
+  // is the same as the graph constructed with that pair; the sweep gives the same scaffolds as runs with each setting
+  SCARA_TEST(sweep_filtered_graph_matches_direct) {
+    TemporaryDirectory dataset;
+    writeSyntheticDataset(dataset.path(), 47, 2);
+    const std::string strDir = dataset.path();
+    ParameterSweep sweep;
+    sweep.vSImin = {0.9f, 0.6f, 0.99f};
+    sweep.vOHmax = {0.25f, 0.05f};
+    sweep.vMinPathsinGroup = {1, 3};
+    sweep.vPathGroupHalfSize = {500};
+
+    ScaraConfig relaxedConfig = deterministicConfig();
+    relaxedConfig.SImin = 0.6f;
+    relaxedConfig.OHmax = 0.25f;
+    SBridger relaxed(relaxedConfig, strDir + "/reads.fastq", strDir + "/contigs.fasta", strDir + "/readsToContigs.paf", strDir + "/readsToReads.paf");
+    relaxed.generateGraph();
+    std::vector<std::pair<std::shared_ptr<Node>, std::vector<std::shared_ptr<Edge>>>> vFullEdges;
+    for (auto const* mNodes : {&relaxed.mAnchorNodes, &relaxed.mReadNodes}) {
+      for (auto const& it : *mNodes) vFullEdges.emplace_back(it.second, it.second->vOutEdges);
+    }
+
+    std::set<uint32_t> sNumEdges;
+    std::map<std::pair<float, float>, uint32_t> mNumEdges;
+    for (float SImin : sweep.vSImin) {
+      for (float OHmax : sweep.vOHmax) {
+        ScaraConfig config = deterministicConfig();
+        config.SImin = SImin;
+        config.OHmax = OHmax;
+        for (auto const& it : vFullEdges) {
+          it.first->vOutEdges.clear();
+          for (auto const& edge_ptr : it.second) {
+            if (edge_ptr->test(config) == 1) it.first->vOutEdges.emplace_back(edge_ptr);
+          }
+        }
+        std::string strDirect = buildGraph(strDir, config);
+        CHECK(graphSignature(relaxed) == strDirect);
+        mNumEdges[std::make_pair(SImin, OHmax)] = countEdges(strDirect);
+        sNumEdges.emplace(countEdges(strDirect));
+      }
+    }
+    CHECK(sNumEdges.size() > 2);
+
+    for (int multithreading : {0, 1}) {
+      ScaraConfig config = deterministicConfig();
+      config.multithreading = multithreading;
+      config.NumThreads = 4;
+      TemporaryDirectory sweepDir;
+      SBridger sweepBridger(config, strDir + "/reads.fastq", strDir + "/contigs.fasta", strDir + "/readsToContigs.paf", strDir + "/readsToReads.paf");
+      CHECK_EQ(sweepBridger.runSweep(sweep, sweepDir.path()), 12);
+
+      std::istringstream summary(readFile(sweepDir.path() + "/summary.tsv"));
+      std::string strLine;
+      std::getline(summary, strLine);
+      uint32_t numSettings = 0;
+      std::set<std::vector<std::string>> sScaffolds;
+      while (std::getline(summary, strLine)) {
+        std::istringstream ssLine(strLine);
+        uint32_t setting, minPathsInGroup, numEdges;
+        float SImin, OHmax;
+        double pathGroupHalfSize;
+        ssLine >> setting >> SImin >> OHmax >> minPathsInGroup >> pathGroupHalfSize >> numEdges;
+        CHECK_EQ(numEdges, mNumEdges[std::make_pair(SImin, OHmax)]);
+
+        ScaraConfig directConfig = deterministicConfig();
+        directConfig.SImin = SImin;
+        directConfig.OHmax = OHmax;
+        directConfig.MinPathsinGroup = minPathsInGroup;
+        directConfig.PathGroupHalfSize = pathGroupHalfSize;
+        auto vSweep = canonicalSequences(readFastaRecords(sweepDir.path() + "/scaffolds_" + std::to_string(setting) + ".fasta"));
+        CHECK(vSweep == canonicalSequences(scaffoldDataset(strDir, directConfig)));
+        sScaffolds.emplace(vSweep);
+        numSettings++;
+      }
+      CHECK_EQ(numSettings, (uint32_t)12);
+      CHECK(sScaffolds.size() > 1);
+    }
+  }
+
+}
+}
@@ -0,0 +1,166 @@
+#include "TestUtils.h"
+
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+// Runs the checks of scara, usage: scara_tests <test data folder> [test name]
+// Returns 0 if all checks passed
+
+namespace scara {
+namespace test {
+
+  static std::string strDataDir = "test";
+  static uint32_t numFailedChecks = 0;
+
+  std::vector<TestCase>& testCases(void) {
+    static std::vector<TestCase> vTestCases;
+    return vTestCases;
+  }
+
+  void failCheck(const char* file, int line, const std::string& message) {
+    numFailedChecks++;
+    std::cerr << file << ":" << line << ": check failed: " << message << std::endl;
+  }
+
+  std::string dataFile(const std::string& strName) {
+    return strDataDir + "/" + strName;
+  }
+
+  ScaraConfig quietConfig(void) {
+    ScaraConfig config;
+    config.print_output = false;
+    config.debugLevel = DL_NONE;
+    return config;
+  }
+
+  ScaraConfig deterministicConfig(void) {
+    ScaraConfig config = quietConfig();
+    config.MaxMCIterations = 0;
+    return config;
+  }
+
+  static std::string temporaryTemplate(void) {
+    const char* tmpDir = std::getenv("TMPDIR");
+    return std::string((tmpDir != NULL && tmpDir[0] != 0) ? tmpDir : "/tmp") + "/scara_tests_XXXXXX";
+  }
+
+  TemporaryFile::TemporaryFile(const std::string& strSuffix) {
+    std::string strTemplate = temporaryTemplate() + strSuffix;
+    std::vector<char> fileName(strTemplate.begin(), strTemplate.end());
+    fileName.push_back(0);
+    int fd = mkstemps(fileName.data(), strSuffix.size());
+    if (fd < 0) {
+      throw std::runtime_error("SCARA TESTS: ERROR - unable to create a temporary file " + strTemplate);
+    }
+    close(fd);
+    strFile = fileName.data();
+  }
+
+  TemporaryFile::~TemporaryFile() {
+    std::remove(strFile.c_str());
+    for (auto const& strDerived : vDerived) std::remove(strDerived.c_str());
+  }
+
+  std::string TemporaryFile::derived(const std::string& strSuffix) {
+    vDerived.emplace_back(strFile + strSuffix);
+    return vDerived.back();
+  }
+
+  TemporaryDirectory::TemporaryDirectory() {
+    std::string strTemplate = temporaryTemplate();
+    std::vector<char> dirName(strTemplate.begin(), strTemplate.end());
+    dirName.push_back(0);
+    if (mkdtemp(dirName.data()) == NULL) {
+      throw std::runtime_error("SCARA TESTS: ERROR - unable to create a temporary directory " + strTemplate);
+    }
+    strDir = dirName.data();
+  }
+
+  static void removeRecursive(const std::string& strPath) {
+    struct stat st;
+    if (lstat(strPath.c_str(), &st) != 0) return;
+    if (S_ISDIR(st.st_mode)) {
+      DIR* dir = opendir(strPath.c_str());
+      if (dir != NULL) {
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != NULL) {
+          if (std::strcmp(entry->d_name, ".") == 0 || std::strcmp(entry->d_name, "..") == 0) continue;
+          removeRecursive(strPath + "/" + entry->d_name);
+        }
+        closedir(dir);
+      }
+      rmdir(strPath.c_str());
+    } else {
+      unlink(strPath.c_str());
+    }
+  }
+
+  TemporaryDirectory::~TemporaryDirectory() {
+    removeRecursive(strDir);
+  }
+
+  std::string readFile(const std::string& strFile) {
+    std::ifstream in(strFile, std::ios::binary);
+    if (!in) {
+      throw std::runtime_error("SCARA TESTS: ERROR - unable to read " + strFile);
+    }
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+  }
+
+  void writeFile(const std::string& strFile, const std::string& strData) {
+    std::ofstream out(strFile, std::ios::binary);
+    out << strData;
+    out.close();
+    if (!out) {
+      throw std::runtime_error("SCARA TESTS: ERROR - unable to write " + strFile);
+    }
+  }
+
+  std::vector<std::pair<std::string, std::string>> readFastaRecords(const std::string& strFile) {
+    std::vector<std::pair<std::string, std::string>> vRecords;
+    std::istringstream in(readFile(strFile));
+    std::string strLine;
+    while (std::getline(in, strLine)) {
+      if (strLine.empty()) continue;
+      if (strLine[0] == '>') vRecords.emplace_back(strLine.substr(1), "");
+      else if (!vRecords.empty()) vRecords.back().second += strLine;
+    }
+    return vRecords;
+  }
+
+}
+}
+
+int main(int argc, char **argv) {
+  using namespace scara::test;
+  if (argc > 1) strDataDir = argv[1];
+  std::string strFilter = (argc > 2) ? argv[2] : "";
+
+  uint32_t numRun = 0, numFailed = 0;
+  for (auto const& testCase : testCases()) {
+    if (!strFilter.empty() && strFilter != testCase.name) continue;
+    uint32_t numFailedBefore = numFailedChecks;
+    try {
+      testCase.run();
+    } catch (const std::exception& e) {
+      failCheck(testCase.name, 0, std::string("exception: ") + e.what());
+    }
+    bool passed = (numFailedChecks == numFailedBefore);
+    std::cerr << (passed ? "PASSED " : "FAILED ") << testCase.name << std::endl;
+    numRun++;
+    if (!passed) numFailed++;
+  }
+
+  std::cerr << "SCARA TESTS: " << (numRun - numFailed) << "/" << numRun << " tests passed" << std::endl;
+  return (numRun == 0 || numFailed > 0) ? 1 : 0;
+}
@@ -0,0 +1,173 @@
+#include "TestUtils.h"
+#include "SBridger.h"
+#include "BatchScheduler.h"
+
+#include <stdexcept>
+#include <climits>
+#include <algorithm>
+
+#include <sys/stat.h>
+
+namespace scara {
+namespace test {
+
+  // Valid grids give all values of each parameter in order, parameters that are not given stay empty
+  // Negative, non-numeric, empty, non-finite and too large values are rejected
+  SCARA_TEST(sweep_grid_parsing) {
+    ParameterSweep sweep;
+    CHECK(parseSweepGrid("pSImin=0.5,.6,0.75;pOHmax=0.1;;pMinPathsInGroup=2,3,4294967295;pPathGroupHalfSize=1000,2.5e3", sweep));
+    CHECK(sweep.vSImin == std::vector<float>({0.5f, 0.6f, 0.75f}));
+    CHECK(sweep.vOHmax == std::vector<float>({0.1f}));
+    CHECK(sweep.vMinPathsinGroup == std::vector<uint32_t>({2, 3, 4294967295u}));
+    CHECK(sweep.vPathGroupHalfSize == std::vector<double>({1000, 2500}));
+
+    ParameterSweep sweepSingle;
+    CHECK(parseSweepGrid("pMinPathsInGroup=5", sweepSingle));
+    CHECK(sweepSingle.vSImin.empty() && sweepSingle.vOHmax.empty() && sweepSingle.vPathGroupHalfSize.empty());
+    CHECK(sweepSingle.vMinPathsinGroup == std::vector<uint32_t>({5}));
+
+    for (auto const& strGrid : {"pSImin=-0.5", "pSImin=0.5x", "pSImin=0.5,,0.6", "pSImin=", "pSImin", "pSImin=nan", "pSImin=inf",
+                                "pSImin=1e400", "pOHmax= 0.1", "pMinPathsInGroup=2.5", "pMinPathsInGroup=-1", "pMinPathsInGroup=4294967296",
+                                "pMinPathsInGroup=99999999999999999999999", "pPathGroupHalfSize=abc", "pUnknown=1", "pSImin=0.5;pOHmax"}) {
+      ParameterSweep sweepInvalid;
+      if (parseSweepGrid(strGrid, sweepInvalid)) failCheck(__FILE__, __LINE__, std::string("grid accepted: ") + strGrid);
+    }
+  }
+
+  // Manifest lines give the dataset folder and optionally the output file, comments and empty lines are skipped
+  SCARA_TEST(batch_manifest_parsing) {
+    TemporaryFile manifest(".txt");
+    writeFile(manifest.path(), "# datasets\n/data/first\n\n  \t\n/data/second   /out/second.fasta\n  # indented comment\n"
+                               "/data/third\t/out/third.fasta  \n/data/last");
+    std::vector<BatchJob> vJobs = readBatchManifest(manifest.path());
+    CHECK_EQ(vJobs.size(), (size_t)4);
+    if (vJobs.size() == 4) {
+      CHECK_EQ(vJobs[0].strFolder, std::string("/data/first"));
+      CHECK_EQ(vJobs[0].strOutput, std::string("/data/first/scaffolds.fasta"));
+      CHECK_EQ(vJobs[1].strFolder, std::string("/data/second"));
+      CHECK_EQ(vJobs[1].strOutput, std::string("/out/second.fasta"));
+      CHECK_EQ(vJobs[2].strOutput, std::string("/out/third.fasta"));
+      CHECK_EQ(vJobs[3].strFolder, std::string("/data/last"));
+      CHECK_EQ(vJobs[3].strOutput, std::string("/data/last/scaffolds.fasta"));
+      for (auto const& job : vJobs) CHECK(!job.finished && job.strError.empty());
+    }
+
+    bool thrown = false;
+    try {
+      readBatchManifest(manifest.path() + ".missing");
+    } catch (const std::runtime_error&) {
+      thrown = true;
+    }
+    CHECK(thrown);
+
+    // Text after the output file is rejected, e.g. a folder name with spaces
+    writeFile(manifest.path(), "/data/first\n/data/second /out/second.fasta trailing\n/data/last\n");
+    thrown = false;
+    try {
+      readBatchManifest(manifest.path());
+    } catch (const std::runtime_error&) {
+      thrown = true;
+    }
+    CHECK(thrown);
+  }
+
+  // Memory budgets are positive whole numbers of MB that fit into 64 bits in bytes
+  SCARA_TEST(memory_budget_parsing) {
+    uint64_t memoryBudget = 0;
+    CHECK(parseMemoryBudget("1", memoryBudget));
+    CHECK_EQ(memoryBudget, (uint64_t)1 << 20);
+    CHECK(parseMemoryBudget("16384", memoryBudget));
+    CHECK_EQ(memoryBudget, (uint64_t)16384 << 20);
+    CHECK(parseMemoryBudget(std::to_string(UINT64_MAX >> 20), memoryBudget));
+    CHECK_EQ(memoryBudget, (UINT64_MAX >> 20) << 20);
+
+    for (auto const& strBudget : {"", "0", "-1", "+1", " 1", "1MB", "1.5", "abc", "17592186044416", "99999999999999999999999"}) {
+      uint64_t invalidBudget = 0;
+      if (parseMemoryBudget(strBudget, invalidBudget)) failCheck(__FILE__, __LINE__, std::string("budget accepted: ") + strBudget);
+    }
+  }
+
+
+  // Jobs running at the same time, judged by admission and run times
+  static bool jobsOverlap(const BatchJob& job1, const BatchJob& job2) {
+    return job1.waitTime < job2.waitTime + job2.totalTime && job2.waitTime < job1.waitTime + job1.totalTime;
+  }
+
+  // Jobs are admitted only if they fit into the memory budget next to running jobs, a job larger than the budget runs alone,
+  // free threads are split among the jobs that can run at once (all of them for a job running alone)
+  // Each job writes the same scaffolds as a run of its dataset, a failed job does not stop the batch
+  SCARA_TEST(batch_admission_and_threads) {
+    TemporaryDirectory datasets;
+    std::vector<BatchJob> vTemplate;
+    for (uint32_t i = 0; i < 4; i++) {
+      BatchJob job;
+      job.strFolder = datasets.path() + "/dataset" + std::to_string(i);
+      job.strOutput = datasets.path() + "/scaffolds" + std::to_string(i) + ".fasta";
+      CHECK(mkdir(job.strFolder.c_str(), 0755) == 0);
+      writeSyntheticDataset(job.strFolder, 49 + i, 1 + i % 2);
+      vTemplate.emplace_back(job);
+    }
+    ScaraConfig config = deterministicConfig();
+    config.multithreading = 1;
+    config.NumThreads = 4;
+    std::vector<uint64_t> vMemory;
+    for (auto const& job : vTemplate) vMemory.emplace_back(estimateJobMemory(job, config));
+    const uint64_t maxMemory = *std::max_element(vMemory.begin(), vMemory.end());
+    const uint64_t minMemory = *std::min_element(vMemory.begin(), vMemory.end());
+    // A file smaller than a chunk is parsed at once, with qualities
+    struct stat st;
+    CHECK(stat((vTemplate[0].strFolder + "/reads.fastq").c_str(), &st) == 0);
+    CHECK(vMemory[0] > (uint64_t)st.st_size);
+    ScaraConfig packedConfig = config, lazyConfig = config;
+    packedConfig.PackReads = true;
+    lazyConfig.LazyReads = true;
+    CHECK(estimateJobMemory(vTemplate[0], packedConfig) < vMemory[0]);
+    CHECK(estimateJobMemory(vTemplate[0], packedConfig) > (uint64_t)st.st_size);
+    CHECK(estimateJobMemory(vTemplate[0], lazyConfig) < estimateJobMemory(vTemplate[0], packedConfig));
+
+    std::vector<std::vector<std::string>> vExpected;
+    for (auto const& job : vTemplate) vExpected.emplace_back(canonicalSequences(scaffoldDataset(job.strFolder, config)));
+    TemporaryFile report(".tsv");
+
+    // Budget too small for any two jobs (larger jobs run alone): jobs run one after another with all threads
+    std::vector<BatchJob> vJobs = vTemplate;
+    CHECK_EQ(runBatch(vJobs, config, 2 * minMemory - 1, report.path()), (uint32_t)4);
+    for (uint32_t i = 0; i < vJobs.size(); i++) {
+      CHECK(vJobs[i].finished && vJobs[i].strError.empty());
+      CHECK_EQ(vJobs[i].estimatedMemory, vMemory[i]);
+      CHECK_EQ(vJobs[i].numThreads, (uint32_t)4);
+      if (i > 0) CHECK(vJobs[i].waitTime >= vJobs[i - 1].waitTime + vJobs[i - 1].totalTime);
+      CHECK(canonicalSequences(readFastaRecords(vJobs[i].strOutput)) == vExpected[i]);
+    }
+
+    // Budget for all jobs: the first jobs share the threads, threads of jobs running at once are never more than all threads
+    vJobs = vTemplate;
+    CHECK_EQ(runBatch(vJobs, config, 4 * maxMemory, report.path()), (uint32_t)4);
+    CHECK_EQ(vJobs[0].numThreads, (uint32_t)1);
+    for (uint32_t i = 0; i < vJobs.size(); i++) {
+      CHECK(vJobs[i].numThreads >= 1);
+      uint32_t numThreads = 0;
+      for (auto const& job : vJobs) if (jobsOverlap(vJobs[i], job)) numThreads += job.numThreads;
+      CHECK(numThreads <= 4);
+      CHECK(canonicalSequences(readFastaRecords(vJobs[i].strOutput)) == vExpected[i]);
+    }
+
+    // Budget for two jobs at once: the first job shares threads with the second one
+    vJobs = vTemplate;
+    CHECK_EQ(runBatch(vJobs, config, vMemory[0] + vMemory[1], report.path()), (uint32_t)4);
+    CHECK_EQ(vJobs[0].numThreads, (uint32_t)2);
+
+    // A job larger than the budget runs alone with all threads, a missing dataset fails without stopping the batch
+    vJobs = vTemplate;
+    vJobs[3].strFolder = datasets.path() + "/missing";
+    CHECK_EQ(runBatch(vJobs, config, vMemory[0] - 1, report.path()), (uint32_t)3);
+    CHECK(!vJobs[3].strError.empty());
+    CHECK_EQ(vJobs[0].numThreads, (uint32_t)4);
+    for (uint32_t i = 1; i < vJobs.size(); i++) CHECK(!jobsOverlap(vJobs[0], vJobs[i]));
+    std::string strReport = readFile(report.path());
+    CHECK_EQ(std::count(strReport.begin(), strReport.end(), '\n'), (long)5);
+    CHECK(strReport.find("FAILED") != std::string::npos);
+  }
+
+}
+}
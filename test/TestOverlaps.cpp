@@ -0,0 +1,163 @@
+#include "TestUtils.h"
+#include "PafTokenizer.h"
+#include "Loader.h"
+#include "Overlap.h"
+#include "Types.h"
+#include "bioparser/bioparser.hpp"
+
+#include <random>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace scara {
+namespace test {
+
+  // PAF lines with fields of all lengths around the vector widths, tags, empty lines and a last line without a line break
+  static std::string syntheticPafLines(std::mt19937& generator, uint32_t numLines) {
+    std::uniform_int_distribution<uint32_t> dist(0, 100000);
+    std::string strPaf;
+    for (uint32_t i = 0; i < numLines; i++) {
+      std::string strQName = "read_" + std::string(i % 70, 'q');
+      std::string strTName = "ctg_" + std::string((i * 7) % 45, 't');
+      uint32_t qLen = 1000 + dist(generator), tLen = 1000 + dist(generator);
+      strPaf += strQName + "\t" + std::to_string(qLen) + "\t" + std::to_string(i) + "\t" + std::to_string(qLen - i % 100) + "\t"
+                + ((i % 2) ? "+" : "-") + "\t" + strTName + "\t" + std::to_string(tLen) + "\t" + std::to_string(i % 1000) + "\t"
+                + std::to_string(tLen - 1) + "\t" + std::to_string(dist(generator)) + "\t" + std::to_string(dist(generator)) + "\t"
+                + std::to_string(i % 256);
+      if (i % 3 == 0) strPaf += "\ttp:A:P\tcm:i:" + std::to_string(i) + "\tdv:f:0.0" + std::string(i % 40, '1');
+      if (i % 11 == 0) strPaf += "\r";
+      strPaf += "\n";
+      if (i % 17 == 0) strPaf += "\n";
+    }
+    strPaf += "last\t10\t0\t5\t+\tctg\t20\t0\t5\t5\t5\t60";
+    return strPaf;
+  }
+
+  static bool sameRecord(const PafRecord& lhs, const PafRecord& rhs) {
+    if ((lhs.qName == NULL) != (rhs.qName == NULL)) return false;
+    if (lhs.qName == NULL) return true;
+    return std::string(lhs.qName, lhs.qNameLength) == std::string(rhs.qName, rhs.qNameLength)
+        && std::string(lhs.tName, lhs.tNameLength) == std::string(rhs.tName, rhs.tNameLength)
+        && lhs.qLength == rhs.qLength && lhs.qBegin == rhs.qBegin && lhs.qEnd == rhs.qEnd && lhs.orientation == rhs.orientation
+        && lhs.tLength == rhs.tLength && lhs.tBegin == rhs.tBegin && lhs.tEnd == rhs.tEnd && lhs.matchingBases == rhs.matchingBases
+        && lhs.overlapLength == rhs.overlapLength && lhs.mappingQuality == rhs.mappingQuality;
+  }
+
+  // Dispatched tokenizer finds the same fields and records as the scalar one, on the test data and on synthetic lines
+  SCARA_TEST(paf_tokenizer_matches_scalar) {
+    std::mt19937 generator(39);
+    std::vector<std::string> vInputs = {readFile(dataFile("test_C2R_ovl.paf")), readFile(dataFile("test_R2R_ovl.paf")),
+                                        syntheticPafLines(generator, 2000)};
+    for (auto const& strPaf : vInputs) {
+      // Field ends, starting from every line, with the rest of the file, with only the line and with the line
+      // followed by a part of the next one in the buffer (ends of buffers are handled by the narrower kernels)
+      const char* end = strPaf.data() + strPaf.size();
+      uint32_t numBadLines = 0;
+      for (const char* line = strPaf.data(); line < end; ) {
+        const char* nl = (const char*)memchr(line, '\n', end - line);
+        const char* next = (nl != NULL) ? nl + 1 : end;
+        for (const char* bufferEnd : {end, next, std::min(next + 20, end)}) {
+          for (uint32_t maxFields : {1u, PafNumFields, 64u}) {
+            const char* fieldEnds[64];
+            const char* scalarEnds[64];
+            uint32_t numFields = _pafFindFields(line, bufferEnd, fieldEnds, maxFields);
+            uint32_t numScalar = _pafFindFieldsScalar(line, bufferEnd, scalarEnds, maxFields);
+            if (numFields != numScalar || !std::equal(fieldEnds, fieldEnds + numFields, scalarEnds)) numBadLines++;
+          }
+        }
+        line = next;
+      }
+      CHECK_EQ(numBadLines, (uint32_t)0);
+
+      // Parsed records
+      uint32_t numRecords = 0, numBadRecords = 0;
+      const char* pos = strPaf.data();
+      const char* posScalar = strPaf.data();
+      while (pos < end && posScalar == pos) {
+        PafRecord record, recordScalar;
+        bool valid, validScalar;
+        pos = parsePafLine(pos, end, record, valid);
+        posScalar = parsePafLine(posScalar, end, recordScalar, validScalar, _pafFindFieldsScalar);
+        if (!valid || !validScalar || !sameRecord(record, recordScalar)) numBadRecords++;
+        if (record.qName != NULL) numRecords++;
+      }
+      CHECK(pos == end && posScalar == end);
+      CHECK_EQ(numBadRecords, (uint32_t)0);
+      CHECK(numRecords > 0);
+    }
+
+    // Malformed lines (missing fields, invalid numbers, invalid strands) are rejected by both
+    for (std::string strLine : {"read\t100\t0\t50\t+\tctg\t200\t0\n", "read\t100\tx\t50\t+\tctg\t200\t0\t50\t50\t50\t60\n",
+                                "read\t100\t0\t50\tx\tctg\t200\t0\t50\t50\t50\t60\n", "read\t100\t0\t50\t++\tctg\t200\t0\t50\t50\t50\t60\n",
+                                "read\t100\t0\t50\t-+\tctg\t200\t0\t50\t50\t50\t60\n", "read\t100\t0\t50\t\tctg\t200\t0\t50\t50\t50\t60\n"}) {
+      PafRecord record;
+      bool valid = true, validScalar = true;
+      parsePafLine(strLine.data(), strLine.data() + strLine.size(), record, valid);
+      parsePafLine(strLine.data(), strLine.data() + strLine.size(), record, validScalar, _pafFindFieldsScalar);
+      CHECK(!valid);
+      CHECK(!validScalar);
+    }
+  }
+
+  static bool sameOverlap(const Overlap& lhs, const Overlap& rhs) {
+    return lhs.ext_strName == rhs.ext_strName && lhs.ext_strTarget == rhs.ext_strTarget && lhs.ext_oType == rhs.ext_oType
+        && lhs.ext_ulQBegin == rhs.ext_ulQBegin && lhs.ext_ulQEnd == rhs.ext_ulQEnd && lhs.ext_ulQLen == rhs.ext_ulQLen
+        && lhs.ext_ulTBegin == rhs.ext_ulTBegin && lhs.ext_ulTEnd == rhs.ext_ulTEnd && lhs.ext_ulTLen == rhs.ext_ulTLen
+        && lhs.ext_bOrientation == rhs.ext_bOrientation && lhs.paf_matching_bases == rhs.paf_matching_bases
+        && lhs.paf_overlap_length == rhs.paf_overlap_length && lhs.paf_mapping_quality == rhs.paf_mapping_quality;
+  }
+
+  uint32_t countDifferentOverlaps(const VecOvl& vOvl1, const VecOvl& vOvl2) {
+    uint32_t numDifferent = std::max(vOvl1.size(), vOvl2.size()) - std::min(vOvl1.size(), vOvl2.size());
+    for (size_t i = 0; i < std::min(vOvl1.size(), vOvl2.size()); i++) {
+      if (!sameOverlap(*vOvl1[i], *vOvl2[i])) numDifferent++;
+    }
+    return numDifferent;
+  }
+
+  // Test overlaps are parsed as with bioparser
+  SCARA_TEST(paf_parse_matches_bioparser) {
+    for (auto const& strName : {"test_C2R_ovl.paf", "test_R2R_ovl.paf"}) {
+      VecOvl vOvl, vOvlBioparser;
+      parseProcessPaf(dataFile(strName), vOvl, quietConfig());
+      auto pafParser = bioparser::createParser<bioparser::PafParser, Overlap>(dataFile(strName));
+      pafParser->parse_objects(vOvlBioparser, -1);
+      CHECK(!vOvl.empty());
+      CHECK_EQ(countDifferentOverlaps(vOvl, vOvlBioparser), (uint32_t)0);
+    }
+  }
+
+  // A PAF file large enough to be split into several chunks is parsed in parallel into the same overlaps,
+  // in file order, as when parsed by a single thread or read in batches
+  SCARA_TEST(paf_parallel_matches_serial) {
+    std::mt19937 generator(38);
+    TemporaryFile paf(".paf");
+    writeFile(paf.path(), syntheticPafLines(generator, 40000));
+
+    VecOvl vSerial;
+    parseProcessPaf(paf.path(), vSerial, quietConfig());
+    CHECK_EQ(vSerial.size(), (size_t)40001);
+
+    ScaraConfig config = quietConfig();
+    config.multithreading = 1;
+    for (uint32_t numThreads : {2u, 3u, 8u}) {
+      config.NumThreads = numThreads;
+      VecOvl vParallel;
+      parseProcessPaf(paf.path(), vParallel, config);
+      CHECK_EQ(countDifferentOverlaps(vSerial, vParallel), (uint32_t)0);
+    }
+
+    VecOvl vBatches;
+    uint32_t numBatches = 0;
+    readPafBatches(paf.path(), 1000, [&](VecOvl&& vBatch) {
+      numBatches++;
+      std::move(vBatch.begin(), vBatch.end(), std::back_inserter(vBatches));
+      return true;
+    });
+    CHECK(numBatches > 1);
+    CHECK_EQ(countDifferentOverlaps(vSerial, vBatches), (uint32_t)0);
+  }
+
+}
+}
@@ -0,0 +1,173 @@
+#include "TestUtils.h"
+#include "SBridger.h"
+#include "Sequence.h"
+
+#include <set>
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+namespace scara {
+namespace test {
+
+  std::vector<std::pair<std::string, std::string>> runScaffolding(SBridger& sbridger) {
+    TemporaryFile output(".fasta");
+    sbridger.generateGraph();
+    sbridger.cleanupGraph();
+    if (sbridger.getConfig().PartitionGraph) {
+      sbridger.processComponents();
+    } else {
+      sbridger.generatePaths();
+      sbridger.groupAndProcessPaths();
+    }
+    sbridger.generateSequences(output.path(), sbridger.getConfig().numThreads());
+    return readFastaRecords(output.path());
+  }
+
+  std::vector<std::pair<std::string, std::string>> scaffoldDataset(const std::string& strDir, const ScaraConfig& config) {
+    SBridger sbridger(config, strDir + "/reads.fastq", strDir + "/contigs.fasta", strDir + "/readsToContigs.paf", strDir + "/readsToReads.paf");
+    return runScaffolding(sbridger);
+  }
+
+  // Which of the two copies of a scaffold is kept depends on the order of path generation
+  std::vector<std::string> canonicalSequences(const std::vector<std::pair<std::string, std::string>>& vRecords) {
+    std::vector<std::string> vSequences;
+    for (auto const& record : vRecords) {
+      vSequences.emplace_back(std::min(record.second, _bioReverseComplement(record.second)));
+    }
+    std::sort(vSequences.begin(), vSequences.end());
+    return vSequences;
+  }
+
+  // Runs all phases on the test data and returns the output records
+  static std::vector<std::pair<std::string, std::string>> scaffoldTestData(const ScaraConfig& config) {
+    SBridger sbridger(config, dataFile("testreads.fastq"), dataFile("testcontigs.fasta")
+                      , dataFile("test_C2R_ovl.paf"), dataFile("test_R2R_ovl.paf"));
+    return runScaffolding(sbridger);
+  }
+
+  // KK: Test data contains a reverse complement copy of each read, so each scaffold is generated on both strands,
+  // only one of the two copies may be written
+  SCARA_TEST(scaffolds_deduplicated) {
+    ScaraConfig config = quietConfig();
+    for (uint32_t minPathsInGroup : {1u, 3u}) {
+      config.MinPathsinGroup = minPathsInGroup;
+      auto vRecords = scaffoldTestData(config);
+      CHECK_EQ(vRecords.size(), (size_t)1);
+
+      std::set<std::string> sSequences;
+      for (auto const& record : vRecords) {
+        CHECK(record.first.compare(0, 9, "Scaffold_") == 0);
+        CHECK(!record.second.empty());
+        CHECK(sSequences.count(record.second) == 0);
+        CHECK(sSequences.count(_bioReverseComplement(record.second)) == 0);
+        sSequences.emplace(record.second);
+      }
+    }
+  }
+
+  // Scaffolds do not depend on multithreading, scaffolds written directly by a single thread are the same as scaffolds
+  // assembled into buffers by worker threads, also for packed and mapped sequences
+  SCARA_TEST(scaffolds_multithreaded) {
+    ScaraConfig config = quietConfig();
+    auto vSerial = canonicalSequences(scaffoldTestData(config));
+    config.multithreading = 1;
+    config.NumThreads = 4;
+    auto vParallel = canonicalSequences(scaffoldTestData(config));
+    CHECK(vSerial == vParallel);
+
+    TemporaryDirectory dataset;
+    writeSyntheticDataset(dataset.path(), 33, 3);
+    for (int variant = 0; variant < 3; variant++) {
+      config = deterministicConfig();
+      config.PackReads = (variant == 1);
+      config.MapSequences = (variant == 2);
+      vSerial = canonicalSequences(scaffoldDataset(dataset.path(), config));
+      CHECK(vSerial.size() > 2);
+      config.multithreading = 1;
+      config.NumThreads = 4;
+      vParallel = canonicalSequences(scaffoldDataset(dataset.path(), config));
+      CHECK(vSerial == vParallel);
+    }
+  }
+
+  // Bridger for a dataset written by writeSyntheticDataset, with sequences and overlaps parsed into memory beforehand
+  static std::unique_ptr<SBridger> inMemoryBridger(const std::string& strDir, const ScaraConfig& config) {
+    MapIdToSeq mIdToRead, mIdToContig;
+    VecOvl vOvlR2C, vOvlR2R;
+    parseProcessFastq(strDir + "/reads.fastq", mIdToRead, config);
+    parseProcessFasta(strDir + "/contigs.fasta", mIdToContig, config);
+    parseProcessPaf(strDir + "/readsToContigs.paf", vOvlR2C, config);
+    parseProcessPaf(strDir + "/readsToReads.paf", vOvlR2R, config);
+    return std::unique_ptr<SBridger>(new SBridger(config, mIdToRead, mIdToContig, std::move(vOvlR2C), std::move(vOvlR2R)));
+  }
+
+  // A bridger given sequences and overlaps in memory builds the same graph and scaffolds as a bridger reading the files,
+  // also with packed reads and with overlaps parsed during graph construction for the file based bridger
+  SCARA_TEST(scaffolds_in_memory_match_files) {
+    TemporaryDirectory dataset;
+    writeSyntheticDataset(dataset.path(), 48, 2);
+    const std::string strDir = dataset.path();
+    for (int variant = 0; variant < 3; variant++) {
+      ScaraConfig config = deterministicConfig();
+      config.PackReads = (variant == 1);
+      config.PipelineGraph = (variant == 2);
+      SBridger fromFiles(config, strDir + "/reads.fastq", strDir + "/contigs.fasta", strDir + "/readsToContigs.paf", strDir + "/readsToReads.paf");
+      fromFiles.generateGraph();
+      auto inMemory = inMemoryBridger(strDir, config);
+      inMemory->generateGraph();
+      CHECK(!inMemory->mReadNodes.empty());
+      CHECK(graphSignature(*inMemory) == graphSignature(fromFiles));
+
+      auto vScaffolds = canonicalSequences(scaffoldDataset(strDir, config));
+      CHECK(!vScaffolds.empty());
+      CHECK(canonicalSequences(runScaffolding(*inMemoryBridger(strDir, config))) == vScaffolds);
+    }
+  }
+
+  // Bridgers with different parameters, running concurrently in one process, give the same scaffolds as when run alone
+  SCARA_TEST(scaffolds_concurrent_bridgers) {
+    TemporaryDirectory dataset;
+    writeSyntheticDataset(dataset.path(), 49, 2);
+    std::vector<ScaraConfig> vConfigs(4, deterministicConfig());
+    vConfigs[1].PackReads = true;
+    vConfigs[2].PartitionGraph = true;
+    vConfigs[3].SImin = 0.99;
+    vConfigs[3].MinPathsinGroup = 2;
+    std::vector<std::vector<std::string>> vAlone, vConcurrent(vConfigs.size());
+    for (auto const& config : vConfigs) vAlone.emplace_back(canonicalSequences(scaffoldDataset(dataset.path(), config)));
+
+    std::vector<std::unique_ptr<SBridger>> vBridgers;
+    for (auto const& config : vConfigs) vBridgers.emplace_back(inMemoryBridger(dataset.path(), config));
+    std::vector<std::thread> vThreads;
+    for (uint32_t i = 0; i < vBridgers.size(); i++) {
+      vThreads.emplace_back([&vBridgers, &vConcurrent, i]() { vConcurrent[i] = canonicalSequences(runScaffolding(*vBridgers[i])); });
+    }
+    for (auto& t : vThreads) t.join();
+    CHECK(!vAlone[0].empty());
+    CHECK(vAlone[3] != vAlone[0]);
+    for (uint32_t i = 0; i < vConfigs.size(); i++) CHECK(vConcurrent[i] == vAlone[i]);
+  }
+
+
+  // Scaffolds generated for each connected component are the same as scaffolds generated on the whole graph,
+  // with and without multithreading; isolated contigs (components without edges) do not change the output
+  SCARA_TEST(scaffolds_partitioned_match_whole_graph) {
+    TemporaryDirectory dataset;
+    writeSyntheticDataset(dataset.path(), 50, 3);
+    const std::string strContigs = dataset.path() + "/contigs.fasta";
+    writeFile(strContigs, readFile(strContigs) + ">isolated1\n" + std::string(5000, 'A') + "\n>isolated2\n" + std::string(3000, 'C') + "\n");
+
+    ScaraConfig config = deterministicConfig();
+    auto vWhole = canonicalSequences(scaffoldDataset(dataset.path(), config));
+    CHECK(vWhole.size() > 2);
+    config.PartitionGraph = true;
+    for (int multithreading : {0, 1}) {
+      config.multithreading = multithreading;
+      config.NumThreads = 4;
+      CHECK(canonicalSequences(scaffoldDataset(dataset.path(), config)) == vWhole);
+    }
+  }
+
+}
+}
@@ -0,0 +1,259 @@
+#include "TestUtils.h"
+#include "Sequence.h"
+#include "Loader.h"
+#include "Types.h"
+
+#include <random>
+#include <map>
+#include <sstream>
+#include <cstdio>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+namespace scara {
+namespace test {
+
+  // Random bases, mostly ACGT with some lowercase, N and IUPAC codes
+  static std::string randomBases(std::mt19937& generator, uint32_t length) {
+    static const char Bases[] = "ACGTACGTACGTACGTACGTacgtNnRYKMSWBDHV";
+    std::uniform_int_distribution<uint32_t> dist(0, sizeof(Bases) - 2);
+    std::string strBases(length, 'A');
+    for (auto& c : strBases) c = Bases[dist(generator)];
+    return strBases;
+  }
+
+  // Dispatched kernel and the scalar kernel agree for all lengths around the vector widths and unaligned inputs
+  SCARA_TEST(revcomp_kernel_matches_scalar) {
+    std::mt19937 generator(31);
+    std::string strBases = randomBases(generator, 1024);
+    for (uint32_t offset = 0; offset < 8; offset++) {
+      for (uint32_t len = 0; len + offset <= 300; len++) {
+        std::string strKernel(len, 0), strScalar(len, 0);
+        _bioReverseComplement(strBases.data() + offset, len, &strKernel[0]);
+        _bioReverseComplementScalar(strBases.data() + offset, len, &strScalar[0]);
+        if (strKernel != strScalar) {
+          CHECK(strKernel == strScalar);
+          return;
+        }
+      }
+    }
+    // Lowercase bases are complemented into uppercase
+    CHECK_EQ(_bioReverseComplement(std::string("ACGTNacgtn")), std::string("NACGTNACGT"));
+    CHECK_EQ(_bioReverseComplement(std::string("AACCGGTT"), 2, 6), std::string("CCGG"));
+  }
+
+  // Compares copyTo and copyReverseComplementTo of seq with the bases of the plain sequence for many slices
+  static void checkSlices(const Sequence& seq, const std::string& strBases, std::mt19937& generator) {
+    CHECK_EQ(seq.length(), (uint32_t)strBases.length());
+    std::vector<std::pair<uint32_t, uint32_t>> vSlices = {{0, (uint32_t)strBases.length()}};
+    std::uniform_int_distribution<uint32_t> dist(0, strBases.length());
+    for (uint32_t i = 0; i < 500; i++) {
+      uint32_t start = dist(generator), end = dist(generator);
+      if (start > end) std::swap(start, end);
+      vSlices.emplace_back(start, end - start);
+    }
+    uint32_t numBadSlices = 0;
+    for (auto const& slice : vSlices) {
+      std::string strCopy(slice.second, 0), strRevComp(slice.second, 0);
+      seq.copyTo(slice.first, slice.second, &strCopy[0]);
+      seq.copyReverseComplementTo(slice.first, slice.second, &strRevComp[0]);
+      if (strCopy != strBases.substr(slice.first, slice.second)) numBadSlices++;
+      if (strRevComp != _bioReverseComplement(strBases, slice.first, slice.first + slice.second)) numBadSlices++;
+    }
+    CHECK_EQ(numBadSlices, (uint32_t)0);
+  }
+
+  // Packed sequences decode into the same bases as plain ones, including exceptions at and around byte boundaries
+  SCARA_TEST(packed_sequence_matches_plain) {
+    std::mt19937 generator(35);
+    for (uint32_t length : {0u, 1u, 3u, 4u, 5u, 17u, 1000u, 4099u}) {
+      std::string strBases = randomBases(generator, length);
+      Sequence seq("read", 4, strBases.data(), length);
+      seq.pack();
+      CHECK(seq.isPacked() || length == 0);
+      checkSlices(seq, strBases, generator);
+    }
+
+    // Long runs of exceptions, characters outside of ASCII (negative chars) and a sequence without any exceptions
+    std::string strRuns = std::string(50, 'N') + std::string(100, 'A') + std::string(50, 'n') + "ACGT";
+    for (uint32_t pos = 7; pos < strRuns.length(); pos += 13) strRuns[pos] = (char)0xE9;
+    Sequence seqRuns("runs", 4, strRuns.data(), strRuns.length());
+    seqRuns.pack();
+    checkSlices(seqRuns, strRuns, generator);
+    std::string strPlain(777, 'G');
+    Sequence seqPlain("plain", 5, strPlain.data(), strPlain.length());
+    seqPlain.pack();
+    CHECK(seqPlain.seq_packedExceptions.empty());
+    checkSlices(seqPlain, strPlain, generator);
+  }
+
+  // Writes reads into a FASTQ file (single line) or a FASTA file wrapped at lineWidth
+  static void writeReads(const std::string& strFile, const std::map<std::string, std::string>& mReads, bool fastq, uint32_t lineWidth) {
+    std::ostringstream ss;
+    for (auto const& it : mReads) {
+      ss << (fastq ? '@' : '>') << it.first << " description\n";
+      if (lineWidth == 0) {
+        ss << it.second << "\n";
+      } else {
+        for (uint32_t pos = 0; pos < it.second.length(); pos += lineWidth) ss << it.second.substr(pos, lineWidth) << "\n";
+      }
+      if (fastq) ss << "+\n" << std::string(it.second.length(), 'I') << "\n";
+    }
+    writeFile(strFile, ss.str());
+  }
+
+  static void checkSequences(const MapIdToSeq& mIdToSeq, const std::map<std::string, std::string>& mReads, std::mt19937& generator) {
+    CHECK_EQ(mIdToSeq.size(), mReads.size());
+    for (auto const& it : mReads) {
+      auto itSeq = mIdToSeq.find(it.first);
+      CHECK(itSeq != mIdToSeq.end());
+      if (itSeq != mIdToSeq.end()) checkSlices(*itSeq->second, it.second, generator);
+    }
+  }
+
+  // Memory held by the bases and qualities of loaded sequences
+  static uint64_t retainedBytes(const MapIdToSeq& mIdToSeq) {
+    uint64_t numBytes = 0;
+    for (auto const& it : mIdToSeq) {
+      numBytes += it.second->seq_strData.capacity() + it.second->seq_strQuality.capacity();
+      numBytes += it.second->seq_packedData.capacity() + it.second->seq_packedExceptions.capacity() * sizeof(std::pair<uint32_t, char>);
+    }
+    return numBytes;
+  }
+
+  // Parsed reads keep no qualities, packed reads keep no ASCII bases, so packed loading holds a fraction of the bases
+  SCARA_TEST(parsed_reads_release_buffers) {
+    std::mt19937 generator(35);
+    std::map<std::string, std::string> mReads;
+    std::uniform_int_distribution<uint32_t> dist(0, 3);
+    for (uint32_t i = 0; i < 50; i++) {
+      // Mostly ACGT, as in real reads, with a few exceptions
+      std::string strBases = randomBases(generator, 2000 + i * 97);
+      for (uint32_t pos = 0; pos < strBases.length(); pos++) if (pos % 100 != 0) strBases[pos] = "ACGT"[dist(generator)];
+      mReads["read" + std::to_string(i)] = strBases;
+    }
+    TemporaryFile reads(".fastq");
+    writeReads(reads.path(), mReads, true, 0);
+
+    ScaraConfig config = quietConfig();
+    MapIdToSeq mPlain, mPacked;
+    parseProcessFastq(reads.path(), mPlain, config);
+    config.PackReads = true;
+    parseProcessFastq(reads.path(), mPacked, config);
+    checkSequences(mPlain, mReads, generator);
+    checkSequences(mPacked, mReads, generator);
+
+    uint64_t numBases = 0;
+    for (auto const& it : mReads) numBases += it.second.length();
+    for (auto const& it : mPlain) CHECK(it.second->seq_strQuality.empty());
+    for (auto const& it : mPacked) {
+      CHECK(it.second->isPacked());
+      CHECK(it.second->seq_strData.empty());
+      CHECK(it.second->seq_strQuality.empty());
+    }
+    CHECK(retainedBytes(mPlain) < numBases + numBases / 10);
+    CHECK(retainedBytes(mPacked) < retainedBytes(mPlain) / 2);
+  }
+
+  static void setModificationTime(const std::string& strFile, time_t sec, long nsec) {
+    struct timespec times[2];
+    times[0].tv_sec = times[1].tv_sec = sec;
+    times[0].tv_nsec = times[1].tv_nsec = nsec;
+    CHECK(utimensat(AT_FDCWD, strFile.c_str(), times, 0) == 0);
+  }
+
+  // Read index is marked with an old modification time, so it can be seen whether it was written again
+  static const time_t IndexMark = 1000000000;
+
+  static bool indexRebuilt(const std::string& strIndex) {
+    struct stat st;
+    CHECK(stat(strIndex.c_str(), &st) == 0);
+    bool rebuilt = (st.st_mtim.tv_sec != IndexMark);
+    setModificationTime(strIndex, IndexMark, 0);
+    return rebuilt;
+  }
+
+  // Lazily loaded reads are read from the file in the same way as parsed ones, the read index (.scidx) is reused
+  // while the reads file does not change, and built again when it is changed in place (also within the same second
+  // and with the same size) or replaced by another file with the same size and modification time
+  SCARA_TEST(lazy_reads_match_plain) {
+    std::mt19937 generator(36);
+    std::map<std::string, std::string> mReads;
+    for (uint32_t i = 0; i < 20; i++) mReads["read" + std::to_string(i)] = randomBases(generator, 1 + i * 97);
+
+    for (uint32_t lineWidth : {0u, 60u}) {
+      bool fastq = (lineWidth == 0);
+      TemporaryFile reads(fastq ? ".fastq" : ".fasta");
+      std::string strIndex = reads.derived(".scidx");
+      writeReads(reads.path(), mReads, fastq, lineWidth);
+      setModificationTime(reads.path(), 1500000000, 100);
+
+      MapIdToSeq mIndexed;
+      indexProcessReads(reads.path(), mIndexed, quietConfig());
+      CHECK(!readFile(strIndex).empty());
+      CHECK(indexRebuilt(strIndex));
+      for (auto const& it : mIndexed) CHECK(it.second->isLazy());
+      checkSequences(mIndexed, mReads, generator);
+
+      // Loaded from the index
+      MapIdToSeq mReloaded;
+      indexProcessReads(reads.path(), mReloaded, quietConfig());
+      CHECK(!indexRebuilt(strIndex));
+      checkSequences(mReloaded, mReads, generator);
+
+      // A changed reads file is indexed again
+      mReads["read_added"] = randomBases(generator, 333);
+      writeReads(reads.path(), mReads, fastq, lineWidth);
+      setModificationTime(reads.path(), 1500000000, 100);
+      MapIdToSeq mChanged;
+      indexProcessReads(reads.path(), mChanged, quietConfig());
+      CHECK(indexRebuilt(strIndex));
+      checkSequences(mChanged, mReads, generator);
+
+      // Reads file rewritten with the same size within the same second
+      mReads["read_added"] = std::string(333, 'A');
+      writeReads(reads.path(), mReads, fastq, lineWidth);
+      setModificationTime(reads.path(), 1500000000, 200);
+      MapIdToSeq mSameSecond;
+      indexProcessReads(reads.path(), mSameSecond, quietConfig());
+      CHECK(indexRebuilt(strIndex));
+      checkSequences(mSameSecond, mReads, generator);
+
+      // Reads file replaced by another file with the same size and modification time
+      mReads["read_added"] = std::string(333, 'C');
+      std::string strReplacement = reads.derived(".new");
+      writeReads(strReplacement, mReads, fastq, lineWidth);
+      setModificationTime(strReplacement, 1500000000, 200);
+      CHECK(rename(strReplacement.c_str(), reads.path().c_str()) == 0);
+      MapIdToSeq mReplaced;
+      indexProcessReads(reads.path(), mReplaced, quietConfig());
+      CHECK(indexRebuilt(strIndex));
+      checkSequences(mReplaced, mReads, generator);
+      mReads.erase("read_added");
+    }
+  }
+
+  // Sequences loaded through a memory mapping match the input, single-line sequences are views into the mapping
+  SCARA_TEST(mapped_sequences_match_plain) {
+    std::mt19937 generator(37);
+    std::map<std::string, std::string> mReads;
+    for (uint32_t i = 0; i < 20; i++) mReads["seq" + std::to_string(i)] = randomBases(generator, 1 + i * 89);
+
+    for (uint32_t lineWidth : {0u, 70u}) {
+      for (bool fastq : {false, true}) {
+        TemporaryFile file(fastq ? ".fastq" : ".fasta");
+        writeReads(file.path(), mReads, fastq, lineWidth);
+        MapIdToSeq mMapped;
+        mapProcessSequences(file.path(), mMapped, quietConfig());
+        checkSequences(mMapped, mReads, generator);
+        for (auto const& it : mMapped) {
+          CHECK(it.second->data() != NULL);
+          if (lineWidth == 0 || it.second->length() <= lineWidth) CHECK(it.second->seq_mapView);
+        }
+      }
+    }
+  }
+
+}
+}
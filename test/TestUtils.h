@@ -0,0 +1,123 @@
+#pragma once
+
+#include "ScaraConfig.h"
+#include "Types.h"
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <sstream>
+
+/* KK:
+ * Minimal test harness for scara_tests, there are no external test dependencies
+ * A test is a function registered with SCARA_TEST, CHECK and CHECK_EQ record failures and let the test continue
+ * Tests read the data in the test folder, given as the first argument of scara_tests, and write only temporary files
+ */
+
+namespace scara {
+
+  class SBridger;
+
+namespace test {
+
+  struct TestCase {
+    const char* name;
+    std::function<void(void)> run;
+  };
+
+  extern std::vector<TestCase>& testCases(void);
+
+  struct TestRegistrar {
+    TestRegistrar(const char* name, std::function<void(void)> run) { testCases().push_back({name, run}); }
+  };
+
+  extern void failCheck(const char* file, int line, const std::string& message);
+
+  // Path of a file in the test data folder
+  extern std::string dataFile(const std::string& strName);
+
+  // Configuration used by tests, without console output
+  extern ScaraConfig quietConfig(void);
+
+  // Temporary file in TMPDIR (or /tmp), removed with the object
+  // Files with additional suffixes (e.g. caches written next to the file) are removed as well
+  class TemporaryFile {
+  public:
+    explicit TemporaryFile(const std::string& strSuffix = "");
+    ~TemporaryFile();
+    TemporaryFile(const TemporaryFile&) = delete;
+    TemporaryFile& operator=(const TemporaryFile&) = delete;
+
+    const std::string& path(void) const { return strFile; }
+    // Registers a file derived from the temporary file for removal
+    std::string derived(const std::string& strSuffix);
+
+  private:
+    std::string strFile;
+    std::vector<std::string> vDerived;
+  };
+
+  // Temporary directory, removed recursively with the object
+  class TemporaryDirectory {
+  public:
+    TemporaryDirectory();
+    ~TemporaryDirectory();
+    TemporaryDirectory(const TemporaryDirectory&) = delete;
+    TemporaryDirectory& operator=(const TemporaryDirectory&) = delete;
+
+    const std::string& path(void) const { return strDir; }
+
+  private:
+    std::string strDir;
+  };
+
+  extern std::string readFile(const std::string& strFile);
+  extern void writeFile(const std::string& strFile, const std::string& strData);
+
+  // (header, sequence) pairs of a FASTA file, lines of a sequence are joined
+  extern std::vector<std::pair<std::string, std::string>> readFastaRecords(const std::string& strFile);
+
+  // Number of positions where the two overlap vectors differ, including the difference in size (TestOverlaps.cpp)
+  extern uint32_t countDifferentOverlaps(const VecOvl& vOvl1, const VecOvl& vOvl2);
+
+  // Outgoing edges of all nodes with their data, in the order in which they are stored (TestGraph.cpp)
+  extern std::string graphSignature(const SBridger& sbridger);
+
+  // Configuration without Monte Carlo path generation, so that paths and scaffolds are deterministic
+  extern ScaraConfig deterministicConfig(void);
+
+  // Runs all phases as scara does (components with PartitionGraph) and returns the output records (TestScaffolds.cpp)
+  extern std::vector<std::pair<std::string, std::string>> runScaffolding(SBridger& sbridger);
+
+  // Runs all phases on a dataset written by writeSyntheticDataset and returns the output records (TestScaffolds.cpp)
+  extern std::vector<std::pair<std::string, std::string>> scaffoldDataset(const std::string& strDir, const ScaraConfig& config);
+
+  // Output sequences independent of the strand each scaffold was written on, sorted (TestScaffolds.cpp)
+  extern std::vector<std::string> canonicalSequences(const std::vector<std::pair<std::string, std::string>>& vRecords);
+
+  // Writes reads.fastq, contigs.fasta, readsToContigs.paf and readsToReads.paf of a synthetic dataset into strDir,
+  // with numComponents independent genomes (TestData.cpp)
+  extern void writeSyntheticDataset(const std::string& strDir, uint32_t seed, uint32_t numComponents = 1);
+
+}
+}
+
+#define SCARA_TEST(name) \
+  static void name(void); \
+  static scara::test::TestRegistrar name##_registrar(#name, name); \
+  static void name(void)
+
+#define CHECK(cond) \
+  do { if (!(cond)) scara::test::failCheck(__FILE__, __LINE__, #cond); } while (0)
+
+#define CHECK_EQ(a, b) \
+  do { \
+    auto const& check_a = (a); \
+    auto const& check_b = (b); \
+    if (!(check_a == check_b)) { \
+      std::ostringstream check_ss; \
+      check_ss << #a << " == " << #b << " (" << check_a << " vs " << check_b << ")"; \
+      scara::test::failCheck(__FILE__, __LINE__, check_ss.str()); \
+    } \
+  } while (0)
@@ -0,0 +1,112 @@
+#include "TestUtils.h"
+#include "Writer.h"
+#include "Sequence.h"
+#include "Loader.h"
+#include "Types.h"
+
+#include <random>
+
+namespace scara {
+namespace test {
+
+  static std::string randomACGT(std::mt19937& generator, uint32_t length) {
+    static const char Bases[] = "ACGTN";
+    std::uniform_int_distribution<uint32_t> dist(0, 4);
+    std::string strBases(length, 'A');
+    for (auto& c : strBases) c = Bases[dist(generator)];
+    return strBases;
+  }
+
+  // Expected output of a sequence, wrapped into lines of lineWidth (a single line if 0)
+  static std::string wrapped(const std::string& strHeader, const std::string& strBases, uint32_t lineWidth) {
+    std::string strOut = strHeader + "\n";
+    if (lineWidth == 0) return strOut + strBases + "\n";
+    for (uint32_t pos = 0; pos < strBases.length(); pos += lineWidth) strOut += strBases.substr(pos, lineWidth) + "\n";
+    return strOut;
+  }
+
+  // Sequences written in spans (plain, reverse complemented and packed) are wrapped across span and buffer boundaries
+  SCARA_TEST(writer_wraps_spans) {
+    std::mt19937 generator(32);
+    std::string strPacked = randomACGT(generator, 5000);
+    Sequence seqPacked("packed", 6, strPacked.data(), strPacked.length());
+    seqPacked.pack();
+
+    for (uint32_t lineWidth : {0u, 1u, 7u, 60u}) {
+      for (size_t bufferSize : {(size_t)16, (size_t)4096, (size_t)1 << 20}) {
+        TemporaryFile output(".fasta");
+        std::string strExpected;
+        {
+          SequenceWriter writer(output.path(), lineWidth, bufferSize);
+          for (uint32_t i = 0; i < 3; i++) {
+            std::string strHeader = ">Scaffold_" + std::to_string(i + 1) + " with a header longer than the smallest buffer";
+            std::string strFw = randomACGT(generator, 1 + 1000 * i);
+            std::string strRc = randomACGT(generator, 13 + 2000 * i);
+            uint32_t start = 17 * i, len = 1500 * i + 3;
+            writer.writeHeader(strHeader);
+            writer.writeSequence(strFw.data(), strFw.length());
+            writer.writeReverseComplement(strRc.data(), strRc.length());
+            writer.writeSequence(seqPacked, start, len);
+            writer.writeReverseComplement(seqPacked, len, start + 11);
+            writer.endSequence();
+            strExpected += wrapped(strHeader, strFw + _bioReverseComplement(strRc) + strPacked.substr(start, len)
+                                   + _bioReverseComplement(strPacked.substr(len, start + 11)), lineWidth);
+          }
+          writer.flush();
+        }
+        if (readFile(output.path()) != strExpected) {
+          failCheck(__FILE__, __LINE__, "output differs with line width " + std::to_string(lineWidth) + ", buffer " + std::to_string(bufferSize));
+        }
+      }
+    }
+  }
+
+  // Spans of mapped contigs (single-line and wrapped input) are written as the parsed bases, with and without output wrapping
+  // Spans are large enough to be written from the mapping without copying
+  SCARA_TEST(writer_mapped_spans_match_plain) {
+    std::mt19937 generator(34);
+    const uint32_t ContigLength = 3 * SequenceWriter::MinExternalSpan + 123;
+    std::vector<std::string> vContigs = {randomACGT(generator, ContigLength), randomACGT(generator, ContigLength)};
+
+    for (uint32_t inputWidth : {0u, 60u}) {
+      TemporaryFile contigs(".fasta");
+      std::string strInput;
+      for (uint32_t i = 0; i < vContigs.size(); i++) strInput += wrapped(">ctg" + std::to_string(i), vContigs[i], inputWidth);
+      writeFile(contigs.path(), strInput);
+
+      MapIdToSeq mIdToSeq;
+      parseProcessFasta(contigs.path(), mIdToSeq, quietConfig());
+      mapFastaSequences(contigs.path(), mIdToSeq, quietConfig());
+      CHECK_EQ(mIdToSeq.size(), vContigs.size());
+      for (auto const& it : mIdToSeq) CHECK(it.second->seq_mapData != NULL);
+
+      std::vector<std::pair<uint32_t, uint32_t>> vSpans = {{0, ContigLength}, {1, ContigLength - 1}, {59, SequenceWriter::MinExternalSpan + 61},
+                                                           {ContigLength - SequenceWriter::MinExternalSpan, SequenceWriter::MinExternalSpan}, {100, 200}};
+      for (uint32_t outputWidth : {0u, 80u}) {
+        TemporaryFile output(".fasta");
+        std::string strExpected;
+        {
+          SequenceWriter writer(output.path(), outputWidth);
+          for (uint32_t i = 0; i < vContigs.size(); i++) {
+            const Sequence& seq = *mIdToSeq.at("ctg" + std::to_string(i));
+            std::string strHeader = ">Scaffold_" + std::to_string(i + 1);
+            std::string strBases;
+            writer.writeHeader(strHeader);
+            for (auto const& span : vSpans) {
+              writer.writeMappedSequence(seq, span.first, span.second);
+              strBases += vContigs[i].substr(span.first, span.second);
+            }
+            writer.endSequence();
+            strExpected += wrapped(strHeader, strBases, outputWidth);
+          }
+          writer.flush();
+        }
+        if (readFile(output.path()) != strExpected) {
+          failCheck(__FILE__, __LINE__, "output differs with input width " + std::to_string(inputWidth) + ", output width " + std::to_string(outputWidth));
+        }
+      }
+    }
+  }
+
+}
+}